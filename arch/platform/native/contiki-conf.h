@@ -91,7 +91,9 @@ typedef unsigned int uip_stats_t;
 #define QUEUEBUF_CONF_NUM 64
 #endif /* QUEUEBUF_CONF_NUM */
 
+#ifndef UIP_CONF_IPV6_QUEUE_PKT
 #define UIP_CONF_IPV6_QUEUE_PKT  1
+#endif /* UIP_CONF_IPV6_QUEUE_PKT */
 #define UIP_ARCH_IPCHKSUM        1
 
 #endif /* NETSTACK_CONF_WITH_IPV6 */
@@ -72,6 +72,9 @@ PROCESS_THREAD(ble_iface_observer, ev, data)
 
   PROCESS_BEGIN();
 
+  process_subscribe(PROCESS_CURRENT(), ble_event_interface_added);
+  process_subscribe(PROCESS_CURRENT(), ble_event_interface_deleted);
+
   etimer_set(&led_timer, CLOCK_SECOND/2);
 
   while(1) {
@@ -61,6 +61,16 @@
  * Larger values result in less frequent active slots: reduces capacity and saves energy. */
 #define TSCH_SCHEDULE_CONF_DEFAULT_LENGTH 3
 
+#if WITH_ORCHESTRA_ADAPTIVE
+
+/* Orchestra rules, with extra unicast cells that follow the load of the
+ * parent. The adaptive rule goes right before the unicast rule. */
+#define ORCHESTRA_CONF_RULES { &eb_per_time_source, &unicast_adaptive, &unicast_per_neighbor_rpl_storing, &default_common }
+/* The parent sends its load level in the enhanced ACKs */
+#define TSCH_PACKET_CONF_EACK_WITH_LOAD_LEVEL 1
+
+#endif /* WITH_ORCHESTRA_ADAPTIVE */
+
 #if WITH_SECURITY
 
 /* Enable security */
@@ -116,6 +116,7 @@ main(void)
   {
     uip_ds6_addr_t *lladdr;
     memcpy(&uip_lladdr.addr, &linkaddr_node_addr, sizeof(uip_lladdr.addr));
+    process_set_priority(&tcpip_process, PROCESS_PRIORITY_HIGH);
     process_start(&tcpip_process, NULL);
 
     lladdr = uip_ds6_get_link_local(-1);
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+/*---------------------------------------------------------------------------*/
+/**
+ * \addtogroup data
+ * @{
+ *
+ * \defgroup bitmap Bitmap word helpers
+ *
+ * Helpers for scanning the 32-bit words of the bitmaps used by the
+ * memory block allocator and other allocation maps.
+ * @{
+ *
+ * \file
+ *   Header file for the bitmap word helpers
+ */
+/*---------------------------------------------------------------------------*/
+#ifndef BITMAP_H_
+#define BITMAP_H_
+/*---------------------------------------------------------------------------*/
+#include <stdint.h>
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Get the index of the lowest set bit of a bitmap word
+ * \param w The bitmap word, which must not be zero
+ * \return The index of the lowest set bit, 0 being the least
+ *         significant bit
+ */
+static inline unsigned
+bitmap_first_set(uint32_t w)
+{
+#if defined(__GNUC__)
+  return __builtin_ctzl((unsigned long)w);
+#else
+  unsigned i;
+
+  for(i = 0; !(w & 1); i++) {
+    w >>= 1;
+  }
+  return i;
+#endif
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Get the index of the lowest zero bit of a bitmap word
+ * \param w The bitmap word, which must not have all bits set
+ * \return The index of the lowest zero bit
+ */
+static inline unsigned
+bitmap_first_zero(uint32_t w)
+{
+  return bitmap_first_set(~w);
+}
+/*---------------------------------------------------------------------------*/
+#endif /* BITMAP_H_ */
+/*---------------------------------------------------------------------------*/
+/**
+ * @}
+ * @}
+ */
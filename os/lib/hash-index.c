@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+/*---------------------------------------------------------------------------*/
+/**
+ * \addtogroup hash-index
+ * @{
+ *
+ * \file
+ *   Implementation of the hash index library
+ */
+/*---------------------------------------------------------------------------*/
+#include "lib/hash-index.h"
+#include "sys/critical.h"
+/*---------------------------------------------------------------------------*/
+/* Get the next slot in a probe sequence */
+static unsigned
+next_slot(const struct hash_index *hi, unsigned slot)
+{
+  return ++slot == hi->size ? 0 : slot;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+home_slot(const struct hash_index *hi, unsigned item)
+{
+  return hi->item_hash(item) % hi->size;
+}
+/*---------------------------------------------------------------------------*/
+void
+hash_index_init(struct hash_index *hi)
+{
+  unsigned slot;
+
+  for(slot = 0; slot < hi->size; slot++) {
+    hi->slots[slot] = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+hash_index_hash(uint32_t hash, const void *data, unsigned len)
+{
+  const uint8_t *p = data;
+
+  while(len-- > 0) {
+    hash = hash * 31 + *p++;
+  }
+  return hash;
+}
+/*---------------------------------------------------------------------------*/
+int
+hash_index_find(const struct hash_index *hi, uint32_t hash, const void *key)
+{
+  unsigned slot;
+  uint16_t value;
+
+  for(slot = hash % hi->size; (value = hi->slots[slot]) != 0;
+      slot = next_slot(hi, slot)) {
+    if(hi->item_match(value - 1, key)) {
+      return value - 1;
+    }
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+void
+hash_index_insert(struct hash_index *hi, unsigned item)
+{
+  unsigned slot;
+
+  for(slot = home_slot(hi, item); hi->slots[slot] != 0;
+      slot = next_slot(hi, slot));
+  hi->slots[slot] = item + 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+hash_index_remove(struct hash_index *hi, unsigned item)
+{
+  unsigned slot, next, home;
+  int_master_status_t status;
+
+  for(slot = home_slot(hi, item); hi->slots[slot] != item + 1;
+      slot = next_slot(hi, slot)) {
+    if(hi->slots[slot] == 0) {
+      return;
+    }
+  }
+
+  /* A lookup interrupting the shift could pass the new slot of an
+     entry before it is written, and then find its old slot already
+     overwritten by the next entry */
+  status = critical_enter();
+  for(next = next_slot(hi, slot); hi->slots[next] != 0;
+      next = next_slot(hi, next)) {
+    home = home_slot(hi, hi->slots[next] - 1);
+    /* Move the entry into the slot to fill unless its home slot lies
+       cyclically between that slot and its current slot */
+    if((next > slot && (home <= slot || home > next)) ||
+       (next < slot && (home <= slot && home > next))) {
+      hi->slots[slot] = hi->slots[next];
+      slot = next;
+    }
+  }
+  hi->slots[slot] = 0;
+  critical_exit(status);
+}
+/*---------------------------------------------------------------------------*/
+/** @} */
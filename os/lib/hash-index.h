@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+/*---------------------------------------------------------------------------*/
+/**
+ * \addtogroup data
+ * @{
+ *
+ * \defgroup hash-index Hash index library
+ *
+ * An open-addressing hash table with linear probing that maps keys to
+ * the positions of items in a caller-owned array, typically the memory
+ * of a MEMB() block. The index stores only the positions; the caller
+ * hashes and compares the keys through callbacks, so the keys stay in
+ * the items themselves.
+ *
+ * Removal shifts back the entries that follow in the same probe
+ * sequence, so that no deleted markers are needed. The entries are
+ * shifted with interrupts disabled, so a lookup from an interrupt
+ * handler never misses an entry that is being moved. Insertions and
+ * removals must not interrupt each other.
+ * @{
+ *
+ * \file
+ *   Header file for the hash index library
+ */
+/*---------------------------------------------------------------------------*/
+#ifndef HASH_INDEX_H_
+#define HASH_INDEX_H_
+/*---------------------------------------------------------------------------*/
+#include "sys/cc.h"
+
+#include <stdint.h>
+/*---------------------------------------------------------------------------*/
+/**
+ * Declare a hash index.
+ *
+ * \param name The name of the hash index
+ * \param size The number of slots. It must be larger than the number of
+ *        items that can be indexed at once.
+ * \param item_hash The function returning the hash of the key of an
+ *        indexed item
+ * \param item_match The function telling whether the key of an item
+ *        matches a key passed to hash_index_find()
+ */
+#define HASH_INDEX(name, size, item_hash, item_match) \
+        static volatile uint16_t CC_CONCAT(name,_hash_index_slots)[size]; \
+        static struct hash_index name = {CC_CONCAT(name,_hash_index_slots), \
+                                         size, item_hash, item_match}
+
+struct hash_index {
+  /* The position of the indexed item plus one, or zero if empty */
+  volatile uint16_t *slots;
+  uint16_t size;
+  uint32_t (*item_hash)(unsigned item);
+  int (*item_match)(unsigned item, const void *key);
+};
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Remove all items from a hash index
+ * \param hi The hash index
+ */
+void hash_index_init(struct hash_index *hi);
+
+/**
+ * \brief Hash a sequence of bytes
+ * \param hash The hash to continue from, or any seed
+ * \param data The bytes to hash
+ * \param len The number of bytes
+ * \return The hash
+ */
+uint32_t hash_index_hash(uint32_t hash, const void *data, unsigned len);
+
+/**
+ * \brief Find an item by its key
+ * \param hi The hash index
+ * \param hash The hash of the key, as item_hash() would return it
+ * \param key The key, passed to item_match()
+ * \return The position of the item, or -1 if no item matches
+ */
+int hash_index_find(const struct hash_index *hi, uint32_t hash,
+                    const void *key);
+
+/**
+ * \brief Add an item to a hash index
+ * \param hi The hash index
+ * \param item The position of the item, whose key must be set
+ *
+ *        The item must not be indexed already.
+ */
+void hash_index_insert(struct hash_index *hi, unsigned item);
+
+/**
+ * \brief Remove an item from a hash index
+ * \param hi The hash index
+ * \param item The position of the item, whose key must not have
+ *        changed since it was added
+ *
+ *        Nothing is done if the item is not indexed.
+ */
+void hash_index_remove(struct hash_index *hi, unsigned item);
+/*---------------------------------------------------------------------------*/
+#endif /* HASH_INDEX_H_ */
+/*---------------------------------------------------------------------------*/
+/**
+ * @}
+ * @}
+ */
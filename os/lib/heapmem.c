@@ -104,6 +104,31 @@
 #define ALIGN(size)						\
   (((size) + (HEAPMEM_ALIGNMENT - 1)) & ~(HEAPMEM_ALIGNMENT - 1))
 
+/*
+ * The HEAPMEM_CONF_SIZE_CLASSES parameter enables the segregated
+ * size-class mode when set to a non-zero value. Allocations of up to
+ * HEAPMEM_CONF_SIZE_CLASSES * HEAPMEM_CONF_SIZE_CLASS_STEP bytes are
+ * rounded up to a multiple of the step, and freed chunks of such a
+ * size are kept on a free list of their own. Allocating and freeing
+ * these chunks then takes constant time whenever a chunk of the
+ * class has been freed before. Larger allocations use the general
+ * allocator.
+ */
+#ifdef HEAPMEM_CONF_SIZE_CLASSES
+#define HEAPMEM_SIZE_CLASSES HEAPMEM_CONF_SIZE_CLASSES
+#else
+#define HEAPMEM_SIZE_CLASSES 0
+#endif /* HEAPMEM_CONF_SIZE_CLASSES */
+
+#ifdef HEAPMEM_CONF_SIZE_CLASS_STEP
+#define SIZE_CLASS_STEP ALIGN(HEAPMEM_CONF_SIZE_CLASS_STEP)
+#else
+#define SIZE_CLASS_STEP ALIGN(8)
+#endif /* HEAPMEM_CONF_SIZE_CLASS_STEP */
+
+#define SIZE_CLASS_MAX (HEAPMEM_SIZE_CLASSES * SIZE_CLASS_STEP)
+#define SIZE_CLASS(size) (((size) - 1) / SIZE_CLASS_STEP)
+
 /* Macros for chunk iteration. */
 #define NEXT_CHUNK(chunk)						\
   ((chunk_t *)((char *)(chunk) + sizeof(chunk_t) + (chunk)->size))
@@ -119,11 +144,18 @@
 
 /* Macros for determining the status of a chunk. */
 #define CHUNK_FLAG_ALLOCATED		0x1
+/* The chunk belongs to a size class. A free chunk of a size class
+   stays marked as allocated, so that it is not coalesced, and is
+   marked as cached instead. */
+#define CHUNK_FLAG_SIZE_CLASS		0x2
+#define CHUNK_FLAG_CACHED		0x4
 
 #define CHUNK_ALLOCATED(chunk)			\
   ((chunk)->flags & CHUNK_FLAG_ALLOCATED)
 #define CHUNK_FREE(chunk)			\
   (~(chunk)->flags & CHUNK_FLAG_ALLOCATED)
+#define CHUNK_CACHED(chunk)			\
+  ((chunk)->flags & CHUNK_FLAG_CACHED)
 
 /*
  * We use a double-linked list of chunks, with a slight space overhead compared
@@ -149,6 +181,11 @@ static size_t heap_usage;
 static chunk_t *first_chunk = (chunk_t *)heap_base;
 static chunk_t *free_list;
 
+#if HEAPMEM_SIZE_CLASSES
+/* Free chunks of each size class, linked through their next field. */
+static chunk_t *class_free_list[HEAPMEM_SIZE_CLASSES];
+#endif /* HEAPMEM_SIZE_CLASSES */
+
 /* extend_space: Increases the current footprint used in the heap, and
    returns a pointer to the old end. */
 static void *
@@ -306,6 +343,59 @@ get_free_chunk(const size_t size)
   return best;
 }
 
+#if HEAPMEM_SIZE_CLASSES
+/* get_class_chunk: Take a chunk from the free list of a size class. */
+static chunk_t *
+get_class_chunk(const size_t size)
+{
+  chunk_t *chunk;
+
+  chunk = class_free_list[SIZE_CLASS(size)];
+  if(chunk != NULL) {
+    class_free_list[SIZE_CLASS(size)] = chunk->next;
+    chunk->flags &= ~CHUNK_FLAG_CACHED;
+  }
+  return chunk;
+}
+
+/* put_class_chunk: Put a chunk on the free list of its size class. */
+static void
+put_class_chunk(chunk_t * const chunk)
+{
+  if(IS_LAST_CHUNK(chunk)) {
+    /* Release the chunk back into the wilderness. */
+    chunk->flags = 0;
+    heap_usage -= sizeof(chunk_t) + chunk->size;
+    return;
+  }
+
+  chunk->flags |= CHUNK_FLAG_CACHED;
+  chunk->prev = NULL;
+  chunk->next = class_free_list[SIZE_CLASS(chunk->size)];
+  class_free_list[SIZE_CLASS(chunk->size)] = chunk;
+}
+
+/*
+ * release_class_chunks: Return the free chunks of all size classes to
+ * the general allocator, so that they can be coalesced and reused
+ * for allocations of other sizes.
+ */
+static void
+release_class_chunks(void)
+{
+  int i;
+  chunk_t *chunk;
+
+  for(i = 0; i < HEAPMEM_SIZE_CLASSES; i++) {
+    while((chunk = class_free_list[i]) != NULL) {
+      class_free_list[i] = chunk->next;
+      chunk->flags = CHUNK_FLAG_ALLOCATED;
+      free_chunk(chunk);
+    }
+  }
+}
+#endif /* HEAPMEM_SIZE_CLASSES */
+
 /*
  * heapmem_alloc: Allocate an object of the specified size, returning
  * a pointer to it in case of success, and NULL in case of failure.
@@ -319,6 +409,11 @@ get_free_chunk(const size_t size)
  *
  * As a last resort, heapmem_alloc() will try to extend the heap
  * space, and thereby create a new chunk available for use.
+ *
+ * In the size-class mode, small allocations are first served from
+ * the free list of their size class. If an allocation cannot be
+ * served at all, the chunks kept by the size classes are returned to
+ * the general allocator and the allocation is attempted once more.
  */
 void *
 #if HEAPMEM_DEBUG
@@ -328,19 +423,57 @@ heapmem_alloc(size_t size)
 #endif
 {
   chunk_t *chunk;
+  uint8_t flags;
 
   size = ALIGN(size);
+  flags = CHUNK_FLAG_ALLOCATED;
+
+#if HEAPMEM_SIZE_CLASSES
+  if(size > 0 && size <= SIZE_CLASS_MAX) {
+    size = (SIZE_CLASS(size) + 1) * SIZE_CLASS_STEP;
+    flags |= CHUNK_FLAG_SIZE_CLASS;
+    chunk = get_class_chunk(size);
+    if(chunk != NULL) {
+      goto allocated;
+    }
+  }
+#endif /* HEAPMEM_SIZE_CLASSES */
 
   chunk = get_free_chunk(size);
   if(chunk == NULL) {
     chunk = extend_space(sizeof(chunk_t) + size);
+    if(chunk != NULL) {
+      chunk->size = size;
+    }
+  }
+
+#if HEAPMEM_SIZE_CLASSES
+  if(chunk == NULL) {
+    release_class_chunks();
+    chunk = get_free_chunk(size);
     if(chunk == NULL) {
-      return NULL;
+      chunk = extend_space(sizeof(chunk_t) + size);
+      if(chunk != NULL) {
+        chunk->size = size;
+      }
     }
-    chunk->size = size;
+  }
+#endif /* HEAPMEM_SIZE_CLASSES */
+
+  if(chunk == NULL) {
+    return NULL;
+  }
+
+  if(chunk->size != size) {
+    /* A larger free chunk that could not be split. It cannot be put
+       on the free list of the size class when freed. */
+    flags &= ~CHUNK_FLAG_SIZE_CLASS;
   }
 
-  chunk->flags = CHUNK_FLAG_ALLOCATED;
+#if HEAPMEM_SIZE_CLASSES
+allocated:
+#endif /* HEAPMEM_SIZE_CLASSES */
+  chunk->flags = flags;
 
 #if HEAPMEM_DEBUG
   chunk->file = file;
@@ -379,6 +512,13 @@ heapmem_free(void *ptr)
     PRINTF("%s ptr %p, allocated at %s:%u\n", __func__, ptr,
            chunk->file, chunk->line);
 
+#if HEAPMEM_SIZE_CLASSES
+    if(chunk->flags & CHUNK_FLAG_SIZE_CLASS) {
+      put_class_chunk(chunk);
+      return;
+    }
+#endif /* HEAPMEM_SIZE_CLASSES */
+
     free_chunk(chunk);
   }
 }
@@ -432,6 +572,23 @@ heapmem_realloc(void *ptr, size_t size)
   size = ALIGN(size);
   size_adj = size - chunk->size;
 
+#if HEAPMEM_SIZE_CLASSES
+  if(chunk->flags & CHUNK_FLAG_SIZE_CLASS) {
+    /* Chunks of a size class keep the size of their class. Keep the
+       object in place if it still fits, or move it otherwise. */
+    if(size_adj <= 0 && chunk->size - size < SIZE_CLASS_STEP) {
+      return ptr;
+    }
+    newptr = heapmem_alloc(size);
+    if(newptr == NULL) {
+      return size_adj <= 0 ? ptr : NULL;
+    }
+    memcpy(newptr, ptr, size_adj <= 0 ? size : chunk->size);
+    put_class_chunk(chunk);
+    return newptr;
+  }
+#endif /* HEAPMEM_SIZE_CLASSES */
+
   if(size_adj <= 0) {
     /* Request to make the object smaller or to keep its size.
        In the former case, the chunk will be split if possible. */
@@ -494,15 +651,25 @@ heapmem_stats(heapmem_stats_t *stats)
   for(chunk = first_chunk;
       (char *)chunk < &heap_base[heap_usage];
       chunk = NEXT_CHUNK(chunk)) {
-    if(CHUNK_ALLOCATED(chunk)) {
+    if(CHUNK_CACHED(chunk)) {
+      stats->available += chunk->size;
+      stats->cached += chunk->size;
+    } else if(CHUNK_ALLOCATED(chunk)) {
       stats->allocated += chunk->size;
     } else {
       coalesce_chunks(chunk);
       stats->available += chunk->size;
+      stats->free_chunks++;
+      if(chunk->size > stats->largest_free) {
+        stats->largest_free = chunk->size;
+      }
     }
     stats->overhead += sizeof(chunk_t);
   }
   stats->available += HEAPMEM_ARENA_SIZE - heap_usage;
+  if(HEAPMEM_ARENA_SIZE - heap_usage > stats->largest_free) {
+    stats->largest_free = HEAPMEM_ARENA_SIZE - heap_usage;
+  }
   stats->footprint = heap_usage;
   stats->chunks = stats->overhead / sizeof(chunk_t);
 }
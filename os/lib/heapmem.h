@@ -82,6 +82,12 @@ typedef struct heapmem_stats {
   size_t available;
   size_t footprint;
   size_t chunks;
+  /* Fragmentation metrics: the number of free chunks outside of the
+     size classes, the largest block that is free in one piece, and
+     the space held by the free lists of the size classes. */
+  size_t free_chunks;
+  size_t largest_free;
+  size_t cached;
 } heapmem_stats_t;
 
 #if HEAPMEM_DEBUG
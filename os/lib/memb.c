@@ -46,58 +46,76 @@
 
 #include "contiki.h"
 #include "lib/memb.h"
+#include "lib/bitmap.h"
 
 /*---------------------------------------------------------------------------*/
 void
 memb_init(struct memb *m)
 {
-  memset(m->count, 0, m->num);
+  memset(m->used, 0, MEMB_BITMAP_WORDS(m->num) * sizeof(uint32_t));
   memset(m->mem, 0, m->size * m->num);
+  m->nused = 0;
+#if MEMB_STATS
+  m->max_used = 0;
+  m->failures = 0;
+#endif /* MEMB_STATS */
 }
 /*---------------------------------------------------------------------------*/
 void *
 memb_alloc(struct memb *m)
 {
+  int w;
   int i;
 
-  for(i = 0; i < m->num; ++i) {
-    if(m->count[i] == 0) {
-      /* If this block was unused, we increase the reference count to
-	 indicate that it now is used and return a pointer to the
-	 memory block. */
-      ++(m->count[i]);
-      return (void *)((char *)m->mem + (i * m->size));
+  if(m->nused < m->num) {
+    /* Find a bitmap word with a free block. As there is one, the
+       search stops before running past the last word. */
+    for(w = 0; m->used[w] == (uint32_t)~0UL; ++w);
+    i = w * 32 + bitmap_first_zero(m->used[w]);
+
+    /* Mark the block as used and return a pointer to the memory
+       block. */
+    m->used[w] |= (uint32_t)1 << (i % 32);
+    ++m->nused;
+#if MEMB_STATS
+    if(m->nused > m->max_used) {
+      m->max_used = m->nused;
     }
+#endif /* MEMB_STATS */
+    return (void *)((char *)m->mem + (i * m->size));
   }
 
   /* No free block was found, so we return NULL to indicate failure to
      allocate block. */
+#if MEMB_STATS
+  ++m->failures;
+#endif /* MEMB_STATS */
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
 char
 memb_free(struct memb *m, void *ptr)
 {
+  unsigned long offset;
   int i;
-  char *ptr2;
 
-  /* Walk through the list of blocks and try to find the block to
-     which the pointer "ptr" points to. */
-  ptr2 = (char *)m->mem;
-  for(i = 0; i < m->num; ++i) {
-    
-    if(ptr2 == (char *)ptr) {
-      /* We've found to block to which "ptr" points so we decrease the
-	 reference count and return the new value of it. */
-      if(m->count[i] > 0) {
-	/* Make sure that we don't deallocate free memory. */
-	--(m->count[i]);
-      }
-      return m->count[i];
-    }
-    ptr2 += m->size;
+  /* Find the block to which "ptr" points to from its offset in the
+     memory of the blocks. */
+  if(!memb_inmemb(m, ptr)) {
+    return -1;
+  }
+  offset = (char *)ptr - (char *)m->mem;
+  if(offset % m->size != 0) {
+    return -1;
+  }
+  i = offset / m->size;
+
+  /* Make sure that we don't deallocate free memory. */
+  if(m->used[i / 32] & ((uint32_t)1 << (i % 32))) {
+    m->used[i / 32] &= ~((uint32_t)1 << (i % 32));
+    --m->nused;
   }
-  return -1;
+  return 0;
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -110,15 +128,6 @@ memb_inmemb(struct memb *m, void *ptr)
 int
 memb_numfree(struct memb *m)
 {
-  int i;
-  int num_free = 0;
-
-  for(i = 0; i < m->num; ++i) {
-    if(m->count[i] == 0) {
-      ++num_free;
-    }
-  }
-
-  return num_free;
+  return m->num - m->nused;
 }
 /** @} */
@@ -65,6 +65,24 @@
 
 #include "sys/cc.h"
 
+#include <stdint.h>
+
+/**
+ * \brief Keep allocation statistics for each memory block
+ *
+ * With this enabled, each memory block records the largest number
+ * of chunks that were allocated at the same time and the number of
+ * allocations that failed because all chunks were in use.
+ */
+#ifdef MEMB_CONF_STATS
+#define MEMB_STATS MEMB_CONF_STATS
+#else /* MEMB_CONF_STATS */
+#define MEMB_STATS 0
+#endif /* MEMB_CONF_STATS */
+
+/* The number of 32-bit words in the bitmap of a memory block */
+#define MEMB_BITMAP_WORDS(num) (((num) + 31) / 32)
+
 /**
  * Declare a memory block.
  *
@@ -87,17 +105,26 @@ MEMB(connections, struct connection, 16);
  *
  */
 #define MEMB(name, structure, num) \
-        static char CC_CONCAT(name,_memb_count)[num]; \
+        static uint32_t CC_CONCAT(name,_memb_used)[MEMB_BITMAP_WORDS(num)]; \
         static structure CC_CONCAT(name,_memb_mem)[num]; \
         static struct memb name = {sizeof(structure), num, \
-                                          CC_CONCAT(name,_memb_count), \
+                                          CC_CONCAT(name,_memb_used), \
                                           (void *)CC_CONCAT(name,_memb_mem)}
 
 struct memb {
   unsigned short size;
   unsigned short num;
-  char *count;
+  /* One bit per chunk, set if the chunk is allocated */
+  uint32_t *used;
   void *mem;
+  /* The number of allocated chunks */
+  unsigned short nused;
+#if MEMB_STATS
+  /* The largest number of chunks that were allocated at once */
+  unsigned short max_used;
+  /* The number of allocations that failed */
+  unsigned short failures;
+#endif /* MEMB_STATS */
 };
 
 /**
@@ -125,6 +152,9 @@ void *memb_alloc(struct memb *m);
  * \return The new reference count for the memory block (should be 0
  * if successfully deallocated) or -1 if the pointer "ptr" did not
  * point to a legal memory block.
+ *
+ * The chunks in use are tracked in a bitmap, so deallocation takes
+ * constant time and allocation checks 32 chunks at a time.
  */
 char  memb_free(struct memb *m, void *ptr);
 
@@ -516,6 +516,7 @@ start_request(struct http_socket *s)
         if(ret == RESOLV_STATUS_UNCACHED ||
            ret == RESOLV_STATUS_EXPIRED) {
           resolv_query(host);
+          process_subscribe(&http_socket_process, resolv_event_found);
           puts("Resolving host...");
           return HTTP_SOCKET_OK;
         }
@@ -574,6 +574,7 @@ websocket_open(struct websocket *s, const char *url,
       ret = resolv_lookup(host, NULL);
       if(ret != RESOLV_STATUS_CACHED) {
 	resolv_query(host);
+	process_subscribe(&websocket_process, resolv_event_found);
 	s->state = WEBSOCKET_STATE_DNS_REQUEST_SENT;
 	LOG_INFO("Resolving host...\n");
 	return WEBSOCKET_OK;
@@ -234,22 +234,63 @@ static uint16_t my_tag;
 /* Assuming that the worst growth for uncompression is 38 bytes */
 #define SICSLOWPAN_FIRST_FRAGMENT_SIZE (SICSLOWPAN_FRAGMENT_SIZE + 38)
 
+/* A reassembly that got no fragment for this long is considered stalled,
+ * e.g. after a lost fragment, and is evicted when its context or fragment
+ * buffers are needed for another datagram, rather than blocking them
+ * until SICSLOWPAN_REASS_MAXAGE */
+#ifdef SICSLOWPAN_CONF_REASS_IDLE_TIMEOUT
+#define SICSLOWPAN_REASS_IDLE_TIMEOUT SICSLOWPAN_CONF_REASS_IDLE_TIMEOUT
+#else
+#define SICSLOWPAN_REASS_IDLE_TIMEOUT (SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 32)
+#endif
+
+/* Fragment forwarding: a router forwards the fragments of a datagram that is
+ * not for itself as they come, once the first one was routed, instead of
+ * reassembling and fragmenting it again (virtual reassembly buffer, see
+ * RFC 8930). Falls back to reassembly when the first fragment can not be
+ * forwarded alone, e.g. when its header grows too much on the next hop. */
+#ifdef SICSLOWPAN_CONF_FRAG_FORWARDING
+#define SICSLOWPAN_FRAG_FORWARDING SICSLOWPAN_CONF_FRAG_FORWARDING
+#else
+#define SICSLOWPAN_FRAG_FORWARDING 0
+#endif
+
+/* The number of datagrams that can be forwarded concurrently */
+#ifdef SICSLOWPAN_CONF_VRB_ENTRIES
+#define SICSLOWPAN_VRB_ENTRIES SICSLOWPAN_CONF_VRB_ENTRIES
+#else
+#define SICSLOWPAN_VRB_ENTRIES 4
+#endif
+
+#if SICSLOWPAN_FRAG_FORWARDING && UIP_CONF_IPV6_QUEUE_PKT
+/* A datagram queued for address resolution would be sent later as a whole,
+   while only its first fragment is in uip_buf */
+#error "SICSLOWPAN_CONF_FRAG_FORWARDING requires UIP_CONF_IPV6_QUEUE_PKT 0"
+#endif
+
+/* One bit per 8-byte block of the reassembled packet */
+#define SICSLOWPAN_REASS_BITMAP_SIZE ((UIP_BUFSIZE + 63) / 64)
+
+/* Return values of add_fragment() when no context is returned */
+#define FRAG_FAILED    -1
+#define FRAG_DUPLICATE -2
+
 /* all information needed for reassembly */
 struct sicslowpan_frag_info {
   /** When reassembling, the source address of the fragments being merged */
   linkaddr_t sender;
-  /** The destination address of the fragments being merged */
-  linkaddr_t receiver;
   /** When reassembling, the tag in the fragments being merged. */
   uint16_t tag;
   /** Total length of the fragmented packet */
   uint16_t len;
-  /** Current length of reassembled fragments */
-  uint16_t reassembled_len;
+  /** The 8-byte blocks of the packet received so far */
+  uint8_t received[SICSLOWPAN_REASS_BITMAP_SIZE];
   /** Reassembly %process %timer. */
   struct timer reass_timer;
+  /** Restarted at every fragment, to detect stalled reassemblies */
+  struct timer idle_timer;
 
-  /** Fragment size of first fragment */
+  /** Fragment size of first fragment, zero until it is received */
   uint16_t first_frag_len;
   /** First fragment - needs a larger buffer since the size is uncompressed size
    and we need to know total size to know when we have received last fragment. */
@@ -270,6 +311,34 @@ struct sicslowpan_frag_buf {
 
 static struct sicslowpan_frag_buf frag_buf[SICSLOWPAN_FRAGMENT_BUFFERS];
 
+static struct sicslowpan_reass_stats reass_stats;
+
+#if SICSLOWPAN_FRAG_FORWARDING
+/* A datagram being forwarded fragment by fragment */
+struct sicslowpan_vrb {
+  /** The previous hop and its tag, zero size if the entry is free */
+  linkaddr_t sender;
+  uint16_t tag;
+  /** The size of the incoming datagram */
+  uint16_t in_size;
+  /** The uncompressed length of the incoming first fragment */
+  uint16_t in_first_len;
+  /** The next hop and our tag */
+  linkaddr_t next_hop;
+  uint16_t out_tag;
+  /** The size of the outgoing datagram, may change with the headers */
+  uint16_t out_size;
+  /** The 8-byte blocks of the incoming datagram forwarded so far */
+  uint8_t forwarded[SICSLOWPAN_REASS_BITMAP_SIZE];
+  struct timer timer;
+};
+
+static struct sicslowpan_vrb vrb_table[SICSLOWPAN_VRB_ENTRIES];
+/* Set while the first fragment of a datagram is being routed. output()
+   sends it as such only if the IP layer flagged it as forwarded */
+static struct sicslowpan_vrb *vrb_pending;
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
+
 /*---------------------------------------------------------------------------*/
 static int
 clear_fragments(uint8_t frag_info_index)
@@ -296,12 +365,111 @@ timeout_fragments(int not_context)
     if(frag_info[i].len > 0 && i != not_context &&
        timer_expired(&frag_info[i].reass_timer)) {
       /* This context can be freed */
+      LOG_WARN("reassembly: timed out, tag %d\n", frag_info[i].tag);
+      reass_stats.timed_out++;
       count += clear_fragments(i);
     }
   }
   return count;
 }
 /*---------------------------------------------------------------------------*/
+/* Frees one stalled context other than not_context. Returns 1 if one was
+   freed. */
+static int
+evict_stalled(int not_context)
+{
+  int i;
+  for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
+    if(frag_info[i].len > 0 && i != not_context &&
+       timer_expired(&frag_info[i].idle_timer)) {
+      LOG_WARN("reassembly: evicting stalled reassembly, tag %d\n", frag_info[i].tag);
+      reass_stats.evicted++;
+      clear_fragments(i);
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+find_context(uint16_t tag)
+{
+  int i;
+  for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
+    if(frag_info[i].len > 0 && frag_info[i].tag == tag &&
+       linkaddr_cmp(&frag_info[i].sender, packetbuf_addr(PACKETBUF_ADDR_SENDER))) {
+      return i;
+    }
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+new_context(uint16_t tag, uint16_t frag_size)
+{
+  int i;
+
+  /* clear all fragment info with expired timer to free all fragment buffers */
+  timeout_fragments(-1);
+  for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS && frag_info[i].len > 0; i++);
+  if(i == SICSLOWPAN_REASS_CONTEXTS) {
+    /* All in use: make room from a stalled one */
+    if(!evict_stalled(-1)) {
+      return -1;
+    }
+    for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS && frag_info[i].len > 0; i++);
+  }
+
+  /* We use len as indication on used or not used */
+  frag_info[i].len = frag_size;
+  frag_info[i].tag = tag;
+  frag_info[i].first_frag_len = 0;
+  memset(frag_info[i].received, 0, sizeof(frag_info[i].received));
+  linkaddr_copy(&frag_info[i].sender, packetbuf_addr(PACKETBUF_ADDR_SENDER));
+  timer_set(&frag_info[i].reass_timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
+  reass_stats.started++;
+  return i;
+}
+/*---------------------------------------------------------------------------*/
+/* Checks whether the 8-byte blocks of [offset, offset + len) were all
+   marked in the bitmap already, and marks them otherwise */
+static int
+mark_received(uint8_t *bitmap, uint16_t offset, uint16_t len)
+{
+  uint16_t block;
+  uint16_t end = (offset + len + 7) / 8;
+  int duplicate = 1;
+
+  for(block = offset / 8; block < end && block < SICSLOWPAN_REASS_BITMAP_SIZE * 8; block++) {
+    if(!(bitmap[block / 8] & (1 << (block % 8)))) {
+      bitmap[block / 8] |= 1 << (block % 8);
+      duplicate = 0;
+    }
+  }
+  return duplicate;
+}
+/*---------------------------------------------------------------------------*/
+/* Checks whether all 8-byte blocks of a datagram of size len are marked */
+static int
+all_received(const uint8_t *bitmap, uint16_t len)
+{
+  uint16_t block;
+  uint16_t end = (len + 7) / 8;
+
+  for(block = 0; block < end; block++) {
+    if(!(bitmap[block / 8] & (1 << (block % 8)))) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+is_complete(const struct sicslowpan_frag_info *info)
+{
+  return info->first_frag_len != 0 && all_received(info->received, info->len);
+}
+/*---------------------------------------------------------------------------*/
 static int
 store_fragment(uint8_t index, uint8_t offset)
 {
@@ -322,75 +490,80 @@ store_fragment(uint8_t index, uint8_t offset)
   return -1;
 }
 /*---------------------------------------------------------------------------*/
-/* add a new fragment to the buffer */
+/* Adds a fragment to its reassembly context, keyed by sender and tag, and
+   creates the context if this is the first fragment received (not
+   necessarily FRAG1). The payload of a FRAGN is stored, the one of FRAG1 is
+   moved into the context while uncompressing. Returns the context, or
+   FRAG_DUPLICATE or FRAG_FAILED. */
 static int8_t
 add_fragment(uint16_t tag, uint16_t frag_size, uint8_t offset)
 {
   int i;
   int len;
-  int8_t found = -1;
+  struct sicslowpan_frag_info *info;
 
-  if(offset == 0) {
-    /* This is a first fragment - check if we can add this */
-    for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
-      /* clear all fragment info with expired timer to free all fragment buffers */
-      if(frag_info[i].len > 0 && timer_expired(&frag_info[i].reass_timer)) {
-        clear_fragments(i);
-      }
-
-      /* We use len as indication on used or not used */
-      if(found < 0 && frag_info[i].len == 0) {
-        /* We remember the first free fragment info but must continue
-           the loop to free any other expired fragment buffers. */
-        found = i;
-      }
-    }
+  if(frag_size == 0 || frag_size > UIP_BUFSIZE) {
+    LOG_WARN("reassembly: invalid size %u - tag: %d\n", frag_size, tag);
+    return FRAG_FAILED;
+  }
 
-    if(found < 0) {
+  i = find_context(tag);
+  if(i >= 0 && frag_info[i].len != frag_size) {
+    LOG_WARN("reassembly: size mismatch (%u, expected %u) - tag: %d\n",
+             frag_size, frag_info[i].len, tag);
+    return FRAG_FAILED;
+  }
+  if(i < 0) {
+    i = new_context(tag, frag_size);
+    if(i < 0) {
       LOG_WARN("reassembly: failed to store new fragment session - tag: %d\n", tag);
-      return -1;
+      reass_stats.no_context++;
+      return FRAG_FAILED;
     }
+  }
+  info = &frag_info[i];
+  timer_set(&info->idle_timer, SICSLOWPAN_REASS_IDLE_TIMEOUT);
 
-    /* Found a free fragment info to store data in */
-    frag_info[found].len = frag_size;
-    frag_info[found].tag = tag;
-    linkaddr_copy(&frag_info[found].sender,
-                  packetbuf_addr(PACKETBUF_ADDR_SENDER));
-    timer_set(&frag_info[found].reass_timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
+  if(offset == 0) {
     /* first fragment can not be stored immediately but is moved into
        the buffer while uncompressing */
-    return found;
+    if(info->first_frag_len > 0) {
+      reass_stats.duplicates++;
+      return FRAG_DUPLICATE;
+    }
+    return i;
   }
 
-  /* This is a N-fragment - should find the info */
-  for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
-    if(frag_info[i].tag == tag && frag_info[i].len > 0 &&
-       linkaddr_cmp(&frag_info[i].sender, packetbuf_addr(PACKETBUF_ADDR_SENDER))) {
-      /* Tag and Sender match - this must be the correct info to store in */
-      found = i;
-      break;
-    }
+  len = packetbuf_datalen() - packetbuf_hdr_len;
+  /* For the last fragment, we are OK if there is extrenous bytes at
+     the end of the packet, as long as they fit in uip_buf. */
+  if(len <= 0 || len > SICSLOWPAN_FRAGMENT_SIZE ||
+     (offset << 3) >= info->len || (offset << 3) + len > UIP_BUFSIZE) {
+    LOG_WARN("reassembly: invalid fragment - tag: %d offset: %d len: %d\n", tag, offset, len);
+    return FRAG_FAILED;
   }
 
-  if(found < 0) {
-    /* no entry found for storing the new fragment */
-    LOG_WARN("reassembly: failed to store N-fragment - could not find session - tag: %d offset: %d\n", tag, offset);
-    return -1;
+  /* Check for duplicates before storing anything */
+  if(mark_received(info->received, offset << 3, len)) {
+    reass_stats.duplicates++;
+    return FRAG_DUPLICATE;
   }
 
-  /* i is the index of the reassembly context */
   len = store_fragment(i, offset);
   if(len < 0 && timeout_fragments(i) > 0) {
     len = store_fragment(i, offset);
   }
+  while(len < 0 && evict_stalled(i)) {
+    len = store_fragment(i, offset);
+  }
   if(len > 0) {
-    frag_info[i].reassembled_len += len;
     return i;
   } else {
-    /* should we also clear all fragments since we failed to store
-       this fragment? */
-    LOG_WARN("reassembly: failed to store fragment - packet reassembly will fail tag:%d l\n", frag_info[i].tag);
-    return -1;
+    /* The datagram can not be completed anymore, free its buffers */
+    LOG_WARN("reassembly: failed to store fragment - packet reassembly will fail tag:%d l\n", info->tag);
+    reass_stats.no_buffer++;
+    clear_fragments(i);
+    return FRAG_FAILED;
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -413,6 +586,13 @@ copy_frags2uip(int context)
   }
   /* deallocate all the fragments for this context */
   clear_fragments(context);
+  reass_stats.completed++;
+}
+/*---------------------------------------------------------------------------*/
+const struct sicslowpan_reass_stats *
+sicslowpan_get_reass_stats(void)
+{
+  return &reass_stats;
 }
 #endif /* SICSLOWPAN_CONF_FRAG */
 
@@ -464,6 +644,33 @@ set_packet_attrs(void)
 /*   } */
 
 }
+/*---------------------------------------------------------------------------*/
+/* Passes the packet in uip_buf to the IP layer, with the attributes of the
+   frame it came in, which is still in packetbuf */
+static void
+ip_input(void)
+{
+  /* if callback is set then set attributes and call */
+  if(callback) {
+    set_packet_attrs();
+    callback->input_callback();
+  }
+
+#if LLSEC802154_USES_AUX_HEADER
+  /*
+   * Assuming that the last packet in packetbuf is containing
+   *  the LLSEC state so that it can be copied to uipbuf.
+   */
+  uipbuf_set_attr(UIPBUF_ATTR_LLSEC_LEVEL,
+    packetbuf_attr(PACKETBUF_ATTR_SECURITY_LEVEL));
+#if LLSEC802154_USES_EXPLICIT_KEYS
+  uipbuf_set_attr(UIPBUF_ATTR_LLSEC_KEY_ID,
+    packetbuf_attr(PACKETBUF_ATTR_KEY_INDEX));
+#endif /* LLSEC802154_USES_EXPLICIT_KEYS */
+#endif /*  LLSEC802154_USES_AUX_HEADER */
+
+  tcpip_input();
+}
 
 
 
@@ -1479,30 +1686,20 @@ send_packet(linkaddr_t *dest)
  * \param uip_offset the offset in the uIP buffer where to copy the payload from
  * \param dest the link layer destination address of the packet
  * \return 1 if success, 0 otherwise
+ *
+ * The fragment header must already be in packetbuf. The MAC layer may
+ * modify packetbuf, so the caller rebuilds it for every fragment.
  */
 static int
 fragment_copy_payload_and_send(uint16_t uip_offset, linkaddr_t *dest) {
-  struct queuebuf *q;
-
   /* Now copy fragment payload from uip_buf */
   memcpy(packetbuf_ptr + packetbuf_hdr_len,
          (uint8_t *)UIP_IP_BUF + uip_offset, packetbuf_payload_len);
   packetbuf_set_datalen(packetbuf_payload_len + packetbuf_hdr_len);
 
-  /* Backup packetbuf to queuebuf. Enables preserving attributes for all framgnets */
-  q = queuebuf_new_from_packetbuf();
-  if(q == NULL) {
-    LOG_WARN("output: could not allocate queuebuf, dropping fragment\n");
-    return 0;
-  }
-
   /* Send fragment */
   send_packet(dest);
 
-  /* Restore packetbuf from queuebuf */
-  queuebuf_to_packetbuf(q);
-  queuebuf_free(q);
-
   /* Check tx result. */
   if((last_tx_status == MAC_TX_COLLISION) ||
      (last_tx_status == MAC_TX_ERR) ||
@@ -1512,6 +1709,208 @@ fragment_copy_payload_and_send(uint16_t uip_offset, linkaddr_t *dest) {
   }
   return 1;
 }
+#if SICSLOWPAN_FRAG_FORWARDING
+/*--------------------------------------------------------------------*/
+static struct sicslowpan_vrb *
+vrb_lookup(const linkaddr_t *sender, uint16_t tag)
+{
+  int i;
+  for(i = 0; i < SICSLOWPAN_VRB_ENTRIES; i++) {
+    if(vrb_table[i].out_size > 0 && timer_expired(&vrb_table[i].timer)) {
+      vrb_table[i].out_size = 0;
+    }
+    if(vrb_table[i].out_size > 0 && vrb_table[i].tag == tag &&
+       linkaddr_cmp(&vrb_table[i].sender, sender)) {
+      return &vrb_table[i];
+    }
+  }
+  return NULL;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Checks whether a datagram is delivered locally, from its first
+ * fragment. A datagram addressed to us with a routing header that has
+ * segments left, e.g. on a hop of a RPL non-storing source route, is to be
+ * forwarded once the IP layer has set the next destination.
+ * \param buf the first fragment, uncompressed
+ * \param len the length of the first fragment
+ */
+static int
+vrb_is_for_us(uint8_t *buf, uint16_t len)
+{
+  struct uip_ip_hdr *hdr = (struct uip_ip_hdr *)buf;
+  const struct uip_routing_hdr *rh;
+
+  if(!uip_ds6_is_my_addr(&hdr->destipaddr)) {
+    return 0;
+  }
+  rh = (const struct uip_routing_hdr *)uipbuf_search_header(buf, len, UIP_PROTO_ROUTING);
+  return rh == NULL || rh->seg_left == 0 ||
+    (const uint8_t *)rh + (rh->len + 1) * 8 > buf + len;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Routes the first fragment of a datagram for another node through
+ * the IP layer, with the rest of the datagram zeroed in uip_buf. If output()
+ * manages to send it alone, the subsequent fragments are forwarded as they
+ * come, and the reassembly context can be freed.
+ * \param context the reassembly context holding the first fragment
+ * \param tag the tag of the datagram
+ * \return 1 if the datagram is now forwarded fragment by fragment
+ */
+static int
+vrb_forward_first(int context, uint16_t tag)
+{
+  struct sicslowpan_frag_info *info = &frag_info[context];
+  struct uip_ip_hdr *hdr = (struct uip_ip_hdr *)info->first_frag;
+  struct sicslowpan_vrb *vrb = NULL;
+  int i;
+
+  if(uip_is_addr_mcast(&hdr->destipaddr) || info->first_frag_len % 8 != 0
+     || vrb_is_for_us(info->first_frag, info->first_frag_len)) {
+    return 0;
+  }
+  /* Fragments received before the first one are reassembled */
+  for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS; i++) {
+    if(frag_buf[i].len > 0 && frag_buf[i].index == context) {
+      return 0;
+    }
+  }
+  for(i = 0; i < SICSLOWPAN_VRB_ENTRIES; i++) {
+    if(vrb_table[i].out_size == 0 || timer_expired(&vrb_table[i].timer)) {
+      vrb = &vrb_table[i];
+      break;
+    }
+  }
+  if(vrb == NULL) {
+    return 0;
+  }
+
+  linkaddr_copy(&vrb->sender, packetbuf_addr(PACKETBUF_ADDR_SENDER));
+  vrb->tag = tag;
+  vrb->in_size = info->len;
+  vrb->in_first_len = info->first_frag_len;
+  vrb->out_size = 0;
+  memset(vrb->forwarded, 0, sizeof(vrb->forwarded));
+  mark_received(vrb->forwarded, 0, info->first_frag_len);
+
+  memcpy(uip_buf, info->first_frag, info->first_frag_len);
+  memset(uip_buf + info->first_frag_len, 0, info->len - info->first_frag_len);
+  uip_len = info->len;
+
+  /* output() sets out_size if it sends the first fragment. The IP layer
+     sees the first fragment as any received packet, e.g. for its LLSEC
+     level */
+  vrb_pending = vrb;
+  ip_input();
+  vrb_pending = NULL;
+
+  if(vrb->out_size == 0) {
+    LOG_INFO("vrb: could not forward first fragment (tag %d), reassembling\n", tag);
+    return 0;
+  }
+  timer_set(&vrb->timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
+  reass_stats.forwarded++;
+  return 1;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Called by output() for the first fragment routed by
+ * vrb_forward_first(): sends it alone as a FRAG1 with a new tag.
+ * \param dest the next hop
+ * \return 1 if sent, 0 to fall back to reassembly
+ */
+static uint8_t
+vrb_output_first(linkaddr_t *dest)
+{
+  struct sicslowpan_vrb *vrb = vrb_pending;
+  /* The headers may have changed on the way, e.g. with a routing header */
+  int delta = (int)uip_len - (int)vrb->in_size;
+  int payload = (int)vrb->in_first_len + delta - (int)uncomp_hdr_len;
+  uint16_t frag_tag;
+
+  if(linkaddr_cmp(dest, &linkaddr_null) || delta % 8 != 0 || payload <= 0 ||
+     packetbuf_hdr_len + SICSLOWPAN_FRAG1_HDR_LEN + payload > mac_max_payload ||
+     queuebuf_numfree() < 1) {
+    return 0;
+  }
+
+  last_tx_status = MAC_TX_OK;
+  frag_tag = my_tag++;
+
+  /* Move IPHC/IPv6 header to make room for FRAG1 header */
+  memmove(packetbuf_ptr + SICSLOWPAN_FRAG1_HDR_LEN, packetbuf_ptr, packetbuf_hdr_len);
+  packetbuf_hdr_len += SICSLOWPAN_FRAG1_HDR_LEN;
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE,
+        ((SICSLOWPAN_DISPATCH_FRAG1 << 8) | uip_len));
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_TAG, frag_tag);
+  packetbuf_payload_len = payload;
+
+  LOG_INFO("vrb: forwarding tag %d as %d, payload %d\n", vrb->tag, frag_tag, payload);
+  if(fragment_copy_payload_and_send(uncomp_hdr_len, dest) == 0) {
+    return 0;
+  }
+
+  linkaddr_copy(&vrb->next_hop, dest);
+  vrb->out_tag = frag_tag;
+  vrb->out_size = uip_len;
+  return 1;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Forwards a FRAGN in packetbuf if its datagram is forwarded
+ * fragment by fragment, rewriting its header in place.
+ * \return 1 if the fragment was consumed, 0 if it is to be reassembled
+ */
+static int
+vrb_forward_fragn(uint16_t tag, uint16_t frag_size, uint8_t offset)
+{
+  static uint8_t frame[PACKETBUF_SIZE];
+  struct sicslowpan_vrb *vrb;
+  int len = packetbuf_datalen();
+  int payload = len - packetbuf_hdr_len;
+  int out_offset;
+
+  vrb = vrb_lookup(packetbuf_addr(PACKETBUF_ADDR_SENDER), tag);
+  if(vrb == NULL) {
+    return 0;
+  }
+
+  out_offset = (offset << 3) + (int)vrb->out_size - (int)vrb->in_size;
+  if(frag_size != vrb->in_size || payload <= 0 ||
+     (offset << 3) + payload > vrb->in_size ||
+     out_offset < 0 || (out_offset >> 3) > 0xff) {
+    LOG_WARN("vrb: dropping invalid fragment (tag %d, offset %d)\n", tag, offset << 3);
+    return 1;
+  }
+  if(mark_received(vrb->forwarded, offset << 3, payload)) {
+    /* The next hop got it already */
+    LOG_INFO("vrb: dropping duplicate fragment (tag %d, offset %d)\n", tag, offset << 3);
+    reass_stats.duplicates++;
+    return 1;
+  }
+
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE,
+        ((SICSLOWPAN_DISPATCH_FRAGN << 8) | vrb->out_size));
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_TAG, vrb->out_tag);
+  PACKETBUF_FRAG_PTR[PACKETBUF_FRAG_OFFSET] = out_offset >> 3;
+
+  LOG_INFO("vrb: forwarding fragment (tag %d as %d, offset %d)\n",
+           tag, vrb->out_tag, out_offset);
+
+  /* Send the frame on, with the attributes of an outgoing packet */
+  memcpy(frame, packetbuf_ptr, len);
+  packetbuf_clear();
+  packetbuf_copyfrom(frame, len);
+  send_packet(&vrb->next_hop);
+
+  if(all_received(vrb->forwarded, vrb->in_size)) {
+    /* All of the datagram went through */
+    vrb->out_size = 0;
+  }
+  return 1;
+}
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
 #endif /* SICSLOWPAN_CONF_FRAG */
 /*--------------------------------------------------------------------*/
 /** \brief Take an IP packet and format it to be sent on an 802.15.4
@@ -1562,6 +1961,14 @@ output(const linkaddr_t *localdest)
   packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS,
                      uipbuf_get_attr(UIPBUF_ATTR_MAX_MAC_TRANSMISSIONS));
 
+#if TSCH_QUEUE_NUM_CLASSES > 1
+  /* ICMPv6 carries the RPL and ND control traffic: queue it in the highest
+     TSCH traffic class, ahead of data */
+  if(UIP_IP_BUF->proto == UIP_PROTO_ICMP6) {
+    packetbuf_set_attr(PACKETBUF_ATTR_TSCH_TRAFFIC_CLASS, TSCH_QUEUE_NUM_CLASSES - 1);
+  }
+#endif /* TSCH_QUEUE_NUM_CLASSES > 1 */
+
 /* Calculate NETSTACK_FRAMER's header length, that will be added in the NETSTACK_MAC */
   packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &dest);
 #if LLSEC802154_USES_AUX_HEADER
@@ -1607,6 +2014,16 @@ output(const linkaddr_t *localdest)
 
   packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &dest);
 
+#if SICSLOWPAN_CONF_FRAG && SICSLOWPAN_FRAG_FORWARDING
+  if(vrb_pending != NULL && uipbuf_is_attr_flag(UIPBUF_ATTR_FLAGS_FORWARDED)) {
+    /* Only the first fragment is in uip_buf. Its headers, destination
+       included, may have been rewritten on the way, e.g. by RPL. Packets
+       generated meanwhile, such as neighbor solicitations or ICMPv6
+       errors, are not flagged and go out normally */
+    return vrb_output_first(&dest);
+  }
+#endif /* SICSLOWPAN_CONF_FRAG && SICSLOWPAN_FRAG_FORWARDING */
+
   frag_needed = (int)uip_len - (int)uncomp_hdr_len + (int)packetbuf_hdr_len > mac_max_payload;
   LOG_INFO("output: header len %d -> %d, total len %d -> %d, MAC max payload %d, frag_needed %d\n",
             uncomp_hdr_len, packetbuf_hdr_len,
@@ -1619,6 +2036,9 @@ output(const linkaddr_t *localdest)
     uint16_t processed_ip_out_len;
     uint16_t frag_tag;
     int curr_frag = 0;
+    /* Attributes of the packet, set again in packetbuf for each fragment */
+    struct packetbuf_attr frag_attrs[PACKETBUF_NUM_ATTRS];
+    struct packetbuf_addr frag_addrs[PACKETBUF_NUM_ADDRS];
 
     /*
      * The outbound IPv6 packet is too large to fit into a single 15.4
@@ -1644,7 +2064,7 @@ output(const linkaddr_t *localdest)
       fragment_count += 1 + (middle_fragn_total_payload - 1) / fragn_max_payload;
     }
 
-    int freebuf = queuebuf_numfree() - 1;
+    int freebuf = queuebuf_numfree();
     LOG_INFO("output: fragmentation needed, fragments: %u, free queuebufs: %u\n",
       fragment_count, freebuf);
 
@@ -1679,6 +2099,11 @@ output(const linkaddr_t *localdest)
     /* Set frag1 payload len. Was already caulcated earlier as frag1_payload */
     packetbuf_payload_len = frag1_payload;
 
+    /* Keep the attributes for the subsequent fragments. Only the few bytes
+     * of the FRAGN header are then written for each of them, rather than
+     * saving and restoring the whole packetbuf around every send. */
+    packetbuf_attr_copyto(frag_attrs, frag_addrs);
+
     /* Copy payload from uIP and send fragment */
     /* Send fragment */
     LOG_INFO("output: fragment %d/%d (tag %d, payload %d)\n",
@@ -1689,11 +2114,7 @@ output(const linkaddr_t *localdest)
     }
 
     /* Now prepare for subsequent fragments. */
-
-    /* FRAGN header: tag was already set at FRAG1. Now set dispatch for all FRAGN */
     packetbuf_hdr_len = SICSLOWPAN_FRAGN_HDR_LEN;
-    SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE,
-          ((SICSLOWPAN_DISPATCH_FRAGN << 8) | uip_len));
 
     /* Keep track of the total length of data sent */
     processed_ip_out_len = uncomp_hdr_len + packetbuf_payload_len;
@@ -1701,7 +2122,14 @@ output(const linkaddr_t *localdest)
     /* Create and send subsequent fragments. */
     while(processed_ip_out_len < uip_len) {
       curr_frag++;
-      /* FRAGN header: set offset for this fragment */
+      /* Rebuild the packetbuf left by the previous fragment */
+      packetbuf_clear();
+      packetbuf_attr_copyfrom(frag_attrs, frag_addrs);
+      packetbuf_ptr = packetbuf_dataptr();
+      /* FRAGN header: dispatch, tag and offset for this fragment */
+      SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE,
+            ((SICSLOWPAN_DISPATCH_FRAGN << 8) | uip_len));
+      SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_TAG, frag_tag);
       PACKETBUF_FRAG_PTR[PACKETBUF_FRAG_OFFSET] = processed_ip_out_len >> 3;
 
       /* Calculate fragment len */
@@ -1815,10 +2243,21 @@ input(void)
       LOG_INFO("input: received first element of a fragmented packet (tag %d, len %d)\n",
              frag_tag, frag_size);
 
+#if SICSLOWPAN_FRAG_FORWARDING
+      if(vrb_lookup(packetbuf_addr(PACKETBUF_ADDR_SENDER), frag_tag) != NULL) {
+        LOG_INFO("input: duplicate first fragment (tag %d)\n", frag_tag);
+        return;
+      }
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
+
       /* Add the fragment to the fragmentation context */
       frag_context = add_fragment(frag_tag, frag_size, frag_offset);
 
-      if(frag_context == -1) {
+      if(frag_context == FRAG_DUPLICATE) {
+        LOG_INFO("input: duplicate first fragment (tag %d)\n", frag_tag);
+        return;
+      }
+      if(frag_context == FRAG_FAILED) {
         LOG_ERR("input: failed to allocate new reassembly context\n");
         return;
       }
@@ -1835,12 +2274,22 @@ input(void)
       frag_size = GET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE) & 0x07ff;
       packetbuf_hdr_len += SICSLOWPAN_FRAGN_HDR_LEN;
 
+#if SICSLOWPAN_FRAG_FORWARDING
+      if(vrb_forward_fragn(frag_tag, frag_size, frag_offset)) {
+        return;
+      }
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
+
       /* Add the fragment to the fragmentation context (this will also
          copy the payload) */
       frag_context = add_fragment(frag_tag, frag_size, frag_offset);
 
-      if(frag_context == -1) {
-        LOG_ERR("input: reassembly context not found (tag %d)\n", frag_tag);
+      if(frag_context == FRAG_DUPLICATE) {
+        LOG_INFO("input: duplicate fragment (tag %d, offset %d)\n", frag_tag, frag_offset << 3);
+        return;
+      }
+      if(frag_context == FRAG_FAILED) {
+        LOG_ERR("input: failed to store fragment (tag %d)\n", frag_tag);
         return;
       }
 
@@ -1848,7 +2297,7 @@ input(void)
          we should not store more */
       buffer = NULL;
 
-      if(frag_info[frag_context].reassembled_len >= frag_size) {
+      if(is_complete(&frag_info[frag_context])) {
         last_fragment = 1;
       }
       is_fragment = 1;
@@ -1942,13 +2391,18 @@ input(void)
   if(frag_size > 0) {
     /* Add the size of the header only for the first fragment. */
     if(first_fragment != 0) {
-      frag_info[frag_context].reassembled_len = uncomp_hdr_len + packetbuf_payload_len;
       frag_info[frag_context].first_frag_len = uncomp_hdr_len + packetbuf_payload_len;
+      mark_received(frag_info[frag_context].received, 0, frag_info[frag_context].first_frag_len);
+      /* The subsequent fragments may have arrived first */
+      last_fragment = is_complete(&frag_info[frag_context]);
+#if SICSLOWPAN_FRAG_FORWARDING
+      if(!last_fragment && vrb_forward_first(frag_context, frag_tag)) {
+        clear_fragments(frag_context);
+        return;
+      }
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
     }
-    /* For the last fragment, we are OK if there is extrenous bytes at
-       the end of the packet. */
     if(last_fragment != 0) {
-      frag_info[frag_context].reassembled_len = frag_size;
       /* copy to uip */
       copy_frags2uip(frag_context);
     }
@@ -1981,26 +2435,7 @@ input(void)
       LOG_DBG_("\n");
     }
 
-    /* if callback is set then set attributes and call */
-    if(callback) {
-      set_packet_attrs();
-      callback->input_callback();
-    }
-
-#if LLSEC802154_USES_AUX_HEADER
-    /*
-     * Assuming that the last packet in packetbuf is containing
-     *  the LLSEC state so that it can be copied to uipbuf.
-     */
-    uipbuf_set_attr(UIPBUF_ATTR_LLSEC_LEVEL,
-      packetbuf_attr(PACKETBUF_ATTR_SECURITY_LEVEL));
-#if LLSEC802154_USES_EXPLICIT_KEYS
-    uipbuf_set_attr(UIPBUF_ATTR_LLSEC_KEY_ID,
-      packetbuf_attr(PACKETBUF_ATTR_KEY_INDEX));
-#endif /* LLSEC802154_USES_EXPLICIT_KEYS */
-#endif /*  LLSEC802154_USES_AUX_HEADER */
-
-    tcpip_input();
+    ip_input();
 #if SICSLOWPAN_CONF_FRAG
   }
 #endif /* SICSLOWPAN_CONF_FRAG */
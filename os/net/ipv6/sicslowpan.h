@@ -336,6 +336,32 @@ struct sicslowpan_nh_compressor {
 
 int sicslowpan_get_last_rssi(void);
 
+#if SICSLOWPAN_CONF_FRAG
+/**
+ * Statistics of the reassembly of fragmented packets
+ */
+struct sicslowpan_reass_stats {
+  /** Datagrams whose reassembly was started */
+  uint16_t started;
+  /** Datagrams reassembled and passed up */
+  uint16_t completed;
+  /** Fragments dropped as already received */
+  uint16_t duplicates;
+  /** Reassemblies dropped after SICSLOWPAN_REASS_MAXAGE */
+  uint16_t timed_out;
+  /** Stalled reassemblies evicted early to make room */
+  uint16_t evicted;
+  /** Datagrams dropped for lack of a reassembly context */
+  uint16_t no_context;
+  /** Reassemblies dropped for lack of a fragment buffer */
+  uint16_t no_buffer;
+  /** Datagrams forwarded fragment by fragment, without reassembly */
+  uint16_t forwarded;
+};
+
+const struct sicslowpan_reass_stats *sicslowpan_get_reass_stats(void);
+#endif /* SICSLOWPAN_CONF_FRAG */
+
 extern const struct network_driver sicslowpan_driver;
 
 #endif /* SICSLOWPAN_H_ */
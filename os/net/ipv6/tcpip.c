@@ -558,12 +558,13 @@ get_nexthop(uip_ipaddr_t *addr)
 static int
 queue_packet(uip_ds6_nbr_t *nbr)
 {
-  /* Copy outgoing pkt in the queuing buffer for later transmit. */
+  /* Move outgoing pkt to the queuing buffer for later transmit. */
 #if UIP_CONF_IPV6_QUEUE_PKT
   if(uip_packetqueue_alloc(&nbr->packethandle, UIP_DS6_NBR_PACKET_LIFETIME) != NULL) {
-    memcpy(uip_packetqueue_buf(&nbr->packethandle), UIP_IP_BUF, uip_len);
-    uip_packetqueue_set_buflen(&nbr->packethandle, uip_len);
-    return 0;
+    if(uip_packetqueue_save(&nbr->packethandle)) {
+      return 0;
+    }
+    uip_packetqueue_free(&nbr->packethandle);
   }
 #endif
 
@@ -581,10 +582,7 @@ send_queued(uip_ds6_nbr_t *nbr)
    * NA after sendiong a NS, you receive a NS with SLLAO: the entry moves
    * to STALE, and you must both send a NA and the queued packet.
    */
-  if(uip_packetqueue_buflen(&nbr->packethandle) != 0) {
-    uip_len = uip_packetqueue_buflen(&nbr->packethandle);
-    memcpy(UIP_IP_BUF, uip_packetqueue_buf(&nbr->packethandle), uip_len);
-    uip_packetqueue_free(&nbr->packethandle);
+  if(uip_packetqueue_restore(&nbr->packethandle)) {
     tcpip_output(uip_ds6_nbr_get_ll(nbr));
   }
 #endif /*UIP_CONF_IPV6_QUEUE_PKT*/
@@ -598,8 +596,14 @@ send_nd6_ns(const uip_ipaddr_t *nexthop)
 #if UIP_ND6_SEND_NS
    uip_ds6_nbr_t *nbr = NULL;
   if((nbr = uip_ds6_nbr_add(nexthop, NULL, 0, NBR_INCOMPLETE, NBR_TABLE_REASON_IPV6_ND, NULL)) != NULL) {
+    /* Queuing may hand the packet buffer off, keep its source address */
+    uip_ipaddr_t srcipaddr;
+    int is_my_src;
+
     err = 0;
 
+    uip_ipaddr_copy(&srcipaddr, &UIP_IP_BUF->srcipaddr);
+    is_my_src = uip_ds6_is_my_addr(&srcipaddr);
     queue_packet(nbr);
   /* RFC4861, 7.2.2:
    * "If the source address of the packet prompting the solicitation is the
@@ -607,8 +611,8 @@ send_nd6_ns(const uip_ipaddr_t *nexthop)
    * address SHOULD be placed in the IP Source Address of the outgoing
    * solicitation.  Otherwise, any one of the addresses assigned to the
    * interface should be used."*/
-   if(uip_ds6_is_my_addr(&UIP_IP_BUF->srcipaddr)){
-      uip_nd6_ns_output(&UIP_IP_BUF->srcipaddr, NULL, &nbr->ipaddr);
+   if(is_my_src){
+      uip_nd6_ns_output(&srcipaddr, NULL, &nbr->ipaddr);
     } else {
       uip_nd6_ns_output(NULL, NULL, &nbr->ipaddr);
     }
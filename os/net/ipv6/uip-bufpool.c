@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+/**
+ * \addtogroup uip
+ * @{
+ */
+
+/**
+ * \file
+ *         A pool of reference-counted uIP packet buffers.
+ */
+
+#include "contiki.h"
+#include "net/ipv6/uip-bufpool.h"
+
+/* Log configuration */
+#include "sys/log.h"
+#define LOG_MODULE "IPv6 Buf"
+#define LOG_LEVEL LOG_LEVEL_IPV6
+
+#if UIP_BUF_POOL_SIZE > 1
+
+static uip_buf_t buffers[UIP_BUF_POOL_SIZE];
+static uint8_t refcount[UIP_BUF_POOL_SIZE] = { 1 };
+
+uip_buf_t *uip_current_buf = &buffers[0];
+
+/*---------------------------------------------------------------------------*/
+static int
+buf_index(const uip_buf_t *buf)
+{
+  int i = buf - buffers;
+  if(buf == NULL || i < 0 || i >= UIP_BUF_POOL_SIZE) {
+    LOG_ERR("not a pool buffer: %p\n", (void *)buf);
+    return -1;
+  }
+  return i;
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_bufpool_init(void)
+{
+  memset(refcount, 0, sizeof(refcount));
+  refcount[0] = 1;
+  uip_current_buf = &buffers[0];
+}
+/*---------------------------------------------------------------------------*/
+uip_buf_t *
+uip_bufpool_alloc(void)
+{
+  int i;
+  for(i = 0; i < UIP_BUF_POOL_SIZE; i++) {
+    if(refcount[i] == 0) {
+      refcount[i] = 1;
+      return &buffers[i];
+    }
+  }
+  LOG_WARN("no free buffer\n");
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_bufpool_ref(uip_buf_t *buf)
+{
+  int i = buf_index(buf);
+  if(i >= 0 && refcount[i] < 0xff) {
+    refcount[i]++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_bufpool_unref(uip_buf_t *buf)
+{
+  int i = buf_index(buf);
+  if(i >= 0 && refcount[i] > 0) {
+    refcount[i]--;
+  }
+}
+/*---------------------------------------------------------------------------*/
+uip_buf_t *
+uip_bufpool_detach(void)
+{
+  uip_buf_t *buf = uip_current_buf;
+  uip_buf_t *fresh = uip_bufpool_alloc();
+  if(fresh == NULL) {
+    return NULL;
+  }
+  uip_current_buf = fresh;
+  return buf;
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_bufpool_attach(uip_buf_t *buf)
+{
+  if(buf_index(buf) < 0) {
+    return;
+  }
+  uip_bufpool_unref(uip_current_buf);
+  uip_current_buf = buf;
+}
+/*---------------------------------------------------------------------------*/
+int
+uip_bufpool_num_free(void)
+{
+  int i;
+  int n = 0;
+  for(i = 0; i < UIP_BUF_POOL_SIZE; i++) {
+    if(refcount[i] == 0) {
+      n++;
+    }
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* UIP_BUF_POOL_SIZE > 1 */
+/** @} */
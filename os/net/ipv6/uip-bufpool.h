@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+/**
+ * \addtogroup uip
+ * @{
+ */
+
+/**
+ * \file
+ *         A pool of reference-counted uIP packet buffers.
+ *
+ *         With UIP_CONF_BUF_POOL_SIZE > 1, uip_buf is a view of the current
+ *         buffer of the pool rather than a single static buffer. A packet
+ *         can then be handed off by detaching its buffer, which leaves
+ *         uip_buf on a fresh buffer, and brought back later by attaching it
+ *         again, instead of copying it in and out of uip_buf.
+ *
+ *         As the buffers are switched under uip_buf, pointers into uip_buf
+ *         (e.g. uip_appdata) must not be kept across a detach or attach.
+ */
+
+#ifndef UIP_BUFPOOL_H_
+#define UIP_BUFPOOL_H_
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+
+#if UIP_BUF_POOL_SIZE > 1
+
+/**
+ * \brief          Initializes the pool, with uip_buf on its first buffer
+ */
+void uip_bufpool_init(void);
+
+/**
+ * \brief          Allocates a buffer from the pool
+ * \retval         A buffer with a reference count of one, or NULL
+ */
+uip_buf_t *uip_bufpool_alloc(void);
+
+/**
+ * \brief          Takes a reference to a buffer
+ * \param buf      The buffer
+ */
+void uip_bufpool_ref(uip_buf_t *buf);
+
+/**
+ * \brief          Releases a reference to a buffer, which returns to the
+ *                 pool with the last one
+ * \param buf      The buffer
+ */
+void uip_bufpool_unref(uip_buf_t *buf);
+
+/**
+ * \brief          Hands the buffer holding the current packet over to the
+ *                 caller, and points uip_buf to a fresh buffer. uip_len and
+ *                 the other packet variables are left untouched.
+ * \retval         The buffer, with the reference of uip_buf transferred to
+ *                 the caller, or NULL if there is no free buffer
+ */
+uip_buf_t *uip_bufpool_detach(void);
+
+/**
+ * \brief          Makes a buffer the current one, releasing the reference
+ *                 to the previous one. The caller's reference to buf is
+ *                 transferred to uip_buf.
+ * \param buf      The buffer
+ */
+void uip_bufpool_attach(uip_buf_t *buf);
+
+/**
+ * \brief          Returns the number of free buffers in the pool
+ */
+int uip_bufpool_num_free(void);
+
+#endif /* UIP_BUF_POOL_SIZE > 1 */
+
+#endif /* UIP_BUFPOOL_H_ */
+/** @} */
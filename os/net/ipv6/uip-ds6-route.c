@@ -44,6 +44,7 @@
 
 #include "lib/list.h"
 #include "lib/memb.h"
+#include "lib/hash-index.h"
 #include "net/nbr-table.h"
 
 /* Log configuration */
@@ -91,6 +92,19 @@ MEMB(routememb, uip_ds6_route_t, UIP_DS6_ROUTE_NB);
 static int num_routes = 0;
 static void rm_routelist_callback(nbr_table_item_t *ptr);
 
+#if UIP_DS6_ROUTE_WITH_INDEX
+#if UIP_DS6_ROUTE_INDEX_SIZE <= UIP_DS6_ROUTE_NB
+#error UIP_DS6_ROUTE_INDEX_SIZE must be larger than UIP_DS6_ROUTE_NB
+#endif
+/* The route index maps a prefix and its length to the position of
+   the route in routememb. The number of routes of each prefix length
+   tells the lookup which prefix lengths need to be probed. */
+static uint32_t route_hash(unsigned item);
+static int route_match(unsigned item, const void *key);
+HASH_INDEX(route_index, UIP_DS6_ROUTE_INDEX_SIZE, route_hash, route_match);
+static uint16_t prefix_length_count[129];
+#endif /* UIP_DS6_ROUTE_WITH_INDEX */
+
 #endif /* (UIP_MAX_ROUTES != 0) */
 
 /* Default routes are held on the defaultrouterlist and their
@@ -174,6 +188,10 @@ uip_ds6_route_init(void)
 #if (UIP_MAX_ROUTES != 0)
   memb_init(&routememb);
   list_init(routelist);
+#if UIP_DS6_ROUTE_WITH_INDEX
+  hash_index_init(&route_index);
+  memset(prefix_length_count, 0, sizeof(prefix_length_count));
+#endif /* UIP_DS6_ROUTE_WITH_INDEX */
   nbr_table_register(nbr_routes,
                      (nbr_table_callback *)rm_routelist_callback);
 #endif /* (UIP_MAX_ROUTES != 0) */
@@ -198,6 +216,72 @@ uip_ds6_route_nexthop_lladdr(uip_ds6_route_t *route)
   }
 }
 #endif /* (UIP_MAX_ROUTES != 0) */
+#if (UIP_MAX_ROUTES != 0) && UIP_DS6_ROUTE_WITH_INDEX
+/*---------------------------------------------------------------------------*/
+/* The key of a route index lookup */
+struct route_key {
+  const uip_ipaddr_t *addr;
+  uint8_t length;
+};
+/*---------------------------------------------------------------------------*/
+/* Hash a prefix. As with uip_ipaddr_prefixcmp(), only the whole bytes
+   of the prefix are significant. */
+static uint32_t
+prefix_hash(const uip_ipaddr_t *prefix, uint8_t length)
+{
+  return hash_index_hash(length, prefix,
+                         MIN(length >> 3, sizeof(uip_ipaddr_t)));
+}
+/*---------------------------------------------------------------------------*/
+static uip_ds6_route_t *
+route_from_item(unsigned item)
+{
+  return &((uip_ds6_route_t *)routememb.mem)[item];
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+route_hash(unsigned item)
+{
+  uip_ds6_route_t *r = route_from_item(item);
+
+  return prefix_hash(&r->ipaddr, r->length);
+}
+/*---------------------------------------------------------------------------*/
+static int
+route_match(unsigned item, const void *key)
+{
+  const struct route_key *k = key;
+  uip_ds6_route_t *r = route_from_item(item);
+
+  return r->length == k->length &&
+    uip_ipaddr_prefixcmp(k->addr, &r->ipaddr, k->length);
+}
+/*---------------------------------------------------------------------------*/
+/* Find a route of a given prefix length matching an address */
+static uip_ds6_route_t *
+index_find(const uip_ipaddr_t *addr, uint8_t length)
+{
+  struct route_key key = { addr, length };
+  int item;
+
+  item = hash_index_find(&route_index, prefix_hash(addr, length), &key);
+  return item != -1 ? route_from_item(item) : NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+index_add(uip_ds6_route_t *route)
+{
+  hash_index_insert(&route_index, route - (uip_ds6_route_t *)routememb.mem);
+  prefix_length_count[route->length]++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+index_rm(uip_ds6_route_t *route)
+{
+  hash_index_remove(&route_index, route - (uip_ds6_route_t *)routememb.mem);
+  prefix_length_count[route->length]--;
+}
+#endif /* (UIP_MAX_ROUTES != 0) && UIP_DS6_ROUTE_WITH_INDEX */
 /*---------------------------------------------------------------------------*/
 const uip_ipaddr_t *
 uip_ds6_route_nexthop(uip_ds6_route_t *route)
@@ -266,7 +350,9 @@ uip_ds6_route_t *
 uip_ds6_route_lookup(const uip_ipaddr_t *addr)
 {
 #if (UIP_MAX_ROUTES != 0)
+#if !UIP_DS6_ROUTE_WITH_INDEX
   uip_ds6_route_t *r;
+#endif /* !UIP_DS6_ROUTE_WITH_INDEX */
   uip_ds6_route_t *found_route;
   uint8_t longestmatch;
 
@@ -279,6 +365,20 @@ uip_ds6_route_lookup(const uip_ipaddr_t *addr)
   }
 
   found_route = NULL;
+#if UIP_DS6_ROUTE_WITH_INDEX
+  /* Probe the prefix lengths in use, longest first */
+  for(longestmatch = 128;; longestmatch--) {
+    if(prefix_length_count[longestmatch] != 0) {
+      found_route = index_find(addr, longestmatch);
+      if(found_route != NULL) {
+        break;
+      }
+    }
+    if(longestmatch == 0) {
+      break;
+    }
+  }
+#else /* UIP_DS6_ROUTE_WITH_INDEX */
   longestmatch = 0;
   for(r = uip_ds6_route_head();
       r != NULL;
@@ -293,6 +393,7 @@ uip_ds6_route_lookup(const uip_ipaddr_t *addr)
       }
     }
   }
+#endif /* UIP_DS6_ROUTE_WITH_INDEX */
 
   if(found_route != NULL) {
     LOG_INFO("Found route: ");
@@ -304,6 +405,9 @@ uip_ds6_route_lookup(const uip_ipaddr_t *addr)
     LOG_WARN("No route found\n");
   }
 
+#if !UIP_DS6_ROUTE_WITH_INDEX || UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED
+  /* With the route index, the order of the list matters only for
+     removing the least recently used route */
   if(found_route != NULL && found_route != list_head(routelist)) {
     /* If we found a route, we put it at the start of the routeslist
        list. The list is ordered by how recently we looked them up:
@@ -313,6 +417,7 @@ uip_ds6_route_lookup(const uip_ipaddr_t *addr)
     list_remove(routelist, found_route);
     list_push(routelist, found_route);
   }
+#endif /* !UIP_DS6_ROUTE_WITH_INDEX || UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED */
 
   return found_route;
 #else /* (UIP_MAX_ROUTES != 0) */
@@ -336,6 +441,11 @@ uip_ds6_route_add(const uip_ipaddr_t *ipaddr, uint8_t length,
     return NULL;
   }
 
+  if(length > 128) {
+    LOG_WARN("Add: invalid prefix length %u\n", length);
+    return NULL;
+  }
+
   /* Get link-layer address of next hop, make sure it is in neighbor table */
   const uip_lladdr_t *nexthop_lladdr = uip_ds6_nbr_lladdr_from_ipaddr(nexthop);
   if(nexthop_lladdr == NULL) {
@@ -455,6 +565,9 @@ uip_ds6_route_add(const uip_ipaddr_t *ipaddr, uint8_t length,
 
   uip_ipaddr_copy(&(r->ipaddr), ipaddr);
   r->length = length;
+#if UIP_DS6_ROUTE_WITH_INDEX
+  index_add(r);
+#endif /* UIP_DS6_ROUTE_WITH_INDEX */
 
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   memset(&r->state, 0, sizeof(UIP_DS6_ROUTE_STATE_TYPE));
@@ -500,6 +613,9 @@ uip_ds6_route_rm(uip_ds6_route_t *route)
 
     /* Remove the route from the route list */
     list_remove(routelist, route);
+#if UIP_DS6_ROUTE_WITH_INDEX
+    index_rm(route);
+#endif /* UIP_DS6_ROUTE_WITH_INDEX */
 
     /* Find the corresponding neighbor_route and remove it. */
     for(neighbor_route = list_head(route->neighbor_routes->route_list);
@@ -111,6 +111,24 @@ void uip_ds6_notification_rm(struct uip_ds6_notification *n);
 #define UIP_DS6_ROUTE_NB 4
 #endif /* UIP_MAX_ROUTES */
 
+/* Index the routing table by prefix, with one open-addressing hash
+   table keyed on the prefix and its length. A lookup then probes the
+   hash table once for each prefix length in use, instead of comparing
+   the address with every route. */
+#ifdef UIP_DS6_ROUTE_CONF_WITH_INDEX
+#define UIP_DS6_ROUTE_WITH_INDEX UIP_DS6_ROUTE_CONF_WITH_INDEX
+#else /* UIP_DS6_ROUTE_CONF_WITH_INDEX */
+#define UIP_DS6_ROUTE_WITH_INDEX 0
+#endif /* UIP_DS6_ROUTE_CONF_WITH_INDEX */
+
+/* Number of slots in the route index. Must be larger than
+   UIP_DS6_ROUTE_NB */
+#ifdef UIP_DS6_ROUTE_CONF_INDEX_SIZE
+#define UIP_DS6_ROUTE_INDEX_SIZE UIP_DS6_ROUTE_CONF_INDEX_SIZE
+#else /* UIP_DS6_ROUTE_CONF_INDEX_SIZE */
+#define UIP_DS6_ROUTE_INDEX_SIZE (2 * UIP_DS6_ROUTE_NB)
+#endif /* UIP_DS6_ROUTE_CONF_INDEX_SIZE */
+
 /** \brief define some additional RPL related route state and
  *  neighbor callback for RPL - if not a DS6_ROUTE_STATE is already set */
 #ifndef UIP_DS6_ROUTE_STATE_TYPE
@@ -582,10 +582,7 @@ na_input(void)
     nbr->queue_buf_len = 0;
     return;
     }*/
-  if(uip_packetqueue_buflen(&nbr->packethandle) != 0) {
-    uip_len = uip_packetqueue_buflen(&nbr->packethandle);
-    memcpy(UIP_IP_BUF, uip_packetqueue_buf(&nbr->packethandle), uip_len);
-    uip_packetqueue_free(&nbr->packethandle);
+  if(uip_packetqueue_restore(&nbr->packethandle)) {
     return;
   }
 
@@ -1066,10 +1063,7 @@ ra_input(void)
     nbr->queue_buf_len = 0;
     return;
     }*/
-  if(nbr != NULL && uip_packetqueue_buflen(&nbr->packethandle) != 0) {
-    uip_len = uip_packetqueue_buflen(&nbr->packethandle);
-    memcpy(UIP_IP_BUF, uip_packetqueue_buf(&nbr->packethandle), uip_len);
-    uip_packetqueue_free(&nbr->packethandle);
+  if(nbr != NULL && uip_packetqueue_restore(&nbr->packethandle)) {
     return;
   }
 
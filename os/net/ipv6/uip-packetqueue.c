@@ -5,9 +5,9 @@
 #include "lib/memb.h"
 
 #include "net/ipv6/uip-packetqueue.h"
+#include "net/ipv6/uip-bufpool.h"
 
-#define MAX_NUM_QUEUED_PACKETS 2
-MEMB(packets_memb, struct uip_packetqueue_packet, MAX_NUM_QUEUED_PACKETS);
+MEMB(packets_memb, struct uip_packetqueue_packet, UIP_PACKETQUEUE_NUM);
 
 #define DEBUG 0
 #if DEBUG
@@ -24,6 +24,11 @@ packet_timedout(void *ptr)
   struct uip_packetqueue_handle *h = ptr;
 
   PRINTF("uip_packetqueue_free timed out %p\n", h);
+#if UIP_BUF_POOL_SIZE > 1
+  if(h->packet->queue_buf != NULL) {
+    uip_bufpool_unref(h->packet->queue_buf);
+  }
+#endif /* UIP_BUF_POOL_SIZE > 1 */
   memb_free(&packets_memb, h->packet);
   h->packet = NULL;
 }
@@ -45,6 +50,10 @@ uip_packetqueue_alloc(struct uip_packetqueue_handle *handle, clock_time_t lifeti
   }
   handle->packet = memb_alloc(&packets_memb);
   if(handle->packet != NULL) {
+#if UIP_BUF_POOL_SIZE > 1
+    handle->packet->queue_buf = NULL;
+#endif /* UIP_BUF_POOL_SIZE > 1 */
+    handle->packet->queue_buf_len = 0;
     ctimer_set(&handle->packet->lifetimer, lifetime,
                packet_timedout, handle);
   } else {
@@ -59,6 +68,11 @@ uip_packetqueue_free(struct uip_packetqueue_handle *handle)
   PRINTF("uip_packetqueue_free %p\n", handle);
   if(handle->packet != NULL) {
     ctimer_stop(&handle->packet->lifetimer);
+#if UIP_BUF_POOL_SIZE > 1
+    if(handle->packet->queue_buf != NULL) {
+      uip_bufpool_unref(handle->packet->queue_buf);
+    }
+#endif /* UIP_BUF_POOL_SIZE > 1 */
     memb_free(&packets_memb, handle->packet);
     handle->packet = NULL;
   }
@@ -67,7 +81,12 @@ uip_packetqueue_free(struct uip_packetqueue_handle *handle)
 uint8_t *
 uip_packetqueue_buf(struct uip_packetqueue_handle *h)
 {
+#if UIP_BUF_POOL_SIZE > 1
+  return h->packet != NULL && h->packet->queue_buf != NULL ?
+    h->packet->queue_buf->u8 : NULL;
+#else /* UIP_BUF_POOL_SIZE > 1 */
   return h->packet != NULL? h->packet->queue_buf: NULL;
+#endif /* UIP_BUF_POOL_SIZE > 1 */
 }
 /*---------------------------------------------------------------------------*/
 uint16_t
@@ -84,3 +103,43 @@ uip_packetqueue_set_buflen(struct uip_packetqueue_handle *h, uint16_t len)
   }
 }
 /*---------------------------------------------------------------------------*/
+int
+uip_packetqueue_save(struct uip_packetqueue_handle *h)
+{
+  if(h->packet == NULL || uip_len == 0 || uip_len > UIP_BUFSIZE) {
+    return 0;
+  }
+#if UIP_BUF_POOL_SIZE > 1
+  if(h->packet->queue_buf != NULL) {
+    uip_bufpool_unref(h->packet->queue_buf);
+  }
+  h->packet->queue_buf = uip_bufpool_detach();
+  if(h->packet->queue_buf == NULL) {
+    h->packet->queue_buf_len = 0;
+    return 0;
+  }
+#else /* UIP_BUF_POOL_SIZE > 1 */
+  memcpy(h->packet->queue_buf, uip_buf, uip_len);
+#endif /* UIP_BUF_POOL_SIZE > 1 */
+  h->packet->queue_buf_len = uip_len;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+uip_packetqueue_restore(struct uip_packetqueue_handle *h)
+{
+  if(uip_packetqueue_buflen(h) == 0) {
+    return 0;
+  }
+  uip_len = h->packet->queue_buf_len;
+#if UIP_BUF_POOL_SIZE > 1
+  /* The reference of the queue goes to uip_buf */
+  uip_bufpool_attach(h->packet->queue_buf);
+  h->packet->queue_buf = NULL;
+#else /* UIP_BUF_POOL_SIZE > 1 */
+  memcpy(uip_buf, h->packet->queue_buf, uip_len);
+#endif /* UIP_BUF_POOL_SIZE > 1 */
+  uip_packetqueue_free(h);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
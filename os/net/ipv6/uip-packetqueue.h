@@ -3,11 +3,23 @@
 
 #include "sys/ctimer.h"
 
+/* The number of packets that can be queued at once, over all neighbors */
+#ifdef UIP_PACKETQUEUE_CONF_NUM
+#define UIP_PACKETQUEUE_NUM UIP_PACKETQUEUE_CONF_NUM
+#else
+#define UIP_PACKETQUEUE_NUM 2
+#endif
+
 struct uip_packetqueue_handle;
 
 struct uip_packetqueue_packet {
   struct uip_ds6_queued_packet *next;
+#if UIP_BUF_POOL_SIZE > 1
+  /* The buffer handed off by uip_packetqueue_save() */
+  uip_buf_t *queue_buf;
+#else /* UIP_BUF_POOL_SIZE > 1 */
   uint8_t queue_buf[UIP_BUFSIZE];
+#endif /* UIP_BUF_POOL_SIZE > 1 */
   uint16_t queue_buf_len;
   struct ctimer lifetimer;
   struct uip_packetqueue_handle *handle;
@@ -31,5 +43,14 @@ uint8_t *uip_packetqueue_buf(struct uip_packetqueue_handle *h);
 uint16_t uip_packetqueue_buflen(struct uip_packetqueue_handle *h);
 void uip_packetqueue_set_buflen(struct uip_packetqueue_handle *h, uint16_t len);
 
+/* Moves the packet in uip_buf to an allocated queue entry. With a buffer
+ * pool, the buffer itself is handed off and uip_buf gets a fresh one, so
+ * pointers into uip_buf are no longer valid. Returns 0 on failure. */
+int uip_packetqueue_save(struct uip_packetqueue_handle *h);
+
+/* Moves the queued packet back to uip_buf and uip_len, and frees the
+ * queue entry. Returns 0 if nothing was queued. */
+int uip_packetqueue_restore(struct uip_packetqueue_handle *h);
+
 
 #endif /* UIP_PACKETQUEUE_H */
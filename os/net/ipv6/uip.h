@@ -504,10 +504,18 @@ typedef union {
   uint8_t u8[UIP_BUFSIZE];
 } uip_buf_t;
 
+#if UIP_BUF_POOL_SIZE > 1
+/** The buffer of the pool that uip_buf currently refers to */
+extern uip_buf_t *uip_current_buf;
+
+/** Macro to access the current buffer as an array of bytes */
+#define uip_buf (uip_current_buf->u8)
+#else /* UIP_BUF_POOL_SIZE > 1 */
 extern uip_buf_t uip_aligned_buf;
 
 /** Macro to access uip_aligned_buf as an array of bytes */
 #define uip_buf (uip_aligned_buf.u8)
+#endif /* UIP_BUF_POOL_SIZE > 1 */
 
 
 /** @} */
@@ -2099,6 +2107,41 @@ extern uip_lladdr_t uip_lladdr;
  */
 uint16_t uip_chksum(uint16_t *data, uint16_t len);
 
+/**
+ * Add data to a one's complement sum, e.g. to compute the old and new
+ * sums given to uip_chksum_adjust(). Unlike uip_chksum(), this is
+ * provided also when UIP_ARCH_CHKSUM is set.
+ *
+ * \param sum The sum so far, in host byte order.
+ *
+ * \param data A pointer to the data to add to the sum.
+ *
+ * \param len The length of the data. Only the last chunk added to a
+ * sum may have an odd length.
+ *
+ * \return The new sum, in host byte order.
+ */
+uint16_t uip_chksum_add(uint16_t sum, const void *data, uint16_t len);
+
+/**
+ * Update a checksum after a rewrite of the data it covers, without
+ * summing all of the data again.
+ *
+ * See RFC1624.
+ *
+ * \param chksum The checksum field before the rewrite, in host byte
+ * order.
+ *
+ * \param old_sum The one's complement sum of the rewritten words
+ * before the rewrite.
+ *
+ * \param new_sum The one's complement sum of the same words after
+ * the rewrite.
+ *
+ * \return The new checksum field, in host byte order.
+ */
+uint16_t uip_chksum_adjust(uint16_t chksum, uint16_t old_sum, uint16_t new_sum);
+
 /**
  * Calculate the IP header checksum of the packet header in uip_buf.
  *
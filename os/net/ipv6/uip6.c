@@ -75,6 +75,7 @@
 #include "net/ipv6/uip.h"
 #include "net/ipv6/uip-arch.h"
 #include "net/ipv6/uipopt.h"
+#include "net/ipv6/uip-bufpool.h"
 #include "net/ipv6/uip-icmp6.h"
 #include "net/ipv6/uip-nd6.h"
 #include "net/ipv6/uip-ds6.h"
@@ -140,9 +141,9 @@ uint8_t uip_last_proto = 0;
  * @{
  */
 /** Packet buffer for incoming and outgoing packets */
-#ifndef UIP_CONF_EXTERNAL_BUFFER
+#if !defined(UIP_CONF_EXTERNAL_BUFFER) && UIP_BUF_POOL_SIZE == 1
 uip_buf_t uip_aligned_buf;
-#endif /* UIP_CONF_EXTERNAL_BUFFER */
+#endif /* !UIP_CONF_EXTERNAL_BUFFER && UIP_BUF_POOL_SIZE == 1 */
 
 /* The uip_appdata pointer points to application data. */
 void *uip_appdata;
@@ -276,40 +277,60 @@ uip_add32(uint8_t *op32, uint16_t op16)
 }
 #endif /* UIP_TCP */
 
-#if ! UIP_ARCH_CHKSUM
+/*---------------------------------------------------------------------------*/
+static inline uint16_t
+load16(const uint8_t *data)
+{
+  uint16_t w;
+
+  memcpy(&w, data, sizeof(w));
+  return w;
+}
 /*---------------------------------------------------------------------------*/
 static uint16_t
 chksum(uint16_t sum, const uint8_t *data, uint16_t len)
 {
+  uint32_t acc;
   uint16_t t;
-  const uint8_t *dataptr;
-  const uint8_t *last_byte;
 
-  dataptr = data;
-  last_byte = data + len - 1;
+  /* The one's complement sum does not depend on the byte order (RFC
+     1071), so the words are summed as they are in memory. Up to 64 KiB
+     of them cannot overflow the 32-bit accumulator, and the carries are
+     folded in at the end. */
+  acc = UIP_HTONS(sum);
 
-  while(dataptr < last_byte) {   /* At least two more bytes */
-    t = (dataptr[0] << 8) + dataptr[1];
-    sum += t;
-    if(sum < t) {
-      sum++;      /* carry */
-    }
-    dataptr += 2;
+  for(; len >= 8; len -= 8, data += 8) {
+    acc += load16(data);
+    acc += load16(data + 2);
+    acc += load16(data + 4);
+    acc += load16(data + 6);
   }
-
-  if(dataptr == last_byte) {
-    t = (dataptr[0] << 8) + 0;
-    sum += t;
-    if(sum < t) {
-      sum++;      /* carry */
-    }
+  for(; len >= 2; len -= 2, data += 2) {
+    acc += load16(data);
   }
+  if(len == 1) {
+    /* Pad the last byte with a zero byte */
+    t = 0;
+    memcpy(&t, data, 1);
+    acc += t;
+  }
+
+  acc = (acc & 0xffff) + (acc >> 16);
+  acc = (acc & 0xffff) + (acc >> 16);
 
   /* Return sum in host byte order. */
-  return sum;
+  t = (uint16_t)acc;
+  return UIP_HTONS(t);
 }
 /*---------------------------------------------------------------------------*/
 uint16_t
+uip_chksum_add(uint16_t sum, const void *data, uint16_t len)
+{
+  return chksum(sum, data, len);
+}
+/*---------------------------------------------------------------------------*/
+#if ! UIP_ARCH_CHKSUM
+uint16_t
 uip_chksum(uint16_t *data, uint16_t len)
 {
   return uip_htons(chksum(0, (uint8_t *)data, len));
@@ -383,11 +404,28 @@ uip_udpchksum(void)
 #endif /* UIP_UDP && UIP_UDP_CHECKSUMS */
 #endif /* UIP_ARCH_CHKSUM */
 /*---------------------------------------------------------------------------*/
+uint16_t
+uip_chksum_adjust(uint16_t chksum, uint16_t old_sum, uint16_t new_sum)
+{
+  uint32_t acc;
+
+  /* RFC 1624, eqn. 3: HC' = ~(~HC + ~m + m') */
+  acc = (uint16_t)~chksum;
+  acc += (uint16_t)~old_sum;
+  acc += new_sum;
+  acc = (acc & 0xffff) + (acc >> 16);
+  acc = (acc & 0xffff) + (acc >> 16);
+  return ~acc;
+}
+/*---------------------------------------------------------------------------*/
 void
 uip_init(void)
 {
   int c;
 
+#if UIP_BUF_POOL_SIZE > 1
+  uip_bufpool_init();
+#endif /* UIP_BUF_POOL_SIZE > 1 */
   uipbuf_init();
   uip_ds6_init();
   uip_icmp6_init();
@@ -1227,6 +1265,7 @@ uip_process(uint8_t flag)
       LOG_INFO_6ADDR(&UIP_IP_BUF->destipaddr);
       LOG_INFO_("\n");
       UIP_STAT(++uip_stat.ip.forwarded);
+      uipbuf_set_attr_flag(UIPBUF_ATTR_FLAGS_FORWARDED);
       goto send;
     } else {
       if((uip_is_addr_linklocal(&UIP_IP_BUF->srcipaddr)) &&
@@ -1345,6 +1384,7 @@ uip_process(uint8_t flag)
           LOG_INFO_6ADDR(&UIP_IP_BUF->destipaddr);
           LOG_INFO_("\n");
           UIP_STAT(++uip_stat.ip.forwarded);
+          uipbuf_set_attr_flag(UIPBUF_ATTR_FLAGS_FORWARDED);
 
           goto send; /* Proceed to forwarding */
         } else {
@@ -136,6 +136,27 @@
 #define UIP_BUFSIZE (UIP_CONF_BUFFER_SIZE)
 #endif /* UIP_CONF_BUFFER_SIZE */
 
+/**
+ * The number of uIP packet buffers.
+ *
+ * With more than one, the buffers form a reference-counted pool (see
+ * uip-bufpool.h) and uip_buf is a view of the current one, so that a
+ * packet can be handed off without copying it, e.g. when it is queued
+ * during address resolution.
+ *
+ * For now only the packets queued during address resolution use the
+ * pool: each holds a buffer until it is sent or times out, and uip_buf
+ * holds another. With fewer than 1 + UIP_PACKETQUEUE_NUM buffers (3 by
+ * default, which takes the same memory as the single buffer and the
+ * queue entries without a pool), fewer packets can be queued than
+ * without a pool.
+ */
+#ifdef UIP_CONF_BUF_POOL_SIZE
+#define UIP_BUF_POOL_SIZE (UIP_CONF_BUF_POOL_SIZE)
+#else /* UIP_CONF_BUF_POOL_SIZE */
+#define UIP_BUF_POOL_SIZE 1
+#endif /* UIP_CONF_BUF_POOL_SIZE */
+
 /**
  * Determines if statistics support should be compiled in.
  *
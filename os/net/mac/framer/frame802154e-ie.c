@@ -45,6 +45,16 @@
 #define LOG_MODULE "Frame 15.4"
 #define LOG_LEVEL LOG_LEVEL_FRAMER
 
+/* Length of the slotframe description in the TSCH slotframe and link IE,
+   and offset of the first link. The dynamic scheduling service adds the
+   schedule version and base version after the number of links */
+#if DYNSCHED_TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK
+#define SLOTFRAME_HEADER_LEN 6
+#else /* DYNSCHED_TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK */
+#define SLOTFRAME_HEADER_LEN 4
+#endif /* DYNSCHED_TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK */
+#define LINKS_OFFSET (1 + SLOTFRAME_HEADER_LEN)
+
 /* c.f. IEEE 802.15.4e Table 4b */
 enum ieee802154e_header_ie_id {
   HEADER_IE_LE_CSL = 0x1a,
@@ -54,6 +64,10 @@ enum ieee802154e_header_ie_id {
   HEADER_IE_ACK_NACK_TIME_CORRECTION,
   HEADER_IE_GACK,
   HEADER_IE_LOW_LATENCY_NETWORK_INFO,
+  /* Not part of the standard: grants a burst of frames in enhanced ACKs */
+  HEADER_IE_BURST = 0x70,
+  /* Not part of the standard: load level in enhanced ACKs */
+  HEADER_IE_LOAD_LEVEL = 0x71,
   HEADER_IE_LIST_TERMINATION_1 = 0x7e,
   HEADER_IE_LIST_TERMINATION_2 = 0x7f,
 };
@@ -75,6 +89,8 @@ enum ieee802154e_mlme_short_subie_id {
   MLME_SHORT_IE_TSCH_EB_FILTER,
   MLME_SHORT_IE_TSCH_MAC_METRICS_1,
   MLME_SHORT_IE_TSCH_MAC_METRICS_2,
+  /* Not part of the standard: used by the dynamic scheduling service */
+  MLME_SHORT_IE_SCHEDULE_FRAGMENT = 0x70,
 };
 
 /* c.f. IEEE 802.15.4e Table 4e */
@@ -156,6 +172,40 @@ frame80215e_create_ie_header_ack_nack_time_correction(uint8_t *buf, int len,
   }
 }
 
+#if TSCH_WITH_BURST_NEGOTIATION
+/* Header IE. Burst grant. Used in enhanced ACKs */
+int
+frame80215e_create_ie_header_burst(uint8_t *buf, int len,
+    struct ieee802154_ies *ies)
+{
+  int ie_len = 1;
+  if(len >= 2 + ie_len && ies != NULL) {
+    buf[2] = ies->ie_burst_grant;
+    create_header_ie_descriptor(buf, HEADER_IE_BURST, ie_len);
+    return 2 + ie_len;
+  } else {
+    return -1;
+  }
+}
+#endif /* TSCH_WITH_BURST_NEGOTIATION */
+
+#if TSCH_PACKET_EACK_WITH_LOAD_LEVEL
+/* Header IE. Load level. Used in enhanced ACKs */
+int
+frame80215e_create_ie_header_load_level(uint8_t *buf, int len,
+    struct ieee802154_ies *ies)
+{
+  int ie_len = 1;
+  if(len >= 2 + ie_len && ies != NULL) {
+    buf[2] = ies->ie_load_level;
+    create_header_ie_descriptor(buf, HEADER_IE_LOAD_LEVEL, ie_len);
+    return 2 + ie_len;
+  } else {
+    return -1;
+  }
+}
+#endif /* TSCH_PACKET_EACK_WITH_LOAD_LEVEL */
+
 /* Header IE. List termination 1 (Signals the end of the Header IEs when
  * followed by payload IEs) */
 int
@@ -259,7 +309,7 @@ frame80215e_create_ie_tsch_slotframe_and_link(uint8_t *buf, int len,
     int i;
     int num_slotframes = ies->ie_tsch_slotframe_and_link.num_slotframes;
     int num_links = ies->ie_tsch_slotframe_and_link.num_links;
-    int ie_len = 1 + num_slotframes * (4 + 6 * num_links);
+    int ie_len = 1 + num_slotframes * (SLOTFRAME_HEADER_LEN + 6 * num_links);
     if(num_slotframes > 1 || num_links > FRAME802154E_IE_MAX_LINKS
        || len < 2 + ie_len) {
       /* We support only 0 or 1 slotframe in this IE and a predefined maximum number of links */
@@ -272,13 +322,21 @@ frame80215e_create_ie_tsch_slotframe_and_link(uint8_t *buf, int len,
       buf[2 + 1] = ies->ie_tsch_slotframe_and_link.slotframe_handle;
       WRITE16(buf + 2 + 2, ies->ie_tsch_slotframe_and_link.slotframe_size);
       buf[2 + 4] = num_links;
+#if DYNSCHED_TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK
+      buf[2 + 5] = ies->ie_tsch_slotframe_and_link.version;
+      buf[2 + 6] = ies->ie_tsch_slotframe_and_link.base_version;
+#endif /* DYNSCHED_TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK */
       /* Loop over links */
       for(i = 0; i < num_links; i++) {
         /* Insert links */
-        WRITE16(buf + 2 + 5 + i * 6, ies->ie_tsch_slotframe_and_link.links[i].timeslot);
-        WRITE16(buf + 2 + 5 + i * 6 + 2, ies->ie_tsch_slotframe_and_link.links[i].channel_offset);
-        buf[2 + 5 + i * 6 + 4] = ies->ie_tsch_slotframe_and_link.links[i].link_options;	
-        buf[2 + 5 + i * 6 + 5] = ies->ie_tsch_slotframe_and_link.links[i].nodeid;
+        WRITE16(buf + 2 + LINKS_OFFSET + i * 6, ies->ie_tsch_slotframe_and_link.links[i].timeslot);
+        WRITE16(buf + 2 + LINKS_OFFSET + i * 6 + 2, ies->ie_tsch_slotframe_and_link.links[i].channel_offset);
+        buf[2 + LINKS_OFFSET + i * 6 + 4] = ies->ie_tsch_slotframe_and_link.links[i].link_options;
+#if DYNSCHED_TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK
+        buf[2 + LINKS_OFFSET + i * 6 + 4] |=
+          ies->ie_tsch_slotframe_and_link.links[i].op << FRAME802154E_IE_LINK_OP_SHIFT;
+#endif /* DYNSCHED_TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK */
+        buf[2 + LINKS_OFFSET + i * 6 + 5] = ies->ie_tsch_slotframe_and_link.links[i].nodeid;
       }
     }
     create_mlme_short_ie_descriptor(buf, MLME_SHORT_IE_TSCH_SLOFTRAME_AND_LINK, ie_len);
@@ -288,6 +346,34 @@ frame80215e_create_ie_tsch_slotframe_and_link(uint8_t *buf, int len,
   }
 }
 
+#if DYNSCHED_TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK
+/* MLME sub-IE. Fragment of a network schedule. Used in EBs by the dynamic
+ * scheduling service */
+int
+frame80215e_create_ie_schedule_fragment(uint8_t *buf, int len,
+    struct ieee802154_ies *ies)
+{
+  if(ies != NULL) {
+    int ie_len = 5 + ies->ie_schedule_fragment.len;
+    if(ies->ie_schedule_fragment.len == 0) {
+      return 0;
+    }
+    if(len < 2 + ie_len) {
+      return -1;
+    }
+    buf[2] = ies->ie_schedule_fragment.version;
+    buf[3] = ies->ie_schedule_fragment.count;
+    buf[4] = ies->ie_schedule_fragment.index;
+    WRITE16(buf + 5, ies->ie_schedule_fragment.offset);
+    memcpy(buf + 7, ies->ie_schedule_fragment.data, ies->ie_schedule_fragment.len);
+    create_mlme_short_ie_descriptor(buf, MLME_SHORT_IE_SCHEDULE_FRAGMENT, ie_len);
+    return 2 + ie_len;
+  } else {
+    return -1;
+  }
+}
+#endif /* DYNSCHED_TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK */
+
 /* MLME sub-IE. TSCH timeslot. Used in EBs: timeslot template (timing) */
 int
 frame80215e_create_ie_tsch_timeslot(uint8_t *buf, int len,
@@ -372,6 +458,27 @@ frame802154e_parse_header_ie(const uint8_t *buf, int len,
         return len;
       }
       break;
+#if TSCH_WITH_BURST_NEGOTIATION
+    case HEADER_IE_BURST:
+      if(len == 1) {
+        if(ies != NULL) {
+          ies->ie_burst_grant = buf[0];
+        }
+        return len;
+      }
+      break;
+#endif /* TSCH_WITH_BURST_NEGOTIATION */
+#if TSCH_PACKET_EACK_WITH_LOAD_LEVEL
+    case HEADER_IE_LOAD_LEVEL:
+      if(len == 1) {
+        if(ies != NULL) {
+          ies->ie_has_load_level = 1;
+          ies->ie_load_level = buf[0];
+        }
+        return len;
+      }
+      break;
+#endif /* TSCH_PACKET_EACK_WITH_LOAD_LEVEL */
   }
   return -1;
 }
@@ -391,24 +498,49 @@ frame802154e_parse_mlme_short_ie(const uint8_t *buf, int len,
           return len;
         }
         if(num_slotframes <= 1 && num_links <= FRAME802154E_IE_MAX_LINKS
-            && len == 1 + num_slotframes * (4 + 6 * num_links)) {
+            && len == 1 + num_slotframes * (SLOTFRAME_HEADER_LEN + 6 * num_links)) {
           if(ies != NULL) {
             /* We support only 0 or 1 slotframe in this IE and a predefined maximum number of links */
             ies->ie_tsch_slotframe_and_link.num_slotframes = buf[0];
             ies->ie_tsch_slotframe_and_link.slotframe_handle = buf[1];
             READ16(buf + 2, ies->ie_tsch_slotframe_and_link.slotframe_size);
             ies->ie_tsch_slotframe_and_link.num_links = buf[4];
+#if DYNSCHED_TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK
+            ies->ie_tsch_slotframe_and_link.version = buf[5];
+            ies->ie_tsch_slotframe_and_link.base_version = buf[6];
+#endif /* DYNSCHED_TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK */
             for(i = 0; i < num_links; i++) {
-              READ16(buf + 5 + i * 6, ies->ie_tsch_slotframe_and_link.links[i].timeslot);
-              READ16(buf + 5 + i * 6 + 2, ies->ie_tsch_slotframe_and_link.links[i].channel_offset);
-              ies->ie_tsch_slotframe_and_link.links[i].link_options = buf[5 + i * 6 + 4];
-              ies->ie_tsch_slotframe_and_link.links[i].nodeid = buf[5 + i * 6 + 5];
+              READ16(buf + LINKS_OFFSET + i * 6, ies->ie_tsch_slotframe_and_link.links[i].timeslot);
+              READ16(buf + LINKS_OFFSET + i * 6 + 2, ies->ie_tsch_slotframe_and_link.links[i].channel_offset);
+              ies->ie_tsch_slotframe_and_link.links[i].link_options = buf[LINKS_OFFSET + i * 6 + 4];
+#if DYNSCHED_TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK
+              ies->ie_tsch_slotframe_and_link.links[i].op =
+                buf[LINKS_OFFSET + i * 6 + 4] >> FRAME802154E_IE_LINK_OP_SHIFT;
+              ies->ie_tsch_slotframe_and_link.links[i].link_options &=
+                (1 << FRAME802154E_IE_LINK_OP_SHIFT) - 1;
+#endif /* DYNSCHED_TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK */
+              ies->ie_tsch_slotframe_and_link.links[i].nodeid = buf[LINKS_OFFSET + i * 6 + 5];
             }
           }
           return len;
         }
       }
       break;
+#if DYNSCHED_TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK
+    case MLME_SHORT_IE_SCHEDULE_FRAGMENT:
+      if(len > 5) {
+        if(ies != NULL) {
+          ies->ie_schedule_fragment.version = buf[0];
+          ies->ie_schedule_fragment.count = buf[1];
+          ies->ie_schedule_fragment.index = buf[2];
+          READ16(buf + 3, ies->ie_schedule_fragment.offset);
+          ies->ie_schedule_fragment.len = len - 5;
+          ies->ie_schedule_fragment.data = buf + 5;
+        }
+        return len;
+      }
+      break;
+#endif /* DYNSCHED_TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK */
     case MLME_SHORT_IE_TSCH_SYNCHRONIZATION:
       if(len == 6) {
         if(ies != NULL) {
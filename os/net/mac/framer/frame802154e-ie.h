@@ -51,26 +51,57 @@
 
 #define FRAME802154E_IE_MAX_LINKS       4
 
+/* Operations of a schedule delta, carried in the two upper bits of
+   the link options when the dynamic scheduling service is enabled */
+#define FRAME802154E_IE_LINK_OP_ADD     0
+#define FRAME802154E_IE_LINK_OP_REMOVE  1
+#define FRAME802154E_IE_LINK_OP_MODIFY  2
+#define FRAME802154E_IE_LINK_OP_SHIFT   6
+
 /* Structures used for the Slotframe and Links information element */
 struct tsch_slotframe_and_links_link {
   uint16_t timeslot;
   uint16_t channel_offset;
   uint8_t link_options;
   uint8_t nodeid;
+  uint8_t op;
 };
 struct tsch_slotframe_and_links {
   uint8_t num_slotframes; /* We support only 0 or 1 slotframe in this IE */
   uint8_t slotframe_handle;
   uint16_t slotframe_size;
   uint8_t num_links;
+  /* Version of the schedule, and version the links apply to as a
+     delta. The links form the complete schedule when both are equal */
+  uint8_t version;
+  uint8_t base_version;
   struct tsch_slotframe_and_links_link links[FRAME802154E_IE_MAX_LINKS];
 };
 
+/* Fragment of an encoded network schedule, sent by the dynamic
+   scheduling service in EBs when the schedule does not fit in the
+   slotframe and link IE */
+struct tsch_schedule_fragment {
+  uint8_t version; /* Version of the schedule */
+  uint8_t count; /* Number of fragments of the schedule */
+  uint8_t index; /* Index of this fragment */
+  uint16_t offset; /* Offset of the fragment in the encoded schedule */
+  uint8_t len; /* Length of the fragment data, 0 if there is none */
+  const uint8_t *data;
+};
+
 /* The information elements that we currently support */
 struct ieee802154_ies {
   /* Header IEs */
   int16_t ie_time_correction;
   uint8_t ie_is_nack;
+#if TSCH_WITH_BURST_NEGOTIATION
+  uint8_t ie_burst_grant; /* Number of further frames accepted in a burst */
+#endif /* TSCH_WITH_BURST_NEGOTIATION */
+#if TSCH_PACKET_EACK_WITH_LOAD_LEVEL
+  uint8_t ie_has_load_level;
+  uint8_t ie_load_level; /* Load level of the sender of the enhanced ACK */
+#endif /* TSCH_PACKET_EACK_WITH_LOAD_LEVEL */
   /* Payload MLME */
   uint8_t ie_payload_ie_offset;
   uint16_t ie_mlme_len;
@@ -81,6 +112,9 @@ struct ieee802154_ies {
   uint8_t ie_tsch_timeslot_id;
   uint16_t ie_tsch_timeslot[tsch_ts_elements_count];
   struct tsch_slotframe_and_links ie_tsch_slotframe_and_link;
+#if DYNSCHED_TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK
+  struct tsch_schedule_fragment ie_schedule_fragment;
+#endif /* DYNSCHED_TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK */
   /* Payload Long MLME IEs */
   uint8_t ie_channel_hopping_sequence_id;
   /* We include and parse only the sequence len and list and omit unused fields */
@@ -97,6 +131,16 @@ struct ieee802154_ies {
 /* Header IE. ACK/NACK time correction. Used in enhanced ACKs */
 int frame80215e_create_ie_header_ack_nack_time_correction(uint8_t *buf, int len,
     struct ieee802154_ies *ies);
+#if TSCH_WITH_BURST_NEGOTIATION
+/* Header IE. Burst grant. Used in enhanced ACKs */
+int frame80215e_create_ie_header_burst(uint8_t *buf, int len,
+    struct ieee802154_ies *ies);
+#endif /* TSCH_WITH_BURST_NEGOTIATION */
+#if TSCH_PACKET_EACK_WITH_LOAD_LEVEL
+/* Header IE. Load level. Used in enhanced ACKs */
+int frame80215e_create_ie_header_load_level(uint8_t *buf, int len,
+    struct ieee802154_ies *ies);
+#endif /* TSCH_PACKET_EACK_WITH_LOAD_LEVEL */
 /* Header IE. List termination 1 (Signals the end of the Header IEs when
  * followed by payload IEs) */
 int frame80215e_create_ie_header_list_termination_1(uint8_t *buf, int len,
@@ -122,6 +166,12 @@ int frame80215e_create_ie_tsch_synchronization(uint8_t *buf, int len,
 /* MLME sub-IE. TSCH slotframe and link. Used in EBs: initial schedule */
 int frame80215e_create_ie_tsch_slotframe_and_link(uint8_t *buf, int len,
     struct ieee802154_ies *ies);
+#if DYNSCHED_TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK
+/* MLME sub-IE. Fragment of a network schedule. Used in EBs by the dynamic
+ * scheduling service. Nothing is inserted when there is no fragment */
+int frame80215e_create_ie_schedule_fragment(uint8_t *buf, int len,
+    struct ieee802154_ies *ies);
+#endif /* DYNSCHED_TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK */
 /* MLME sub-IE. TSCH timeslot. Used in EBs: timeslot template (timing) */
 int frame80215e_create_ie_tsch_timeslot(uint8_t *buf, int len,
     struct ieee802154_ies *ies);
@@ -300,6 +300,37 @@
 #endif
 #endif
 
+/* The number of traffic classes per neighbor. Each class has its own queue
+ * of TSCH_QUEUE_NUM_PER_NEIGHBOR packets. The class of a packet is taken
+ * from PACKETBUF_ATTR_TSCH_TRAFFIC_CLASS, the highest class being served
+ * first */
+#ifdef TSCH_QUEUE_CONF_NUM_CLASSES
+#define TSCH_QUEUE_NUM_CLASSES TSCH_QUEUE_CONF_NUM_CLASSES
+#else
+#define TSCH_QUEUE_NUM_CLASSES 1
+#endif
+
+/* Give packets a deadline, taken as a number of clock ticks from
+ * PACKETBUF_ATTR_TSCH_DEADLINE (0 for none). Packets still queued past
+ * their deadline are dropped */
+#ifdef TSCH_QUEUE_CONF_WITH_DEADLINE
+#define TSCH_QUEUE_WITH_DEADLINE TSCH_QUEUE_CONF_WITH_DEADLINE
+#else
+#define TSCH_QUEUE_WITH_DEADLINE 0
+#endif
+
+/* Serve the traffic classes of a neighbor earliest deadline first rather
+ * than by strict priority. Packets without a deadline come last. */
+#ifdef TSCH_QUEUE_CONF_EDF
+#define TSCH_QUEUE_EDF TSCH_QUEUE_CONF_EDF
+#else
+#define TSCH_QUEUE_EDF 0
+#endif
+
+#if TSCH_QUEUE_EDF && !TSCH_QUEUE_WITH_DEADLINE
+#error TSCH_QUEUE_EDF requires TSCH_QUEUE_WITH_DEADLINE
+#endif
+
 /* The number of neighbor queues. There are two queues allocated at all times:
  * one for EBs, one for broadcasts. Other queues are for unicast to neighbors */
 #ifdef TSCH_QUEUE_CONF_MAX_NEIGHBOR_QUEUES
@@ -308,6 +339,31 @@
 #define TSCH_QUEUE_MAX_NEIGHBOR_QUEUES ((NBR_TABLE_CONF_MAX_NEIGHBORS) + 2)
 #endif
 
+/* Index the neighbor queues by address in a hash table, so that
+ * tsch_queue_get_nbr does not walk all neighbors */
+#ifdef TSCH_QUEUE_CONF_WITH_NBR_HASH
+#define TSCH_QUEUE_WITH_NBR_HASH TSCH_QUEUE_CONF_WITH_NBR_HASH
+#else
+#define TSCH_QUEUE_WITH_NBR_HASH 0
+#endif
+
+/* Number of slots in the neighbor hash table. Must be larger than
+ * TSCH_QUEUE_MAX_NEIGHBOR_QUEUES */
+#ifdef TSCH_QUEUE_CONF_NBR_HASH_SIZE
+#define TSCH_QUEUE_NBR_HASH_SIZE TSCH_QUEUE_CONF_NBR_HASH_SIZE
+#else
+#define TSCH_QUEUE_NBR_HASH_SIZE (2 * TSCH_QUEUE_MAX_NEIGHBOR_QUEUES)
+#endif
+
+/* Keep a bitmap of the unicast neighbors that have packets queued and an
+ * expired backoff, so that a shared slot finds a packet without walking
+ * all neighbors */
+#ifdef TSCH_QUEUE_CONF_WITH_READY_SET
+#define TSCH_QUEUE_WITH_READY_SET TSCH_QUEUE_CONF_WITH_READY_SET
+#else
+#define TSCH_QUEUE_WITH_READY_SET 0
+#endif
+
 /******** Configuration: scheduling  *******/
 
 /* Initializes TSCH with a 6TiSCH minimal schedule */
@@ -326,6 +382,17 @@
 #define TSCH_BURST_MAX_LEN 32
 #endif
 
+/* Negotiate bursts: the receiver of a frame with the frame pending bit
+ * grants a burst in its enhanced ACK, with a Burst IE telling how many
+ * more frames it accepts (bounded by TSCH_BURST_MAX_LEN and the room left
+ * in its input queue). The sender only uses the next slot for a burst if
+ * it was granted. All nodes of a network must use the same setting. */
+#ifdef TSCH_CONF_WITH_BURST_NEGOTIATION
+#define TSCH_WITH_BURST_NEGOTIATION TSCH_CONF_WITH_BURST_NEGOTIATION
+#else
+#define TSCH_WITH_BURST_NEGOTIATION 0
+#endif
+
 /* 6TiSCH Minimal schedule slotframe length */
 #ifdef TSCH_SCHEDULE_CONF_DEFAULT_LENGTH
 #define TSCH_SCHEDULE_DEFAULT_LENGTH TSCH_SCHEDULE_CONF_DEFAULT_LENGTH
@@ -347,6 +414,27 @@
 #define TSCH_SCHEDULE_MAX_LINKS 32
 #endif
 
+/* Keep all links in an array sorted by slotframe handle and timeslot,
+ * so that the next active link is found with a binary search per
+ * slotframe rather than by scanning every link at every slot */
+#ifdef TSCH_SCHEDULE_CONF_WITH_LINK_INDEX
+#define TSCH_SCHEDULE_WITH_LINK_INDEX TSCH_SCHEDULE_CONF_WITH_LINK_INDEX
+#else
+#define TSCH_SCHEDULE_WITH_LINK_INDEX 0
+#endif
+
+/* Edit the schedule and the neighbor list without the TSCH lock. Items
+ * are published to the slot operation fully initialized, and removed
+ * items are freed only once the slot operation can no longer use them,
+ * by the pending events process at the end of that slot operation.
+ * Processes never wait for a slot to end, and the slot operation never
+ * skips slots for them. */
+#ifdef TSCH_CONF_WITH_LOCK_FREE
+#define TSCH_WITH_LOCK_FREE TSCH_CONF_WITH_LOCK_FREE
+#else
+#define TSCH_WITH_LOCK_FREE 0
+#endif
+
 /* To include Sixtop Implementation */
 #ifdef TSCH_CONF_WITH_SIXTOP
 #define TSCH_WITH_SIXTOP TSCH_CONF_WITH_SIXTOP
@@ -394,6 +482,16 @@
 #define TSCH_PACKET_EACK_WITH_SRC_ADDR 0
 #endif
 
+/* Include a Load IE in enhanced ACKs? The IE carries the load level
+ * returned by TSCH_CALLBACK_EACK_LOAD_LEVEL, and is passed to
+ * TSCH_CALLBACK_LOAD_LEVEL_RECEIVED at the sender of the ACKed frame.
+ * Used by the adaptive Orchestra rule. */
+#ifdef TSCH_PACKET_CONF_EACK_WITH_LOAD_LEVEL
+#define TSCH_PACKET_EACK_WITH_LOAD_LEVEL TSCH_PACKET_CONF_EACK_WITH_LOAD_LEVEL
+#else
+#define TSCH_PACKET_EACK_WITH_LOAD_LEVEL 0
+#endif
+
 /* Perform CCA before sending? */
 #ifdef TSCH_CONF_CCA_ENABLED
 #define TSCH_CCA_ENABLED TSCH_CONF_CCA_ENABLED
@@ -94,7 +94,8 @@ tsch_packet_eackbuf_attr(uint8_t type)
 int
 tsch_packet_create_eack(uint8_t *buf, uint16_t buf_len,
                         const linkaddr_t *dest_addr, uint8_t seqno,
-                        int16_t drift, int nack)
+                        int16_t drift, int nack, uint8_t burst_grant,
+                        int load_level)
 {
   frame802154_t params;
   struct ieee802154_ies ies;
@@ -154,6 +155,32 @@ tsch_packet_create_eack(uint8_t *buf, uint16_t buf_len,
   }
   ack_len += hdr_len;
 
+#if TSCH_WITH_BURST_NEGOTIATION
+  if(burst_grant > 0) {
+    int ie_len;
+    ies.ie_burst_grant = burst_grant;
+    ie_len = frame80215e_create_ie_header_burst(buf + ack_len,
+                                                buf_len - ack_len, &ies);
+    if(ie_len < 0) {
+      return -1;
+    }
+    ack_len += ie_len;
+  }
+#endif /* TSCH_WITH_BURST_NEGOTIATION */
+
+#if TSCH_PACKET_EACK_WITH_LOAD_LEVEL
+  if(load_level >= 0) {
+    int ie_len;
+    ies.ie_load_level = load_level > 0xff ? 0xff : load_level;
+    ie_len = frame80215e_create_ie_header_load_level(buf + ack_len,
+                                                     buf_len - ack_len, &ies);
+    if(ie_len < 0) {
+      return -1;
+    }
+    ack_len += ie_len;
+  }
+#endif /* TSCH_PACKET_EACK_WITH_LOAD_LEVEL */
+
   frame802154_create(&params, buf);
 
   return ack_len;
@@ -325,6 +352,17 @@ tsch_packet_create_eb(uint8_t *hdr_len, uint8_t *tsch_sync_ie_offset)
   p += ie_len;
   packetbuf_set_datalen(packetbuf_datalen() + ie_len);
 
+#if DYNSCHED_TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK
+  ie_len = frame80215e_create_ie_schedule_fragment(p,
+                                                   packetbuf_remaininglen(),
+                                                   &ies);
+  if(ie_len < 0) {
+    return -1;
+  }
+  p += ie_len;
+  packetbuf_set_datalen(packetbuf_datalen() + ie_len);
+#endif /* DYNSCHED_TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK */
+
 #if 0
   /* Payload IE list termination: optional */
   ie_len = frame80215e_create_ie_payload_list_termination(p,
@@ -56,11 +56,16 @@
  * \param seqno The sequence number we are ACKing
  * \param drift The time offset in usec measured at Rx of the packer we are ACKing
  * \param nack Value of the NACK bit
+ * \param burst_grant Number of further frames we accept in a burst, sent
+ * in a Burst IE if non-zero (only with TSCH_WITH_BURST_NEGOTIATION)
+ * \param load_level Our load level, sent in a Load IE if non-negative (only
+ * with TSCH_PACKET_EACK_WITH_LOAD_LEVEL)
  * \return The length of the packet that was created. -1 if failure.
  */
 int tsch_packet_create_eack(uint8_t *buf, uint16_t buf_size,
                             const linkaddr_t *dest_addr, uint8_t seqno,
-                            int16_t drift, int nack);
+                            int16_t drift, int nack, uint8_t burst_grant,
+                            int load_level);
 /**
  * \brief Parse enhanced ACK packet
  * \param buf The buffer where to parse the EACK from
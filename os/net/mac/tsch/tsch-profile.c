@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+/**
+ * \file
+ *         TSCH slot timing profiler
+ */
+
+/**
+ * \addtogroup tsch
+ * @{
+*/
+
+#include "contiki.h"
+#include "net/mac/tsch/tsch.h"
+#include "sys/critical.h"
+
+#include <string.h>
+
+/* Not all platforms provide RTIMERTICKS_TO_US in their rtimer-arch.h */
+#ifdef RTIMERTICKS_TO_US
+#define TICKS_TO_US(T) RTIMERTICKS_TO_US(T)
+#else
+#define TICKS_TO_US(T) ((uint32_t)(((uint64_t)(T) * 1000000) / RTIMER_SECOND))
+#endif
+
+/*---------------------------------------------------------------------------*/
+#if TSCH_PROFILE_ON
+/*---------------------------------------------------------------------------*/
+
+static struct tsch_profile_histogram histograms[TSCH_PROFILE_NUM_METRICS];
+static uint32_t timer_misses;
+
+/* Start of the current slot, and whether we are in an active slot */
+static rtimer_clock_t slot_start_time;
+static uint8_t in_slot;
+/* Radio state, as seen from the slot operation */
+static uint8_t radio_is_on;
+static uint8_t radio_was_on_in_slot;
+static rtimer_clock_t radio_on_time;
+static rtimer_clock_t radio_on_total;
+
+static const char *const metric_names[TSCH_PROFILE_NUM_METRICS] = {
+  "slot", "radio-on", "radio-duty", "drift", "next-link"
+};
+
+/*---------------------------------------------------------------------------*/
+static uint8_t
+bucket_index(uint32_t us)
+{
+  uint8_t i = 0;
+  while(us != 0 && i < TSCH_PROFILE_NUM_BUCKETS - 1) {
+    us >>= 1;
+    i++;
+  }
+  return i;
+}
+/*---------------------------------------------------------------------------*/
+static rtimer_clock_t
+elapsed_since(rtimer_clock_t ref)
+{
+  int32_t diff = RTIMER_CLOCK_DIFF(RTIMER_NOW(), ref);
+  return diff > 0 ? (rtimer_clock_t)diff : 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_profile_add(enum tsch_profile_metric metric, rtimer_clock_t ticks)
+{
+  struct tsch_profile_histogram *h;
+  uint32_t us;
+
+  if(metric >= TSCH_PROFILE_NUM_METRICS) {
+    return;
+  }
+  h = &histograms[metric];
+  us = TICKS_TO_US((int32_t)ticks);
+  if(h->count == 0 || us < h->min) {
+    h->min = us;
+  }
+  h->count++;
+  h->sum += us;
+  if(us > h->max) {
+    h->max = us;
+  }
+  h->buckets[bucket_index(us)]++;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_profile_slot_start(rtimer_clock_t slot_start)
+{
+  slot_start_time = slot_start;
+  in_slot = 1;
+  radio_was_on_in_slot = radio_is_on;
+  radio_on_total = 0;
+  if(radio_is_on) {
+    radio_on_time = slot_start;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_profile_slot_end(void)
+{
+  if(!in_slot) {
+    return;
+  }
+  in_slot = 0;
+  if(radio_is_on) {
+    radio_on_total += elapsed_since(radio_on_time);
+    radio_on_time = RTIMER_NOW();
+  }
+  tsch_profile_add(TSCH_PROFILE_SLOT, elapsed_since(slot_start_time));
+  if(radio_was_on_in_slot) {
+    tsch_profile_add(TSCH_PROFILE_RADIO_DUTY, radio_on_total);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_profile_radio_on(void)
+{
+  if(in_slot && !radio_was_on_in_slot) {
+    tsch_profile_add(TSCH_PROFILE_RADIO_ON, elapsed_since(slot_start_time));
+    radio_was_on_in_slot = 1;
+  }
+  if(!radio_is_on) {
+    radio_is_on = 1;
+    radio_on_time = RTIMER_NOW();
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_profile_radio_off(void)
+{
+  if(radio_is_on) {
+    radio_is_on = 0;
+    if(in_slot) {
+      radio_on_total += elapsed_since(radio_on_time);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_profile_timer_miss(void)
+{
+  timer_misses++;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_profile_reset(void)
+{
+  int_master_status_t status = critical_enter();
+  memset(histograms, 0, sizeof(histograms));
+  timer_misses = 0;
+  critical_exit(status);
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+tsch_profile_get(enum tsch_profile_metric metric,
+                 struct tsch_profile_histogram *h)
+{
+  uint32_t misses;
+  int_master_status_t status = critical_enter();
+  if(h != NULL && metric < TSCH_PROFILE_NUM_METRICS) {
+    memcpy(h, &histograms[metric], sizeof(*h));
+  }
+  misses = timer_misses;
+  critical_exit(status);
+  return misses;
+}
+/*---------------------------------------------------------------------------*/
+const char *
+tsch_profile_metric_name(enum tsch_profile_metric metric)
+{
+  return metric < TSCH_PROFILE_NUM_METRICS ? metric_names[metric] : "?";
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t *
+write_le(uint8_t *p, uint64_t value, int len)
+{
+  while(len-- > 0) {
+    *p++ = value & 0xff;
+    value >>= 8;
+  }
+  return p;
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_profile_dump(uint8_t *buf, int len)
+{
+  uint8_t *p = buf;
+  int i, j;
+  int_master_status_t status;
+
+  if(buf == NULL || len < TSCH_PROFILE_DUMP_SIZE) {
+    return 0;
+  }
+
+  status = critical_enter();
+  *p++ = TSCH_PROFILE_DUMP_VERSION;
+  *p++ = TSCH_PROFILE_NUM_METRICS;
+  *p++ = TSCH_PROFILE_NUM_BUCKETS;
+  *p++ = 0;
+  p = write_le(p, timer_misses, 4);
+  for(i = 0; i < TSCH_PROFILE_NUM_METRICS; i++) {
+    p = write_le(p, histograms[i].count, 4);
+    p = write_le(p, histograms[i].min, 4);
+    p = write_le(p, histograms[i].max, 4);
+    p = write_le(p, histograms[i].sum, 8);
+    for(j = 0; j < TSCH_PROFILE_NUM_BUCKETS; j++) {
+      p = write_le(p, histograms[i].buckets[j], 4);
+    }
+  }
+  critical_exit(status);
+
+  return p - buf;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* TSCH_PROFILE_ON */
+/** @} */
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+/**
+ * \file
+ *         Header file for the TSCH slot timing profiler. Collects fixed-bucket
+ *         histograms of the slot operation timing, to see how much margin is
+ *         left before missing a slot deadline (e.g. with shorter timeslot
+ *         templates). All values are in microseconds; bucket 0 holds zeros,
+ *         bucket i > 0 holds values in [2^(i-1), 2^i), and the last bucket
+ *         also holds everything above.
+ */
+
+/**
+ * \addtogroup tsch
+ * @{
+*/
+
+#ifndef __TSCH_PROFILE_H__
+#define __TSCH_PROFILE_H__
+
+/********** Includes **********/
+
+#include "contiki.h"
+
+/************ Constants ***********/
+
+/* Enable the TSCH slot timing profiler? */
+#ifdef TSCH_PROFILE_CONF_ON
+#define TSCH_PROFILE_ON TSCH_PROFILE_CONF_ON
+#else
+#define TSCH_PROFILE_ON 0
+#endif
+
+/* The number of buckets of each histogram. 16 buckets go up to 16 ms */
+#ifdef TSCH_PROFILE_CONF_NUM_BUCKETS
+#define TSCH_PROFILE_NUM_BUCKETS TSCH_PROFILE_CONF_NUM_BUCKETS
+#else
+#define TSCH_PROFILE_NUM_BUCKETS 16
+#endif
+
+/* Version of the binary dump format */
+#define TSCH_PROFILE_DUMP_VERSION 2
+
+/*
+ * Size of the binary dump. All fields are little endian:
+ *   version (1) | num metrics (1) | num buckets (1) | reserved (1) |
+ *   timer misses (4) |
+ *   per metric: count (4) | min (4) | max (4) | sum (8) |
+ *     buckets (4 x num buckets)
+ */
+#define TSCH_PROFILE_DUMP_SIZE \
+  (8 + TSCH_PROFILE_NUM_METRICS * (20 + 4 * TSCH_PROFILE_NUM_BUCKETS))
+
+/************ Types ***********/
+
+enum tsch_profile_metric {
+  /* From the start of an active slot until the next slot is scheduled */
+  TSCH_PROFILE_SLOT,
+  /* From the start of the slot until the radio is first turned on */
+  TSCH_PROFILE_RADIO_ON,
+  /* Time the radio was on within the slot */
+  TSCH_PROFILE_RADIO_DUTY,
+  /* Absolute drift measured at Rx, or received in an EACK at Tx */
+  TSCH_PROFILE_DRIFT,
+  /* Time spent in tsch_schedule_get_next_active_link */
+  TSCH_PROFILE_NEXT_LINK,
+  TSCH_PROFILE_NUM_METRICS
+};
+
+struct tsch_profile_histogram {
+  uint32_t count;
+  uint32_t min; /* 0 while count is 0 */
+  uint32_t max;
+  uint64_t sum;
+  uint32_t buckets[TSCH_PROFILE_NUM_BUCKETS];
+};
+
+/************ Functions ***********/
+
+#if TSCH_PROFILE_ON
+
+/* Called from the slot operation, in interrupt context */
+void tsch_profile_slot_start(rtimer_clock_t slot_start);
+void tsch_profile_slot_end(void);
+void tsch_profile_radio_on(void);
+void tsch_profile_radio_off(void);
+void tsch_profile_add(enum tsch_profile_metric metric, rtimer_clock_t ticks);
+void tsch_profile_timer_miss(void);
+
+/* Clears all histograms */
+void tsch_profile_reset(void);
+/* Copies a histogram. Returns the number of timer misses */
+uint32_t tsch_profile_get(enum tsch_profile_metric metric,
+                          struct tsch_profile_histogram *h);
+/* Name of a metric, for printing */
+const char *tsch_profile_metric_name(enum tsch_profile_metric metric);
+/* Writes the binary dump to buf. Returns its length, or 0 if len is
+ * shorter than TSCH_PROFILE_DUMP_SIZE */
+int tsch_profile_dump(uint8_t *buf, int len);
+
+#else /* TSCH_PROFILE_ON */
+
+#define tsch_profile_slot_start(slot_start)
+#define tsch_profile_slot_end()
+#define tsch_profile_radio_on()
+#define tsch_profile_radio_off()
+#define tsch_profile_add(metric, ticks)
+#define tsch_profile_timer_miss()
+#define tsch_profile_reset()
+
+#endif /* TSCH_PROFILE_ON */
+
+#endif /* __TSCH_PROFILE_H__ */
+/** @} */
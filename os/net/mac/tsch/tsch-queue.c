@@ -33,7 +33,7 @@
 /**
  * \file
  *         Per-neighbor packet queues for TSCH MAC.
- *         The list of neighbors uses the TSCH lock, but per-neighbor packet array are lock-free.
+ *         The list of neighbors uses the TSCH lock (unless TSCH_WITH_LOCK_FREE), but per-neighbor packet array are lock-free.
  *				 Read-only operation on neighbor and packets are allowed from interrupts and outside of them.
  *				 *Other operations are allowed outside of interrupt only.*
  * \author
@@ -51,8 +51,11 @@
 #include "lib/list.h"
 #include "lib/memb.h"
 #include "lib/random.h"
+#include "lib/bitmap.h"
+#include "lib/hash-index.h"
 #include "net/queuebuf.h"
 #include "net/mac/tsch/tsch.h"
+#include "sys/critical.h"
 #include <string.h>
 
 /* Log configuration */
@@ -74,6 +77,186 @@ LIST(neighbor_list);
 struct tsch_neighbor *n_broadcast;
 struct tsch_neighbor *n_eb;
 
+#if TSCH_WITH_LOCK_FREE
+/* Neighbors removed while the slot operation may still use them,
+ * freed once it has ended */
+LIST(removed_neighbor_list);
+static uint16_t removed_neighbor_epoch;
+#endif /* TSCH_WITH_LOCK_FREE */
+
+#if TSCH_QUEUE_NUM_CLASSES > 1
+#define PACKET_CLASS(p) ((p)->tx_class)
+#else
+#define PACKET_CLASS(p) 0
+#endif
+
+#if TSCH_QUEUE_WITH_DEADLINE
+/* Number of packets dropped because their deadline had passed */
+static uint32_t expired_count;
+#endif /* TSCH_QUEUE_WITH_DEADLINE */
+
+#if TSCH_QUEUE_WITH_NBR_HASH || TSCH_QUEUE_WITH_READY_SET
+#define NBR_INDEX(n) ((struct tsch_neighbor *)(n) - (struct tsch_neighbor *)neighbor_memb.mem)
+#define NBR_FROM_INDEX(i) ((struct tsch_neighbor *)neighbor_memb.mem + (i))
+#endif
+
+#if TSCH_QUEUE_WITH_NBR_HASH
+#if TSCH_QUEUE_NBR_HASH_SIZE <= TSCH_QUEUE_MAX_NEIGHBOR_QUEUES
+#error TSCH_QUEUE_NBR_HASH_SIZE must be larger than TSCH_QUEUE_MAX_NEIGHBOR_QUEUES
+#endif
+static uint32_t nbr_hash(unsigned index);
+static int nbr_match(unsigned index, const void *addr);
+/* Index from address to neighbor index. Updated by processes while the
+ * slot operation may be reading it, which the hash index allows. */
+HASH_INDEX(nbr_index, TSCH_QUEUE_NBR_HASH_SIZE, nbr_hash, nbr_match);
+#endif /* TSCH_QUEUE_WITH_NBR_HASH */
+
+#if TSCH_QUEUE_WITH_READY_SET
+/* One bit per neighbor index. A set bit is only a hint: the neighbor is
+ * checked before use, and its bit cleared if it has nothing to send or
+ * has tx links of its own. Bits are set whenever a unicast neighbor
+ * without tx links may have become ready. */
+#define READY_SET_WORDS ((TSCH_QUEUE_MAX_NEIGHBOR_QUEUES + 31) / 32)
+static uint32_t ready_set[READY_SET_WORDS];
+#endif /* TSCH_QUEUE_WITH_READY_SET */
+
+/*---------------------------------------------------------------------------*/
+/* Are the queues of all traffic classes of a neighbor empty? */
+static int
+nbr_queue_empty(const struct tsch_neighbor *n)
+{
+  int c;
+  for(c = 0; c < TSCH_QUEUE_NUM_CLASSES; c++) {
+    if(!ringbufindex_empty(&n->tx_ringbuf[c])) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Remove the first packet of a traffic class from a neighbor queue */
+static struct tsch_packet *
+remove_packet_from_class(struct tsch_neighbor *n, int c)
+{
+  /* Get and remove packet from ringbuf (remove committed through an atomic operation */
+  int16_t get_index = ringbufindex_get(&n->tx_ringbuf[c]);
+  if(get_index != -1) {
+    return n->tx_array[c][get_index];
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+#if TSCH_QUEUE_WITH_NBR_HASH
+static uint32_t
+addr_hash(const linkaddr_t *addr)
+{
+  return hash_index_hash(0, addr, LINKADDR_SIZE);
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+nbr_hash(unsigned index)
+{
+  return addr_hash(&NBR_FROM_INDEX(index)->addr);
+}
+/*---------------------------------------------------------------------------*/
+static int
+nbr_match(unsigned index, const void *addr)
+{
+  return linkaddr_cmp(addr, &NBR_FROM_INDEX(index)->addr);
+}
+#endif /* TSCH_QUEUE_WITH_NBR_HASH */
+/*---------------------------------------------------------------------------*/
+#if TSCH_QUEUE_WITH_READY_SET
+/* Mark a neighbor as possibly ready. Called both from the slot operation
+ * and from processes, hence the critical section. */
+static void
+ready_set_add(struct tsch_neighbor *n)
+{
+  int_master_status_t status;
+  unsigned i = NBR_INDEX(n);
+
+  status = critical_enter();
+  ready_set[i / 32] |= (uint32_t)1 << (i % 32);
+  critical_exit(status);
+}
+/*---------------------------------------------------------------------------*/
+static void
+ready_set_remove(struct tsch_neighbor *n)
+{
+  int_master_status_t status;
+  unsigned i = NBR_INDEX(n);
+
+  status = critical_enter();
+  ready_set[i / 32] &= ~((uint32_t)1 << (i % 32));
+  critical_exit(status);
+}
+/*---------------------------------------------------------------------------*/
+/* Mark a neighbor as possibly ready if it has packets and may send them
+ * over the shared links that are not to a specific neighbor */
+static void
+ready_set_update(struct tsch_neighbor *n)
+{
+  if(!n->is_broadcast && n->tx_links_count == 0 && n->backoff_window == 0
+     && !nbr_queue_empty(n)) {
+    ready_set_add(n);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the head packet of a ready neighbor for a shared link, and clears
+ * the bits of the neighbors found to have nothing to send or to have tx
+ * links, which are served by the queue of their link's address instead */
+static struct tsch_packet *
+ready_set_get_packet(struct tsch_neighbor **n, struct tsch_link *link)
+{
+  unsigned w;
+
+  for(w = 0; w < READY_SET_WORDS; w++) {
+    uint32_t bits = ready_set[w];
+    while(bits != 0) {
+      unsigned b = bitmap_first_set(bits);
+      struct tsch_neighbor *curr_nbr = NBR_FROM_INDEX(w * 32 + b);
+      bits &= bits - 1;
+      if(curr_nbr->tx_links_count > 0
+         || nbr_queue_empty(curr_nbr)
+         || !tsch_queue_backoff_expired(curr_nbr)) {
+        ready_set_remove(curr_nbr);
+      } else {
+        struct tsch_packet *p = tsch_queue_get_packet_for_nbr(curr_nbr, link);
+        if(p != NULL) {
+          if(n != NULL) {
+            *n = curr_nbr;
+          }
+          return p;
+        }
+      }
+    }
+  }
+  return NULL;
+}
+#endif /* TSCH_QUEUE_WITH_READY_SET */
+
+#if TSCH_WITH_LOCK_FREE
+static void tsch_queue_flush_nbr_queue(struct tsch_neighbor *n);
+/*---------------------------------------------------------------------------*/
+/* Free the removed neighbors once the slot operation that was ongoing
+ * when they were removed has ended */
+void
+tsch_queue_free_removed_neighbors(void)
+{
+  struct tsch_neighbor *n;
+
+  if(list_head(removed_neighbor_list) == NULL
+     || !tsch_slot_operation_ended(removed_neighbor_epoch)) {
+    return;
+  }
+  while((n = list_pop(removed_neighbor_list)) != NULL) {
+    /* Flush queue */
+    tsch_queue_flush_nbr_queue(n);
+    /* Free neighbor */
+    memb_free(&neighbor_memb, n);
+  }
+}
+#endif /* TSCH_WITH_LOCK_FREE */
 /*---------------------------------------------------------------------------*/
 /* Add a TSCH neighbor */
 struct tsch_neighbor *
@@ -83,21 +266,33 @@ tsch_queue_add_nbr(const linkaddr_t *addr)
   /* If we have an entry for this neighbor already, we simply update it */
   n = tsch_queue_get_nbr(addr);
   if(n == NULL) {
-    if(tsch_get_lock()) {
+    if(TSCH_EDIT_LOCK()) {
       /* Allocate a neighbor */
       n = memb_alloc(&neighbor_memb);
+#if TSCH_WITH_LOCK_FREE
+      if(n == NULL && list_head(removed_neighbor_list) != NULL) {
+        tsch_queue_free_removed_neighbors();
+        n = memb_alloc(&neighbor_memb);
+      }
+#endif /* TSCH_WITH_LOCK_FREE */
       if(n != NULL) {
+        int c;
         /* Initialize neighbor entry */
         memset(n, 0, sizeof(struct tsch_neighbor));
-        ringbufindex_init(&n->tx_ringbuf, TSCH_QUEUE_NUM_PER_NEIGHBOR);
+        for(c = 0; c < TSCH_QUEUE_NUM_CLASSES; c++) {
+          ringbufindex_init(&n->tx_ringbuf[c], TSCH_QUEUE_NUM_PER_NEIGHBOR);
+        }
         linkaddr_copy(&n->addr, addr);
         n->is_broadcast = linkaddr_cmp(addr, &tsch_eb_address)
           || linkaddr_cmp(addr, &tsch_broadcast_address);
         tsch_queue_backoff_reset(n);
-        /* Add neighbor to the list */
+        /* Add neighbor to the list, now that it is initialized */
         list_add(neighbor_list, n);
+#if TSCH_QUEUE_WITH_NBR_HASH
+        hash_index_insert(&nbr_index, NBR_INDEX(n));
+#endif /* TSCH_QUEUE_WITH_NBR_HASH */
       }
-      tsch_release_lock();
+      TSCH_EDIT_RELEASE();
     }
   }
   return n;
@@ -108,6 +303,12 @@ struct tsch_neighbor *
 tsch_queue_get_nbr(const linkaddr_t *addr)
 {
   if(!tsch_is_locked()) {
+#if TSCH_QUEUE_WITH_NBR_HASH
+    int index = hash_index_find(&nbr_index, addr_hash(addr), addr);
+    if(index != -1) {
+      return NBR_FROM_INDEX(index);
+    }
+#else /* TSCH_QUEUE_WITH_NBR_HASH */
     struct tsch_neighbor *n = list_head(neighbor_list);
     while(n != NULL) {
       if(linkaddr_cmp(&n->addr, addr)) {
@@ -115,6 +316,7 @@ tsch_queue_get_nbr(const linkaddr_t *addr)
       }
       n = list_item_next(n);
     }
+#endif /* TSCH_QUEUE_WITH_NBR_HASH */
   }
   return NULL;
 }
@@ -209,12 +411,26 @@ static void
 tsch_queue_remove_nbr(struct tsch_neighbor *n)
 {
   if(n != NULL) {
-    if(tsch_get_lock()) {
+    if(TSCH_EDIT_LOCK()) {
 
       /* Remove neighbor from list */
       list_remove(neighbor_list, n);
+#if TSCH_QUEUE_WITH_NBR_HASH
+      hash_index_remove(&nbr_index, NBR_INDEX(n));
+#endif /* TSCH_QUEUE_WITH_NBR_HASH */
+#if TSCH_QUEUE_WITH_READY_SET
+      ready_set_remove(n);
+#endif /* TSCH_QUEUE_WITH_READY_SET */
 
-      tsch_release_lock();
+      TSCH_EDIT_RELEASE();
+
+#if TSCH_WITH_LOCK_FREE
+      if(!tsch_slot_operation_release(NULL, &removed_neighbor_epoch)) {
+        /* The slot operation may still be using the neighbor */
+        list_add(removed_neighbor_list, n);
+        return;
+      }
+#endif /* TSCH_WITH_LOCK_FREE */
 
       /* Flush queue */
       tsch_queue_flush_nbr_queue(n);
@@ -233,10 +449,14 @@ tsch_queue_add_packet(const linkaddr_t *addr, uint8_t max_transmissions,
   struct tsch_neighbor *n = NULL;
   int16_t put_index = -1;
   struct tsch_packet *p = NULL;
+  int c = 0;
   if(!tsch_is_locked()) {
     n = tsch_queue_add_nbr(addr);
     if(n != NULL) {
-      put_index = ringbufindex_peek_put(&n->tx_ringbuf);
+#if TSCH_QUEUE_NUM_CLASSES > 1
+      c = MIN(packetbuf_attr(PACKETBUF_ATTR_TSCH_TRAFFIC_CLASS), TSCH_QUEUE_NUM_CLASSES - 1);
+#endif /* TSCH_QUEUE_NUM_CLASSES > 1 */
+      put_index = ringbufindex_peek_put(&n->tx_ringbuf[c]);
       if(put_index != -1) {
         p = memb_alloc(&packet_memb);
         if(p != NULL) {
@@ -251,11 +471,21 @@ tsch_queue_add_packet(const linkaddr_t *addr, uint8_t max_transmissions,
             p->ret = MAC_TX_DEFERRED;
             p->transmissions = 0;
             p->max_transmissions = max_transmissions;
+#if TSCH_QUEUE_NUM_CLASSES > 1
+            p->tx_class = c;
+#endif /* TSCH_QUEUE_NUM_CLASSES > 1 */
+#if TSCH_QUEUE_WITH_DEADLINE
+            p->has_deadline = packetbuf_attr(PACKETBUF_ATTR_TSCH_DEADLINE) != 0;
+            p->deadline = clock_time() + packetbuf_attr(PACKETBUF_ATTR_TSCH_DEADLINE);
+#endif /* TSCH_QUEUE_WITH_DEADLINE */
             /* Add to ringbuf (actual add committed through atomic operation) */
-            n->tx_array[put_index] = p;
-            ringbufindex_put(&n->tx_ringbuf);
-            LOG_DBG("packet is added put_index %u, packet %p\n",
-                   put_index, p);
+            n->tx_array[c][put_index] = p;
+            ringbufindex_put(&n->tx_ringbuf[c]);
+#if TSCH_QUEUE_WITH_READY_SET
+            ready_set_update(n);
+#endif /* TSCH_QUEUE_WITH_READY_SET */
+            LOG_DBG("packet is added class %u put_index %u, packet %p\n",
+                   c, put_index, p);
             return p;
           } else {
             memb_free(&packet_memb, p);
@@ -283,24 +513,28 @@ tsch_queue_packet_count(const linkaddr_t *addr)
   if(!tsch_is_locked()) {
     n = tsch_queue_add_nbr(addr);
     if(n != NULL) {
-      return ringbufindex_elements(&n->tx_ringbuf);
+      int c;
+      int count = 0;
+      for(c = 0; c < TSCH_QUEUE_NUM_CLASSES; c++) {
+        count += ringbufindex_elements(&n->tx_ringbuf[c]);
+      }
+      return count;
     }
   }
   return -1;
 }
 /*---------------------------------------------------------------------------*/
-/* Remove first packet from a neighbor queue */
+/* Remove first packet from a neighbor queue, starting with the highest class */
 struct tsch_packet *
 tsch_queue_remove_packet_from_queue(struct tsch_neighbor *n)
 {
   if(!tsch_is_locked()) {
     if(n != NULL) {
-      /* Get and remove packet from ringbuf (remove committed through an atomic operation */
-      int16_t get_index = ringbufindex_get(&n->tx_ringbuf);
-      if(get_index != -1) {
-        return n->tx_array[get_index];
-      } else {
-        return NULL;
+      int c;
+      for(c = TSCH_QUEUE_NUM_CLASSES - 1; c >= 0; c--) {
+        if(!ringbufindex_empty(&n->tx_ringbuf[c])) {
+          return remove_packet_from_class(n, c);
+        }
       }
     }
   }
@@ -328,7 +562,7 @@ tsch_queue_packet_sent(struct tsch_neighbor *n, struct tsch_packet *p,
 
   if(mac_tx_status == MAC_TX_OK) {
     /* Successful transmission */
-    tsch_queue_remove_packet_from_queue(n);
+    remove_packet_from_class(n, PACKET_CLASS(p));
     in_queue = 0;
 
     /* Update CSMA state in the unicast case */
@@ -343,7 +577,7 @@ tsch_queue_packet_sent(struct tsch_neighbor *n, struct tsch_packet *p,
     /* Failed transmission */
     if(p->transmissions >= p->max_transmissions) {
       /* Drop packet */
-      tsch_queue_remove_packet_from_queue(n);
+      remove_packet_from_class(n, PACKET_CLASS(p));
       in_queue = 0;
     }
     /* Update CSMA state in the unicast case */
@@ -385,6 +619,9 @@ tsch_queue_free_unused_neighbors(void)
   /* Deallocate unneeded neighbors */
   if(!tsch_is_locked()) {
     struct tsch_neighbor *n = list_head(neighbor_list);
+#if TSCH_WITH_LOCK_FREE
+    tsch_queue_free_removed_neighbors();
+#endif /* TSCH_WITH_LOCK_FREE */
     while(n != NULL) {
       struct tsch_neighbor *next_n = list_item_next(n);
       /* Queue is empty, no tx link to this neighbor: deallocate.
@@ -402,32 +639,46 @@ tsch_queue_free_unused_neighbors(void)
 int
 tsch_queue_is_empty(const struct tsch_neighbor *n)
 {
-  return !tsch_is_locked() && n != NULL && ringbufindex_empty(&n->tx_ringbuf);
+  return !tsch_is_locked() && n != NULL && nbr_queue_empty(n);
 }
 /*---------------------------------------------------------------------------*/
-/* Returns the first packet from a neighbor queue */
+/* Returns the first packet from a neighbor queue. With traffic classes, this
+ * is the head of the highest class, or with TSCH_QUEUE_EDF the class head
+ * with the earliest deadline */
 struct tsch_packet *
 tsch_queue_get_packet_for_nbr(const struct tsch_neighbor *n, struct tsch_link *link)
 {
   if(!tsch_is_locked()) {
     int is_shared_link = link != NULL && link->link_options & LINK_OPTION_SHARED;
-    if(n != NULL) {
-      int16_t get_index = ringbufindex_peek_get(&n->tx_ringbuf);
-      if(get_index != -1 &&
-          !(is_shared_link && !tsch_queue_backoff_expired(n))) {    /* If this is a shared link,
-                                                                    make sure the backoff has expired */
+    if(n != NULL && !(is_shared_link && !tsch_queue_backoff_expired(n))) {
+      /* If this is a shared link, make sure the backoff has expired */
+      struct tsch_packet *best = NULL;
+      int c;
+      for(c = TSCH_QUEUE_NUM_CLASSES - 1; c >= 0; c--) {
+        int16_t get_index = ringbufindex_peek_get(&n->tx_ringbuf[c]);
+        if(get_index != -1) {
+          struct tsch_packet *p = n->tx_array[c][get_index];
 #if TSCH_WITH_LINK_SELECTOR
-        int packet_attr_slotframe = queuebuf_attr(n->tx_array[get_index]->qb, PACKETBUF_ATTR_TSCH_SLOTFRAME);
-        int packet_attr_timeslot = queuebuf_attr(n->tx_array[get_index]->qb, PACKETBUF_ATTR_TSCH_TIMESLOT);
-        if(packet_attr_slotframe != 0xffff && packet_attr_slotframe != link->slotframe_handle) {
-          return NULL;
-        }
-        if(packet_attr_timeslot != 0xffff && packet_attr_timeslot != link->timeslot) {
-          return NULL;
-        }
+          int packet_attr_slotframe = queuebuf_attr(p->qb, PACKETBUF_ATTR_TSCH_SLOTFRAME);
+          int packet_attr_timeslot = queuebuf_attr(p->qb, PACKETBUF_ATTR_TSCH_TIMESLOT);
+          if(packet_attr_slotframe != 0xffff && packet_attr_slotframe != link->slotframe_handle) {
+            continue;
+          }
+          if(packet_attr_timeslot != 0xffff && packet_attr_timeslot != link->timeslot) {
+            continue;
+          }
 #endif
-        return n->tx_array[get_index];
+#if TSCH_QUEUE_EDF
+          if(best == NULL || (p->has_deadline && (!best->has_deadline
+             || (clock_time_t)(p->deadline - best->deadline) > (clock_time_t)(~(clock_time_t)0) >> 1))) {
+            best = p;
+          }
+#else /* TSCH_QUEUE_EDF */
+          return p;
+#endif /* TSCH_QUEUE_EDF */
+        }
       }
+      return best;
     }
   }
   return NULL;
@@ -449,8 +700,15 @@ struct tsch_packet *
 tsch_queue_get_unicast_packet_for_any(struct tsch_neighbor **n, struct tsch_link *link)
 {
   if(!tsch_is_locked()) {
-    struct tsch_neighbor *curr_nbr = list_head(neighbor_list);
+    struct tsch_neighbor *curr_nbr;
     struct tsch_packet *p = NULL;
+#if TSCH_QUEUE_WITH_READY_SET
+    if(link != NULL && link->link_options & LINK_OPTION_SHARED) {
+      /* Only neighbors with an expired backoff may use a shared link */
+      return ready_set_get_packet(n, link);
+    }
+#endif /* TSCH_QUEUE_WITH_READY_SET */
+    curr_nbr = list_head(neighbor_list);
     while(curr_nbr != NULL) {
       if(!curr_nbr->is_broadcast && curr_nbr->tx_links_count == 0) {
         /* Only look up for non-broadcast neighbors we do not have a tx link to */
@@ -468,6 +726,40 @@ tsch_queue_get_unicast_packet_for_any(struct tsch_neighbor **n, struct tsch_link
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+#if TSCH_QUEUE_WITH_DEADLINE
+/* Is the deadline of a packet passed? */
+int
+tsch_queue_packet_expired(const struct tsch_packet *p)
+{
+  return p->has_deadline
+    && (clock_time_t)(clock_time() - p->deadline) < (clock_time_t)(~(clock_time_t)0) >> 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Remove an expired packet, returned by tsch_queue_get_packet_for_nbr, from
+ * its neighbor queue */
+struct tsch_packet *
+tsch_queue_remove_expired_packet(struct tsch_neighbor *n, struct tsch_packet *p)
+{
+  if(n != NULL && p != NULL) {
+    int16_t get_index = ringbufindex_peek_get(&n->tx_ringbuf[PACKET_CLASS(p)]);
+    if(get_index != -1 && n->tx_array[PACKET_CLASS(p)][get_index] == p) {
+      remove_packet_from_class(n, PACKET_CLASS(p));
+      p->ret = MAC_TX_ERR;
+      expired_count++;
+      return p;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the number of packets dropped because of their deadline */
+uint32_t
+tsch_queue_expired_packet_count(void)
+{
+  return expired_count;
+}
+#endif /* TSCH_QUEUE_WITH_DEADLINE */
+/*---------------------------------------------------------------------------*/
 /* May the neighbor transmit over a shared link? */
 int
 tsch_queue_backoff_expired(const struct tsch_neighbor *n)
@@ -481,6 +773,9 @@ tsch_queue_backoff_reset(struct tsch_neighbor *n)
 {
   n->backoff_window = 0;
   n->backoff_exponent = TSCH_MAC_MIN_BE;
+#if TSCH_QUEUE_WITH_READY_SET
+  ready_set_update(n);
+#endif /* TSCH_QUEUE_WITH_READY_SET */
 }
 /*---------------------------------------------------------------------------*/
 /* Increment backoff exponent, pick a new window */
@@ -510,19 +805,42 @@ tsch_queue_update_all_backoff_windows(const linkaddr_t *dest_addr)
          && ((n->tx_links_count == 0 && is_broadcast)
              || (n->tx_links_count > 0 && linkaddr_cmp(dest_addr, &n->addr)))) {
         n->backoff_window--;
+#if TSCH_QUEUE_WITH_READY_SET
+        ready_set_update(n);
+#endif /* TSCH_QUEUE_WITH_READY_SET */
       }
       n = list_item_next(n);
     }
   }
 }
 /*---------------------------------------------------------------------------*/
+/* Update a neighbor queue after its number of tx links has changed */
+void
+tsch_queue_tx_links_updated(struct tsch_neighbor *n)
+{
+#if TSCH_QUEUE_WITH_READY_SET
+  /* A neighbor left without tx links may now use any shared link. The
+   * bit of a neighbor that got tx links is cleared on the next lookup. */
+  ready_set_update(n);
+#endif /* TSCH_QUEUE_WITH_READY_SET */
+}
+/*---------------------------------------------------------------------------*/
 /* Initialize TSCH queue module */
 void
 tsch_queue_init(void)
 {
   list_init(neighbor_list);
+#if TSCH_WITH_LOCK_FREE
+  list_init(removed_neighbor_list);
+#endif /* TSCH_WITH_LOCK_FREE */
   memb_init(&neighbor_memb);
   memb_init(&packet_memb);
+#if TSCH_QUEUE_WITH_NBR_HASH
+  hash_index_init(&nbr_index);
+#endif /* TSCH_QUEUE_WITH_NBR_HASH */
+#if TSCH_QUEUE_WITH_READY_SET
+  memset(ready_set, 0, sizeof(ready_set));
+#endif /* TSCH_QUEUE_WITH_READY_SET */
   /* Add virtual EB and the broadcast neighbors */
   n_eb = tsch_queue_add_nbr(&tsch_eb_address);
   n_broadcast = tsch_queue_add_nbr(&tsch_broadcast_address);
@@ -118,6 +118,27 @@ void tsch_queue_free_packet(struct tsch_packet *p);
  * \return 1 if the packet remains in queue after the call, 0 if it was removed
  */
 int tsch_queue_packet_sent(struct tsch_neighbor *n, struct tsch_packet *p, struct tsch_link *link, uint8_t mac_tx_status);
+#if TSCH_QUEUE_WITH_DEADLINE
+/**
+ * \brief Is the deadline of a packet passed?
+ * \param p The packet
+ * \return 1 if the packet has a deadline and it is passed, 0 otherwise
+ */
+int tsch_queue_packet_expired(const struct tsch_packet *p);
+/**
+ * \brief Remove an expired packet from its neighbor queue and count it as dropped.
+ * The caller is in charge of calling its packet_sent callback and freeing it.
+ * \param n The neighbor queue
+ * \param p The packet, as returned by tsch_queue_get_packet_for_nbr
+ * \return The packet if it was removed, NULL otherwise
+ */
+struct tsch_packet *tsch_queue_remove_expired_packet(struct tsch_neighbor *n, struct tsch_packet *p);
+/**
+ * \brief Returns the number of packets dropped because their deadline was passed
+ * \return The number of expired packets
+ */
+uint32_t tsch_queue_expired_packet_count(void);
+#endif /* TSCH_QUEUE_WITH_DEADLINE */
 /**
  * \brief Reset neighbor queues module
  */
@@ -126,6 +147,13 @@ void tsch_queue_reset(void);
  * \brief Deallocate all neighbors with empty queue
  */
 void tsch_queue_free_unused_neighbors(void);
+#if TSCH_WITH_LOCK_FREE
+/**
+ * \brief Free the neighbors removed during a slot operation, if that slot
+ * operation has ended. Never waits for it.
+ */
+void tsch_queue_free_removed_neighbors(void);
+#endif /* TSCH_WITH_LOCK_FREE */
 /**
  * \brief Is the neighbor queue empty?
  * \param n The neighbor queue
@@ -174,6 +202,11 @@ void tsch_queue_backoff_inc(struct tsch_neighbor *n);
  * \param dest_addr The target address, &tsch_broadcast_address for broadcast
  */
 void tsch_queue_update_all_backoff_windows(const linkaddr_t *dest_addr);
+/**
+ * \brief Update a neighbor queue after its number of tx links has changed
+ * \param n The neighbor queue
+ */
+void tsch_queue_tx_links_updated(struct tsch_neighbor *n);
 /**
  * \brief Initialize TSCH queue module
  */
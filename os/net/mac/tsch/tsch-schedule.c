@@ -51,6 +51,7 @@
 #include "net/queuebuf.h"
 #include "net/mac/tsch/tsch.h"
 #include "net/mac/framer/frame802154.h"
+#include "sys/critical.h"
 #include "sys/process.h"
 #include "sys/rtimer.h"
 #include <string.h>
@@ -70,6 +71,119 @@ MEMB(slotframe_memb, struct tsch_slotframe, TSCH_SCHEDULE_MAX_SLOTFRAMES);
 /* List of slotframes (each slotframe holds its own list of links) */
 LIST(slotframe_list);
 
+#if TSCH_WITH_LOCK_FREE
+/* Links and slotframes removed while the slot operation may still use
+ * them, freed once it has ended */
+LIST(removed_link_list);
+LIST(removed_slotframe_list);
+static uint16_t removed_epoch;
+#endif /* TSCH_WITH_LOCK_FREE */
+
+#if TSCH_SCHEDULE_WITH_LINK_INDEX
+/* All links, sorted by slotframe handle then timeslot */
+static struct tsch_link *link_index[TSCH_SCHEDULE_MAX_LINKS];
+static uint16_t link_index_count;
+
+#define LINK_INDEX_KEY(handle, timeslot) (((uint32_t)(handle) << 16) | (timeslot))
+/*---------------------------------------------------------------------------*/
+/* Returns the position of the first link with a key not below 'key' */
+static uint16_t
+link_index_lower_bound(uint32_t key)
+{
+  uint16_t lo = 0;
+  uint16_t hi = link_index_count;
+  while(lo < hi) {
+    uint16_t mid = (lo + hi) / 2;
+    if(LINK_INDEX_KEY(link_index[mid]->slotframe_handle, link_index[mid]->timeslot) < key) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+/*---------------------------------------------------------------------------*/
+static void
+link_index_add(struct tsch_link *l)
+{
+  uint16_t pos;
+#if TSCH_WITH_LOCK_FREE
+  /* The slot operation must not see the index half-shifted */
+  int_master_status_t status = critical_enter();
+#endif /* TSCH_WITH_LOCK_FREE */
+  pos = link_index_lower_bound(LINK_INDEX_KEY(l->slotframe_handle, l->timeslot) + 1);
+  memmove(&link_index[pos + 1], &link_index[pos],
+          (link_index_count - pos) * sizeof(link_index[0]));
+  link_index[pos] = l;
+  link_index_count++;
+#if TSCH_WITH_LOCK_FREE
+  critical_exit(status);
+#endif /* TSCH_WITH_LOCK_FREE */
+}
+/*---------------------------------------------------------------------------*/
+static void
+link_index_remove(struct tsch_link *l)
+{
+  uint16_t pos;
+#if TSCH_WITH_LOCK_FREE
+  int_master_status_t status = critical_enter();
+#endif /* TSCH_WITH_LOCK_FREE */
+  pos = link_index_lower_bound(LINK_INDEX_KEY(l->slotframe_handle, l->timeslot));
+  while(pos < link_index_count && link_index[pos] != l) {
+    pos++;
+  }
+  if(pos < link_index_count) {
+    link_index_count--;
+    memmove(&link_index[pos], &link_index[pos + 1],
+            (link_index_count - pos) * sizeof(link_index[0]));
+  }
+#if TSCH_WITH_LOCK_FREE
+  critical_exit(status);
+#endif /* TSCH_WITH_LOCK_FREE */
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the first link of a slotframe after a timeslot, wrapping
+ * around to the start of the slotframe, or NULL if it has no links */
+static struct tsch_link *
+link_index_next(uint16_t handle, uint16_t timeslot)
+{
+  uint16_t pos = link_index_lower_bound(LINK_INDEX_KEY(handle, timeslot) + 1);
+  if(pos == link_index_count || link_index[pos]->slotframe_handle != handle) {
+    pos = link_index_lower_bound(LINK_INDEX_KEY(handle, 0));
+    if(pos == link_index_count || link_index[pos]->slotframe_handle != handle) {
+      return NULL;
+    }
+  }
+  return link_index[pos];
+}
+#endif /* TSCH_SCHEDULE_WITH_LINK_INDEX */
+
+#if TSCH_WITH_LOCK_FREE
+/*---------------------------------------------------------------------------*/
+/* Free the removed links and slotframes once the slot operation that
+ * was ongoing when they were removed has ended */
+void
+tsch_schedule_free_removed(void)
+{
+  struct tsch_link *l;
+  struct tsch_slotframe *sf;
+
+  if(list_head(removed_link_list) == NULL
+     && list_head(removed_slotframe_list) == NULL) {
+    return;
+  }
+  if(!tsch_slot_operation_ended(removed_epoch)) {
+    return;
+  }
+  while((l = list_pop(removed_link_list)) != NULL) {
+    memb_free(&link_memb, l);
+  }
+  while((sf = list_pop(removed_slotframe_list)) != NULL) {
+    memb_free(&slotframe_memb, sf);
+  }
+}
+#endif /* TSCH_WITH_LOCK_FREE */
+/*---------------------------------------------------------------------------*/
 /* Adds and returns a slotframe (NULL if failure) */
 struct tsch_slotframe *
 tsch_schedule_add_slotframe(uint16_t handle, uint16_t size)
@@ -83,8 +197,14 @@ tsch_schedule_add_slotframe(uint16_t handle, uint16_t size)
     return NULL;
   }
 
-  if(tsch_get_lock()) {
+  if(TSCH_EDIT_LOCK()) {
     struct tsch_slotframe *sf = memb_alloc(&slotframe_memb);
+#if TSCH_WITH_LOCK_FREE
+    if(sf == NULL && list_head(removed_slotframe_list) != NULL) {
+      tsch_schedule_free_removed();
+      sf = memb_alloc(&slotframe_memb);
+    }
+#endif /* TSCH_WITH_LOCK_FREE */
     if(sf != NULL) {
       /* Initialize the slotframe */
       sf->handle = handle;
@@ -95,7 +215,7 @@ tsch_schedule_add_slotframe(uint16_t handle, uint16_t size)
     }
     LOG_INFO("add_slotframe %u %u\n",
            handle, size);
-    tsch_release_lock();
+    TSCH_EDIT_RELEASE();
     return sf;
   }
   return NULL;
@@ -126,11 +246,17 @@ tsch_schedule_remove_slotframe(struct tsch_slotframe *slotframe)
     }
 
     /* Now that the slotframe has no links, remove it. */
-    if(tsch_get_lock()) {
+    if(TSCH_EDIT_LOCK()) {
       LOG_INFO("remove slotframe %u %u\n", slotframe->handle, slotframe->size.val);
-      memb_free(&slotframe_memb, slotframe);
       list_remove(slotframe_list, slotframe);
-      tsch_release_lock();
+      TSCH_EDIT_RELEASE();
+#if TSCH_WITH_LOCK_FREE
+      if(!tsch_slot_operation_release(NULL, &removed_epoch)) {
+        list_add(removed_slotframe_list, slotframe);
+        return 1;
+      }
+#endif /* TSCH_WITH_LOCK_FREE */
+      memb_free(&slotframe_memb, slotframe);
       return 1;
     }
   }
@@ -235,18 +361,22 @@ tsch_schedule_add_link(struct tsch_slotframe *slotframe,
     /* Start with removing the link currently installed at this timeslot (needed
      * to keep neighbor state in sync with link options etc.) */
     tsch_schedule_remove_link_by_timeslot(slotframe, timeslot);
-    if(!tsch_get_lock()) {
+    if(!TSCH_EDIT_LOCK()) {
       LOG_ERR("! add_link memb_alloc couldn't take lock\n");
     } else {
       l = memb_alloc(&link_memb);
+#if TSCH_WITH_LOCK_FREE
+      if(l == NULL && list_head(removed_link_list) != NULL) {
+        tsch_schedule_free_removed();
+        l = memb_alloc(&link_memb);
+      }
+#endif /* TSCH_WITH_LOCK_FREE */
       if(l == NULL) {
         LOG_ERR("! add_link memb_alloc failed\n");
-        tsch_release_lock();
+        TSCH_EDIT_RELEASE();
       } else {
         static int current_link_handle = 0;
         struct tsch_neighbor *n;
-        /* Add the link to the slotframe */
-        list_add(slotframe->links_list, l);
         /* Initialize link */
         l->handle = current_link_handle++;
         l->link_options = link_options;
@@ -259,6 +389,11 @@ tsch_schedule_add_link(struct tsch_slotframe *slotframe,
           address = &linkaddr_null;
         }
         linkaddr_copy(&l->addr, address);
+        /* Add the link to the slotframe, now that it is initialized */
+        list_add(slotframe->links_list, l);
+#if TSCH_SCHEDULE_WITH_LINK_INDEX
+        link_index_add(l);
+#endif /* TSCH_SCHEDULE_WITH_LINK_INDEX */
 
         LOG_INFO("add_link sf=%u opt=%s type=%s ts=%u ch=%u addr=",
                  slotframe->handle,
@@ -267,7 +402,7 @@ tsch_schedule_add_link(struct tsch_slotframe *slotframe,
         LOG_INFO_LLADDR(address);
         LOG_INFO_("\n");
         /* Release the lock before we update the neighbor (will take the lock) */
-        tsch_release_lock();
+        TSCH_EDIT_RELEASE();
 
         if(l->link_options & LINK_OPTION_TX) {
           n = tsch_queue_add_nbr(&l->addr);
@@ -277,6 +412,7 @@ tsch_schedule_add_link(struct tsch_slotframe *slotframe,
             if(!(l->link_options & LINK_OPTION_SHARED)) {
               n->dedicated_tx_links_count++;
             }
+            tsch_queue_tx_links_updated(n);
           }
         }
       }
@@ -290,7 +426,7 @@ int
 tsch_schedule_remove_link(struct tsch_slotframe *slotframe, struct tsch_link *l)
 {
   if(slotframe != NULL && l != NULL && l->slotframe_handle == slotframe->handle) {
-    if(tsch_get_lock()) {
+    if(TSCH_EDIT_LOCK()) {
       uint8_t link_options;
       linkaddr_t addr;
 
@@ -299,11 +435,13 @@ tsch_schedule_remove_link(struct tsch_slotframe *slotframe, struct tsch_link *l)
       link_options = l->link_options;
       linkaddr_copy(&addr, &l->addr);
 
+#if !TSCH_WITH_LOCK_FREE
       /* The link to be removed is scheduled as next, set it to NULL
        * to abort the next link operation */
       if(l == current_link) {
         current_link = NULL;
       }
+#endif /* !TSCH_WITH_LOCK_FREE */
       LOG_INFO("remove_link sf=%u opt=%s type=%s ts=%u ch=%u addr=",
                slotframe->handle,
                print_link_options(l->link_options),
@@ -312,10 +450,23 @@ tsch_schedule_remove_link(struct tsch_slotframe *slotframe, struct tsch_link *l)
       LOG_INFO_("\n");
 
       list_remove(slotframe->links_list, l);
+#if TSCH_SCHEDULE_WITH_LINK_INDEX
+      link_index_remove(l);
+#endif /* TSCH_SCHEDULE_WITH_LINK_INDEX */
+#if TSCH_WITH_LOCK_FREE
+      /* Free the link now unless the slot operation may still be using it
+       * (this also aborts the next link operation if it is scheduled next) */
+      if(tsch_slot_operation_release(l, &removed_epoch)) {
+        memb_free(&link_memb, l);
+      } else {
+        list_add(removed_link_list, l);
+      }
+#else /* TSCH_WITH_LOCK_FREE */
       memb_free(&link_memb, l);
+#endif /* TSCH_WITH_LOCK_FREE */
 
       /* Release the lock before we update the neighbor (will take the lock) */
-      tsch_release_lock();
+      TSCH_EDIT_RELEASE();
 
       /* This was a tx link to this neighbor, update counters */
       if(link_options & LINK_OPTION_TX) {
@@ -325,6 +476,7 @@ tsch_schedule_remove_link(struct tsch_slotframe *slotframe, struct tsch_link *l)
           if(!(link_options & LINK_OPTION_SHARED)) {
             n->dedicated_tx_links_count--;
           }
+          tsch_queue_tx_links_updated(n);
         }
       }
 
@@ -350,6 +502,15 @@ tsch_schedule_get_link_by_timeslot(struct tsch_slotframe *slotframe, uint16_t ti
 {
   if(!tsch_is_locked()) {
     if(slotframe != NULL) {
+#if TSCH_SCHEDULE_WITH_LINK_INDEX
+      uint16_t pos = link_index_lower_bound(LINK_INDEX_KEY(slotframe->handle, timeslot));
+      if(pos < link_index_count
+         && link_index[pos]->slotframe_handle == slotframe->handle
+         && link_index[pos]->timeslot == timeslot) {
+        return link_index[pos];
+      }
+      return NULL;
+#else /* TSCH_SCHEDULE_WITH_LINK_INDEX */
       struct tsch_link *l = list_head(slotframe->links_list);
       /* Loop over all items. Assume there is max one link per timeslot */
       while(l != NULL) {
@@ -359,11 +520,58 @@ tsch_schedule_get_link_by_timeslot(struct tsch_slotframe *slotframe, uint16_t ti
         l = list_item_next(l);
       }
       return l;
+#endif /* TSCH_SCHEDULE_WITH_LINK_INDEX */
     }
   }
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+/* Compares a link with the current best link for the next active slot,
+ * updating the best and backup links */
+static void
+select_link(struct tsch_link *l, uint16_t time_to_timeslot,
+            struct tsch_link **curr_best, uint16_t *time_to_curr_best,
+            struct tsch_link **curr_backup)
+{
+  if(*curr_best == NULL || time_to_timeslot < *time_to_curr_best) {
+    *time_to_curr_best = time_to_timeslot;
+    *curr_best = l;
+    *curr_backup = NULL;
+  } else if(time_to_timeslot == *time_to_curr_best) {
+    struct tsch_link *new_best = NULL;
+    /* Two links are overlapping, we need to select one of them.
+     * By standard: prioritize Tx links first, second by lowest handle */
+    if(((*curr_best)->link_options & LINK_OPTION_TX) == (l->link_options & LINK_OPTION_TX)) {
+      /* Both or neither links have Tx, select the one with lowest handle */
+      if(l->slotframe_handle < (*curr_best)->slotframe_handle) {
+        new_best = l;
+      }
+    } else {
+      /* Select the link that has the Tx option */
+      if(l->link_options & LINK_OPTION_TX) {
+        new_best = l;
+      }
+    }
+
+    /* Maintain backup_link */
+    if(*curr_backup == NULL) {
+      /* Check if 'l' best can be used as backup */
+      if(new_best != l && (l->link_options & LINK_OPTION_RX)) { /* Does 'l' have Rx flag? */
+        *curr_backup = l;
+      }
+      /* Check if curr_best can be used as backup */
+      if(new_best != *curr_best && ((*curr_best)->link_options & LINK_OPTION_RX)) { /* Does curr_best have Rx flag? */
+        *curr_backup = *curr_best;
+      }
+    }
+
+    /* Maintain curr_best */
+    if(new_best != NULL) {
+      *curr_best = new_best;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
 /* Returns the next active link after a given ASN, and a backup link (for the same ASN, with Rx flag) */
 struct tsch_link *
 tsch_schedule_get_next_active_link(struct tsch_asn_t *asn, uint16_t *time_offset,
@@ -381,51 +589,20 @@ tsch_schedule_get_next_active_link(struct tsch_asn_t *asn, uint16_t *time_offset
     while(sf != NULL) {
       /* Get timeslot from ASN, given the slotframe length */
       uint16_t timeslot = TSCH_ASN_MOD(*asn, sf->size);
+#if TSCH_SCHEDULE_WITH_LINK_INDEX
+      /* There is at most one link per timeslot, so the first link after
+       * the current timeslot is the earliest one of the slotframe */
+      struct tsch_link *l = link_index_next(sf->handle, timeslot);
+      if(l != NULL) {
+#else /* TSCH_SCHEDULE_WITH_LINK_INDEX */
       struct tsch_link *l = list_head(sf->links_list);
-      while(l != NULL) {
+      for(; l != NULL; l = list_item_next(l)) {
+#endif /* TSCH_SCHEDULE_WITH_LINK_INDEX */
         uint16_t time_to_timeslot =
           l->timeslot > timeslot ?
           l->timeslot - timeslot :
           sf->size.val + l->timeslot - timeslot;
-        if(curr_best == NULL || time_to_timeslot < time_to_curr_best) {
-          time_to_curr_best = time_to_timeslot;
-          curr_best = l;
-          curr_backup = NULL;
-        } else if(time_to_timeslot == time_to_curr_best) {
-          struct tsch_link *new_best = NULL;
-          /* Two links are overlapping, we need to select one of them.
-           * By standard: prioritize Tx links first, second by lowest handle */
-          if((curr_best->link_options & LINK_OPTION_TX) == (l->link_options & LINK_OPTION_TX)) {
-            /* Both or neither links have Tx, select the one with lowest handle */
-            if(l->slotframe_handle < curr_best->slotframe_handle) {
-              new_best = l;
-            }
-          } else {
-            /* Select the link that has the Tx option */
-            if(l->link_options & LINK_OPTION_TX) {
-              new_best = l;
-            }
-          }
-
-          /* Maintain backup_link */
-          if(curr_backup == NULL) {
-            /* Check if 'l' best can be used as backup */
-            if(new_best != l && (l->link_options & LINK_OPTION_RX)) { /* Does 'l' have Rx flag? */
-              curr_backup = l;
-            }
-            /* Check if curr_best can be used as backup */
-            if(new_best != curr_best && (curr_best->link_options & LINK_OPTION_RX)) { /* Does curr_best have Rx flag? */
-              curr_backup = curr_best;
-            }
-          }
-
-          /* Maintain curr_best */
-          if(new_best != NULL) {
-            curr_best = new_best;
-          }
-        }
-
-        l = list_item_next(l);
+        select_link(l, time_to_timeslot, &curr_best, &time_to_curr_best, &curr_backup);
       }
       sf = list_item_next(sf);
     }
@@ -447,6 +624,13 @@ tsch_schedule_init(void)
     memb_init(&link_memb);
     memb_init(&slotframe_memb);
     list_init(slotframe_list);
+#if TSCH_WITH_LOCK_FREE
+    list_init(removed_link_list);
+    list_init(removed_slotframe_list);
+#endif /* TSCH_WITH_LOCK_FREE */
+#if TSCH_SCHEDULE_WITH_LINK_INDEX
+    link_index_count = 0;
+#endif /* TSCH_SCHEDULE_WITH_LINK_INDEX */
     tsch_release_lock();
     return 1;
   } else {
@@ -90,6 +90,14 @@ int tsch_schedule_remove_slotframe(struct tsch_slotframe *slotframe);
  */
 int tsch_schedule_remove_all_slotframes(void);
 
+#if TSCH_WITH_LOCK_FREE
+/**
+ * \brief Frees the links and slotframes removed during a slot operation,
+ * if that slot operation has ended. Never waits for it.
+ */
+void tsch_schedule_free_removed(void);
+#endif /* TSCH_WITH_LOCK_FREE */
+
 /**
  * \brief Adds a link to a slotframe
  * \param slotframe The slotframe that will contain the new link
@@ -152,6 +152,15 @@ static rtimer_clock_t volatile current_slot_start;
 /* Are we currently inside a slot? */
 static volatile int tsch_in_slot_operation = 0;
 
+#if TSCH_WITH_LOCK_FREE
+/* Incremented at the end of every slot operation, telling processes when
+ * the items they removed are no longer in use */
+static volatile uint16_t slot_operation_epoch;
+/* Set when an item was removed during the ongoing slot operation, to
+ * have the pending events process free it once the operation has ended */
+static volatile uint8_t release_pending;
+#endif /* TSCH_WITH_LOCK_FREE */
+
 /* If we are inside a slot, this tells the current channel */
 uint8_t tsch_current_channel;
 
@@ -235,6 +244,46 @@ tsch_release_lock(void)
 {
   tsch_locked = 0;
 }
+#if TSCH_WITH_LOCK_FREE
+/*---------------------------------------------------------------------------*/
+/* Lock-free schedule and neighbor edits. The slot operation only reads the
+ * schedule and neighbor lists, and each edit publishes or unlinks an item
+ * with a single pointer store. Between two slot operations, the only
+ * pointers kept are current_link and backup_link; during a slot operation,
+ * the current link, neighbor and packet are used across interrupts. */
+int
+tsch_slot_operation_release(const struct tsch_link *l, uint16_t *epoch)
+{
+  int released = 1;
+  int_master_status_t status;
+
+  status = critical_enter();
+  if(tsch_in_slot_operation) {
+    /* The slot operation selects the next link at its end, with the item
+     * unlinked already: wait for the end of this one only */
+    *epoch = slot_operation_epoch;
+    release_pending = 1;
+    released = 0;
+  } else if(l != NULL) {
+    /* The link to be removed is scheduled as next, set it to NULL
+     * to abort the next link operation */
+    if(l == current_link) {
+      current_link = NULL;
+    }
+    if(l == backup_link) {
+      backup_link = NULL;
+    }
+  }
+  critical_exit(status);
+  return released;
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_slot_operation_ended(uint16_t epoch)
+{
+  return slot_operation_epoch != epoch;
+}
+#endif /* TSCH_WITH_LOCK_FREE */
 
 /*---------------------------------------------------------------------------*/
 /* Channel hopping utility functions */
@@ -285,6 +334,7 @@ tsch_schedule_slot_operation(struct rtimer *tm, rtimer_clock_t ref_time, rtimer_
   int missed = check_timer_miss(ref_time, offset - RTIMER_GUARD, now);
 
   if(missed) {
+    tsch_profile_timer_miss();
     TSCH_LOG_ADD(tsch_log_message,
                 snprintf(log->message, sizeof(log->message),
                     "!dl-miss %s %d %d",
@@ -313,9 +363,9 @@ tsch_schedule_slot_operation(struct rtimer *tm, rtimer_clock_t ref_time, rtimer_
     } \
   } while(0);
 /*---------------------------------------------------------------------------*/
-/* Get EB, broadcast or unicast packet to be sent, and target neighbor. */
+/* Select EB, broadcast or unicast packet to be sent, and target neighbor. */
 static struct tsch_packet *
-get_packet_and_neighbor_for_link(struct tsch_link *link, struct tsch_neighbor **target_neighbor)
+select_packet_and_neighbor_for_link(struct tsch_link *link, struct tsch_neighbor **target_neighbor)
 {
   struct tsch_packet *p = NULL;
   struct tsch_neighbor *n = NULL;
@@ -349,6 +399,38 @@ get_packet_and_neighbor_for_link(struct tsch_link *link, struct tsch_neighbor **
   return p;
 }
 /*---------------------------------------------------------------------------*/
+/* Get EB, broadcast or unicast packet to be sent, and target neighbor.
+ * Packets found to be past their deadline are dropped on the way. */
+static struct tsch_packet *
+get_packet_and_neighbor_for_link(struct tsch_link *link, struct tsch_neighbor **target_neighbor)
+{
+#if TSCH_QUEUE_WITH_DEADLINE
+  struct tsch_packet *p;
+  struct tsch_neighbor *n;
+
+  while((p = select_packet_and_neighbor_for_link(link, &n)) != NULL
+        && tsch_queue_packet_expired(p)) {
+    /* The drop is reported through the dequeued ringbuf. When it has
+     * no room, the packet stays queued and is dropped in a later slot:
+     * it is not sent past its deadline either way. */
+    int16_t dequeued_index = ringbufindex_peek_put(&dequeued_ringbuf);
+    if(dequeued_index == -1 || tsch_queue_remove_expired_packet(n, p) == NULL) {
+      p = NULL;
+      break;
+    }
+    dequeued_array[dequeued_index] = p;
+    ringbufindex_put(&dequeued_ringbuf);
+  }
+
+  if(target_neighbor != NULL) {
+    *target_neighbor = n;
+  }
+  return p;
+#else /* TSCH_QUEUE_WITH_DEADLINE */
+  return select_packet_and_neighbor_for_link(link, target_neighbor);
+#endif /* TSCH_QUEUE_WITH_DEADLINE */
+}
+/*---------------------------------------------------------------------------*/
 uint64_t
 tsch_get_network_uptime_ticks(void)
 {
@@ -404,6 +486,7 @@ tsch_radio_on(enum tsch_radio_state_on_cmd command)
   }
   if(do_it) {
     NETSTACK_RADIO.on();
+    tsch_profile_radio_on();
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -435,6 +518,7 @@ tsch_radio_off(enum tsch_radio_state_off_cmd command)
   }
   if(do_it) {
     NETSTACK_RADIO.off();
+    tsch_profile_radio_off();
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -648,6 +732,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
                     );
                   }
                   tsch_stats_on_time_synchronization(eack_time_correction);
+                  tsch_profile_add(TSCH_PROFILE_DRIFT, ABS(eack_time_correction));
                   is_drift_correction_used = 1;
                   tsch_timesync_update(current_neighbor, since_last_timesync, drift_correction);
                   /* Keep track of sync time */
@@ -660,8 +745,19 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
                 /* We requested an extra slot and got an ack. This means
                 the extra slot will be scheduled at the received */
                 if(burst_link_requested) {
+#if TSCH_WITH_BURST_NEGOTIATION
+                  /* Unless the receiver did not grant it */
+                  burst_link_scheduled = ack_ies.ie_burst_grant > 0;
+#else /* TSCH_WITH_BURST_NEGOTIATION */
                   burst_link_scheduled = 1;
+#endif /* TSCH_WITH_BURST_NEGOTIATION */
+                }
+
+#if TSCH_PACKET_EACK_WITH_LOAD_LEVEL && defined(TSCH_CALLBACK_LOAD_LEVEL_RECEIVED)
+                if(ack_ies.ie_has_load_level) {
+                  TSCH_CALLBACK_LOAD_LEVEL_RECEIVED(&current_neighbor->addr, ack_ies.ie_load_level);
                 }
+#endif /* TSCH_PACKET_EACK_WITH_LOAD_LEVEL && TSCH_CALLBACK_LOAD_LEVEL_RECEIVED */
               } else {
                 mac_tx_status = MAC_TX_NOACK;
               }
@@ -696,6 +792,15 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
       tsch_stats_tx_packet(current_neighbor, mac_tx_status, tsch_current_channel);
     }
 
+#ifdef TSCH_CALLBACK_LINK_TX_DONE
+    /* Let the scheduling function account for the use of unicast links.
+     * Frames sent in the extra slots of a burst are not sent at the link */
+    if(current_neighbor != NULL && !current_neighbor->is_broadcast
+       && tsch_current_burst_count == 0) {
+      TSCH_CALLBACK_LINK_TX_DONE(current_link, mac_tx_status);
+    }
+#endif /* TSCH_CALLBACK_LINK_TX_DONE */
+
     /* Log every tx attempt */
     TSCH_LOG_ADD(tsch_log_tx,
         log->tx.mac_tx_status = mac_tx_status;
@@ -859,6 +964,7 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
             rx_count++;
             estimated_drift = RTIMER_CLOCK_DIFF(expected_rx_time, rx_start_time);
             tsch_stats_on_time_synchronization(estimated_drift);
+            tsch_profile_add(TSCH_PROFILE_DRIFT, ABS(estimated_drift));
 
 #if TSCH_TIMESYNC_REMOVE_JITTER
             /* remove jitter due to measurement errors */
@@ -881,10 +987,35 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
             if(frame.fcf.ack_required) {
               static uint8_t ack_buf[TSCH_PACKET_MAX_LEN];
               static int ack_len;
+              static uint8_t burst_grant;
+              static int load_level;
+
+              burst_grant = 0;
+              load_level = -1;
+
+#if TSCH_WITH_BURST_NEGOTIATION
+              /* Grant a burst if requested, for as many frames as we accept
+               * in this burst and have room for in the input queue */
+              if(tsch_packet_get_frame_pending(current_input->payload, current_input->len)
+                 && !do_nack) {
+                int room = ringbufindex_size(&input_ringbuf) - 2 - ringbufindex_elements(&input_ringbuf);
+                int left = TSCH_BURST_MAX_LEN - 1 - tsch_current_burst_count;
+                burst_grant = MAX(0, MIN(MIN(room, left), 0xff));
+              }
+#endif /* TSCH_WITH_BURST_NEGOTIATION */
+
+#if TSCH_PACKET_EACK_WITH_LOAD_LEVEL && defined(TSCH_CALLBACK_EACK_LOAD_LEVEL)
+              /* Tell the sender about our load level */
+              if(!do_nack) {
+                load_level = TSCH_CALLBACK_EACK_LOAD_LEVEL(current_link, &source_address,
+                    tsch_packet_get_frame_pending(current_input->payload, current_input->len));
+              }
+#endif /* TSCH_PACKET_EACK_WITH_LOAD_LEVEL && TSCH_CALLBACK_EACK_LOAD_LEVEL */
 
               /* Build ACK frame */
               ack_len = tsch_packet_create_eack(ack_buf, sizeof(ack_buf),
-                  &source_address, frame.seq, (int16_t)RTIMERTICKS_TO_US(estimated_drift), do_nack);
+                  &source_address, frame.seq, (int16_t)RTIMERTICKS_TO_US(estimated_drift), do_nack,
+                  burst_grant, load_level);
 
               if(ack_len > 0) {
 #if LLSEC802154_ENABLED
@@ -904,8 +1035,13 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
                 NETSTACK_RADIO.transmit(ack_len);
                 tsch_radio_off(TSCH_RADIO_CMD_OFF_WITHIN_TIMESLOT);
 
+#if TSCH_WITH_BURST_NEGOTIATION
+                /* Schedule a burst link iff we granted it */
+                burst_link_scheduled = burst_grant > 0;
+#else /* TSCH_WITH_BURST_NEGOTIATION */
                 /* Schedule a burst link iff the frame pending bit was set */
                 burst_link_scheduled = tsch_packet_get_frame_pending(current_input->payload, current_input->len);
+#endif /* TSCH_WITH_BURST_NEGOTIATION */
               }
             }
 
@@ -995,6 +1131,7 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
       int is_active_slot;
       TSCH_DEBUG_SLOT_START();
       tsch_in_slot_operation = 1;
+      tsch_profile_slot_start(current_slot_start);
       /* Measure on-air noise level while TSCH is idle */
       tsch_stats_sample_rssi();
       /* Reset drift correction */
@@ -1090,7 +1227,11 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
           tsch_current_burst_count++;
         } else {
           /* Get next active link */
+#if TSCH_PROFILE_ON
+          rtimer_clock_t next_link_start = RTIMER_NOW();
+#endif /* TSCH_PROFILE_ON */
           current_link = tsch_schedule_get_next_active_link(&tsch_current_asn, &timeslot_diff, &backup_link);
+          tsch_profile_add(TSCH_PROFILE_NEXT_LINK, RTIMER_NOW() - next_link_start);
           if(current_link == NULL) {
             /* There is no next link. Fall back to default
              * behavior: wake up at the next slot. */
@@ -1115,7 +1256,15 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
       } while(!tsch_schedule_slot_operation(t, prev_slot_start, time_to_next_active_slot, "main"));
     }
 
+    tsch_profile_slot_end();
     tsch_in_slot_operation = 0;
+#if TSCH_WITH_LOCK_FREE
+    slot_operation_epoch++;
+    if(release_pending) {
+      release_pending = 0;
+      process_poll(&tsch_pending_events_process);
+    }
+#endif /* TSCH_WITH_LOCK_FREE */
     PT_YIELD(&slot_operation_pt);
   }
 
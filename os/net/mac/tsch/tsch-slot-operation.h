@@ -90,6 +90,34 @@ int tsch_get_lock(void);
  * Releases the TSCH lock.
  */
 void tsch_release_lock(void);
+
+#if TSCH_WITH_LOCK_FREE
+/* Schedule and neighbor edits do not take the lock */
+#define TSCH_EDIT_LOCK() 1
+#define TSCH_EDIT_RELEASE()
+/**
+ * Called after unlinking a link or a neighbor from the schedule or
+ * neighbor list without the lock. If no slot operation is ongoing, makes
+ * sure the next one will not use the link.
+ *
+ * \param l The unlinked link, NULL for a neighbor
+ * \param epoch Set if the item is still in use, for tsch_slot_operation_ended
+ * \return 1 if the item can be freed now, 0 if the ongoing slot operation
+ * may still use it
+ */
+int tsch_slot_operation_release(const struct tsch_link *l, uint16_t *epoch);
+/**
+ * Tells whether the slot operation ongoing when an item was released has
+ * ended, i.e. whether the item can be freed.
+ *
+ * \param epoch The epoch set by tsch_slot_operation_release
+ * \return 1 if the slot operation has ended, 0 otherwise
+ */
+int tsch_slot_operation_ended(uint16_t epoch);
+#else /* TSCH_WITH_LOCK_FREE */
+#define TSCH_EDIT_LOCK() tsch_get_lock()
+#define TSCH_EDIT_RELEASE() tsch_release_lock()
+#endif /* TSCH_WITH_LOCK_FREE */
 /**
  * Set global time before starting slot operation, with a rtimer time and an ASN
  *
@@ -103,6 +103,13 @@ struct tsch_packet {
   uint8_t ret; /* status -- MAC return code */
   uint8_t header_len; /* length of header and header IEs (needed for link-layer security) */
   uint8_t tsch_sync_ie_offset; /* Offset within the frame used for quick update of EB ASN and join priority */
+#if TSCH_QUEUE_NUM_CLASSES > 1
+  uint8_t tx_class; /* traffic class, i.e. queue of the neighbor holding the packet */
+#endif /* TSCH_QUEUE_NUM_CLASSES > 1 */
+#if TSCH_QUEUE_WITH_DEADLINE
+  uint8_t has_deadline; /* is the packet dropped once its deadline is passed? */
+  clock_time_t deadline; /* time by which the packet must be sent */
+#endif /* TSCH_QUEUE_WITH_DEADLINE */
 };
 
 /** \brief TSCH neighbor information */
@@ -117,11 +124,11 @@ struct tsch_neighbor {
   uint8_t last_backoff_window; /* Last CSMA backoff window */
   uint8_t tx_links_count; /* How many links do we have to this neighbor? */
   uint8_t dedicated_tx_links_count; /* How many dedicated links do we have to this neighbor? */
-  /* Array for the ringbuf. Contains pointers to packets.
-   * Its size must be a power of two to allow for atomic put */
-  struct tsch_packet *tx_array[TSCH_QUEUE_NUM_PER_NEIGHBOR];
-  /* Circular buffer of pointers to packet. */
-  struct ringbufindex tx_ringbuf;
+  /* Arrays for the ringbufs, one per traffic class. Contain pointers to packets.
+   * Their size must be a power of two to allow for atomic put */
+  struct tsch_packet *tx_array[TSCH_QUEUE_NUM_CLASSES][TSCH_QUEUE_NUM_PER_NEIGHBOR];
+  /* Circular buffers of pointers to packet, one per traffic class. */
+  struct ringbufindex tx_ringbuf[TSCH_QUEUE_NUM_CLASSES];
 };
 
 /** \brief TSCH timeslot timing elements. Used to index timeslot timing
@@ -670,11 +670,22 @@ tsch_associate(const struct input_packet *input_eb, rtimer_clock_t timestamp)
 #else
     LOG_INFO("parse_eb: no schedule\n");
 #endif /* TSCH_SCHEDULE_wITH_6TISCH_MINIMAL */
+#if DYNSCHED_TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK
+    /* Schedules too large for the slotframe and link IE are only sent
+     * in fragment IEs, which replace the schedule above once complete */
+    dynsched_create_schedule_from_ies(ies);
+#endif /* DYNSCHED_TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK */
   } else {
     LOG_INFO("parse_eb: schedule found\n");
 #if DYNSCHED_TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK
 	/* Dynamic Scheduling API */
-	dynsched_create_schedule_from_ies(ies);
+	if(!dynsched_create_schedule_from_ies(ies)) {
+#if DYNSCHED_CONF_CUSTOM_SCHEDULE
+		/* The EB holds a schedule delta: use the default schedule until
+		 * an EB with the complete schedule is received */
+		dynsched_schedule_create_from_array(DYNSCHED_TSCH_SCHEDULE_DEFAULT_LENGTH, default_ns_arr);
+#endif /* DYNSCHED_CONF_CUSTOM_SCHEDULE */
+	}
 #else
      /* Default behaviour */
     /* First, empty current schedule */
@@ -950,6 +961,12 @@ PROCESS_THREAD(tsch_pending_events_process, ev, data)
     tsch_rx_process_pending();
     tsch_tx_process_pending();
     tsch_log_process_pending();
+#if TSCH_WITH_LOCK_FREE
+    /* Free the links, slotframes and neighbors removed during the slot
+     * operations that have ended since */
+    tsch_schedule_free_removed();
+    tsch_queue_free_removed_neighbors();
+#endif /* TSCH_WITH_LOCK_FREE */
 #ifdef TSCH_CALLBACK_SELECT_CHANNELS
     TSCH_CALLBACK_SELECT_CHANNELS();
 #endif
@@ -1177,6 +1194,7 @@ turn_on(void)
   if(tsch_is_initialized == 1 && tsch_is_started == 0) {
     tsch_is_started = 1;
     /* Process tx/rx callback and log messages whenever polled */
+    process_set_priority(&tsch_pending_events_process, PROCESS_PRIORITY_HIGH);
     process_start(&tsch_pending_events_process, NULL);
     /* periodically send TSCH EBs */
     process_start(&tsch_send_eb_process, NULL);   
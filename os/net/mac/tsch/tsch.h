@@ -61,6 +61,7 @@ frequency hopping for enhanced reliability.
 #include "net/mac/tsch/tsch-security.h"
 #include "net/mac/tsch/tsch-schedule.h"
 #include "net/mac/tsch/tsch-stats.h"
+#include "net/mac/tsch/tsch-profile.h"
 #if UIP_CONF_IPV6_RPL
 #include "net/mac/tsch/tsch-rpl.h"
 #endif /* UIP_CONF_IPV6_RPL */
@@ -104,8 +105,28 @@ frequency hopping for enhanced reliability.
 #define TSCH_CALLBACK_PACKET_READY orchestra_callback_packet_ready
 #endif /* TSCH_CALLBACK_PACKET_READY */
 
+#if TSCH_PACKET_EACK_WITH_LOAD_LEVEL
+
+#ifndef TSCH_CALLBACK_EACK_LOAD_LEVEL
+#define TSCH_CALLBACK_EACK_LOAD_LEVEL orchestra_callback_eack_load_level
+#endif /* TSCH_CALLBACK_EACK_LOAD_LEVEL */
+
+#ifndef TSCH_CALLBACK_LOAD_LEVEL_RECEIVED
+#define TSCH_CALLBACK_LOAD_LEVEL_RECEIVED orchestra_callback_load_level_received
+#endif /* TSCH_CALLBACK_LOAD_LEVEL_RECEIVED */
+
+#endif /* TSCH_PACKET_EACK_WITH_LOAD_LEVEL */
+
 #endif /* BUILD_WITH_ORCHESTRA */
 
+#if BUILD_WITH_MSF
+
+#ifndef TSCH_CALLBACK_LINK_TX_DONE
+#define TSCH_CALLBACK_LINK_TX_DONE msf_callback_link_tx_done
+#endif /* TSCH_CALLBACK_LINK_TX_DONE */
+
+#endif /* BUILD_WITH_MSF */
+
 /* Called by TSCH when joining a network */
 #ifdef TSCH_CALLBACK_JOINING_NETWORK
 void TSCH_CALLBACK_JOINING_NETWORK();
@@ -132,6 +153,26 @@ int TSCH_RPL_CHECK_DODAG_JOINED();
 int TSCH_CALLBACK_DO_NACK(struct tsch_link *link, linkaddr_t *src, linkaddr_t *dst);
 #endif
 
+/* Called by TSCH from interrupt before ACKing a unicast frame, to get the load
+ * level to send in the enhanced ACK. link is the link the frame was received
+ * on, and frame_pending the frame pending bit of the frame being ACKed */
+#ifdef TSCH_CALLBACK_EACK_LOAD_LEVEL
+uint8_t TSCH_CALLBACK_EACK_LOAD_LEVEL(const struct tsch_link *link,
+                                      const linkaddr_t *src, int frame_pending);
+#endif
+
+/* Called by TSCH from interrupt after receiving an enhanced ACK with a load level */
+#ifdef TSCH_CALLBACK_LOAD_LEVEL_RECEIVED
+void TSCH_CALLBACK_LOAD_LEVEL_RECEIVED(const linkaddr_t *addr, uint8_t level);
+#endif
+
+/* Called by TSCH from interrupt after a unicast transmission in a link,
+ * not after those in the extra slots of a burst */
+#ifdef TSCH_CALLBACK_LINK_TX_DONE
+struct tsch_link;
+void TSCH_CALLBACK_LINK_TX_DONE(const struct tsch_link *link, int mac_tx_status);
+#endif
+
 /* Called by TSCH when switching time source */
 #ifdef TSCH_CALLBACK_NEW_TIME_SOURCE
 struct tsch_neighbor;
@@ -38,6 +38,7 @@
 #include <string.h>
 #include "lib/memb.h"
 #include "lib/list.h"
+#include "lib/hash-index.h"
 #include "net/nbr-table.h"
 
 #define DEBUG 0
@@ -83,6 +84,10 @@ static unsigned num_tables;
 MEMB(neighbor_addr_mem, nbr_table_key_t, NBR_TABLE_MAX_NEIGHBORS);
 LIST(nbr_table_keys);
 
+#if NBR_TABLE_WITH_HASH && NBR_TABLE_HASH_SIZE <= NBR_TABLE_MAX_NEIGHBORS
+#error NBR_TABLE_HASH_SIZE must be larger than NBR_TABLE_MAX_NEIGHBORS
+#endif
+
 /*---------------------------------------------------------------------------*/
 /* Get a key from a neighbor index */
 static nbr_table_key_t *
@@ -126,16 +131,45 @@ key_from_item(nbr_table_t *table, const nbr_table_item_t *item)
   return key_from_index(index_from_item(table, item));
 }
 /*---------------------------------------------------------------------------*/
+#if NBR_TABLE_WITH_HASH
+static uint32_t
+lladdr_hash(const linkaddr_t *lladdr)
+{
+  return hash_index_hash(0, lladdr, LINKADDR_SIZE);
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+key_hash(unsigned index)
+{
+  return lladdr_hash(&key_from_index(index)->lladdr);
+}
+/*---------------------------------------------------------------------------*/
+static int
+key_match(unsigned index, const void *lladdr)
+{
+  return linkaddr_cmp(lladdr, &key_from_index(index)->lladdr);
+}
+/*---------------------------------------------------------------------------*/
+/* Index from link-layer address to neighbor index */
+HASH_INDEX(lladdr_index, NBR_TABLE_HASH_SIZE, key_hash, key_match);
+#endif /* NBR_TABLE_WITH_HASH */
+/*---------------------------------------------------------------------------*/
 /* Get the index of a neighbor from its link-layer address */
 static int
 index_from_lladdr(const linkaddr_t *lladdr)
 {
+#if !NBR_TABLE_WITH_HASH
   nbr_table_key_t *key;
+#endif /* !NBR_TABLE_WITH_HASH */
+
   /* Allow lladdr-free insertion, useful e.g. for IPv6 ND.
    * Only one such entry is possible at a time, indexed by linkaddr_null. */
   if(lladdr == NULL) {
     lladdr = &linkaddr_null;
   }
+#if NBR_TABLE_WITH_HASH
+  return hash_index_find(&lladdr_index, lladdr_hash(lladdr), lladdr);
+#else /* NBR_TABLE_WITH_HASH */
   key = list_head(nbr_table_keys);
   while(key != NULL) {
     if(lladdr && linkaddr_cmp(lladdr, &key->lladdr)) {
@@ -144,6 +178,7 @@ index_from_lladdr(const linkaddr_t *lladdr)
     key = list_item_next(key);
   }
   return -1;
+#endif /* NBR_TABLE_WITH_HASH */
 }
 /*---------------------------------------------------------------------------*/
 /* Get bit from "used" or "locked" bitmap */
@@ -195,6 +230,9 @@ remove_key(nbr_table_key_t *least_used_key)
   used_map[index_from_key(least_used_key)] = 0;
   /* Remove neighbor from list */
   list_remove(nbr_table_keys, least_used_key);
+#if NBR_TABLE_WITH_HASH
+  hash_index_remove(&lladdr_index, index_from_key(least_used_key));
+#endif /* NBR_TABLE_WITH_HASH */
 }
 /*---------------------------------------------------------------------------*/
 static nbr_table_key_t *
@@ -381,6 +419,9 @@ nbr_table_add_lladdr(nbr_table_t *table, const linkaddr_t *lladdr, nbr_table_rea
 
     /* Set link-layer address */
     linkaddr_copy(&key->lladdr, lladdr);
+#if NBR_TABLE_WITH_HASH
+    hash_index_insert(&lladdr_index, index);
+#endif /* NBR_TABLE_WITH_HASH */
   }
 
   /* Get item in the current table */
@@ -46,6 +46,23 @@
 #define NBR_TABLE_MAX_NEIGHBORS 8
 #endif /* NBR_TABLE_CONF_MAX_NEIGHBORS */
 
+/* Index the neighbors by link-layer address in a hash table, so that
+   lookups do not need to walk all neighbors */
+#ifdef NBR_TABLE_CONF_WITH_HASH
+#define NBR_TABLE_WITH_HASH NBR_TABLE_CONF_WITH_HASH
+#else /* NBR_TABLE_CONF_WITH_HASH */
+#define NBR_TABLE_WITH_HASH 0
+#endif /* NBR_TABLE_CONF_WITH_HASH */
+
+/* Number of slots in the hash table. Must be larger than
+   NBR_TABLE_MAX_NEIGHBORS; a few spare slots keep the probe
+   sequences short */
+#ifdef NBR_TABLE_CONF_HASH_SIZE
+#define NBR_TABLE_HASH_SIZE NBR_TABLE_CONF_HASH_SIZE
+#else /* NBR_TABLE_CONF_HASH_SIZE */
+#define NBR_TABLE_HASH_SIZE (2 * NBR_TABLE_MAX_NEIGHBORS)
+#endif /* NBR_TABLE_CONF_HASH_SIZE */
+
 /* An item in a neighbor table */
 typedef void nbr_table_item_t;
 
@@ -228,6 +228,12 @@ enum {
   PACKETBUF_ATTR_TSCH_SLOTFRAME,
   PACKETBUF_ATTR_TSCH_TIMESLOT,
 #endif /* TSCH_WITH_LINK_SELECTOR */
+#if TSCH_QUEUE_NUM_CLASSES > 1
+  PACKETBUF_ATTR_TSCH_TRAFFIC_CLASS,
+#endif /* TSCH_QUEUE_NUM_CLASSES > 1 */
+#if TSCH_QUEUE_WITH_DEADLINE
+  PACKETBUF_ATTR_TSCH_DEADLINE,
+#endif /* TSCH_QUEUE_WITH_DEADLINE */
 
   /* Scope 1 attributes: used between two neighbors only. */
   PACKETBUF_ATTR_FRAME_TYPE,
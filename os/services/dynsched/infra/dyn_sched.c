@@ -62,6 +62,34 @@
 
 struct network_schedules net_schedules_links;
 
+/* Links changed by the last network schedule update - At Coordinator */
+static struct network_schedules net_schedules_delta;
+/* Number of EBs left to carry the delta */
+static uint8_t delta_eb_count;
+
+/* Version of the schedule received through EBs, -1 if none - At Node */
+static int16_t local_version = -1;
+
+/*
+ * Encoded network schedule. It starts with the slotframe handle, the
+ * slotframe size and the number of links, followed by the links packed
+ * at bit level: the timeslot on as many bits as the slotframe size needs,
+ * then 4 bits of channel offset, 4 bits of link options and 8 bits of
+ * node id. The coordinator sends it in fragments, one per EB, and the
+ * nodes reassemble it before applying it.
+ */
+#define STREAM_HEADER_LEN 5
+#define STREAM_MAX_LEN (STREAM_HEADER_LEN + 4 * DYNSCHED_MAX_LINKS)
+static uint8_t stream[STREAM_MAX_LEN];
+static uint16_t stream_len;
+static uint8_t stream_version;
+static uint8_t stream_count;
+/* Next fragment to send - At Coordinator */
+static uint8_t stream_next;
+/* Fragments received so far - At Node */
+static uint32_t stream_received[256 / 32];
+static uint8_t stream_num_received;
+
 
 /*---------------------------------------------------------------------------*/
 void dynsched_led_debug()
@@ -71,26 +99,100 @@ void dynsched_led_debug()
 /*---------------------------------------------------------------------------*/
 
 
+/*---------------------------------------------------------------------------*/
+/* Number of bits needed for the timeslots of a slotframe */
+static uint8_t
+timeslot_bits(uint16_t slotframe_size)
+{
+	uint8_t bits = 1;
+	while(bits < 16 && (slotframe_size - 1) >> bits) {
+		bits++;
+	}
+	return bits;
+}
+/*---------------------------------------------------------------------------*/
+static void
+put_bits(uint16_t *pos, uint16_t value, uint8_t bits)
+{
+	while(bits-- > 0) {
+		if((value >> bits) & 1) {
+			stream[*pos >> 3] |= 0x80 >> (*pos & 7);
+		} else {
+			stream[*pos >> 3] &= ~(0x80 >> (*pos & 7));
+		}
+		(*pos)++;
+	}
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+get_bits(uint16_t *pos, uint8_t bits)
+{
+	uint16_t value = 0;
+	while(bits-- > 0) {
+		value = (value << 1) | ((stream[*pos >> 3] >> (7 - (*pos & 7))) & 1);
+		(*pos)++;
+	}
+	return value;
+}
+/*---------------------------------------------------------------------------*/
+/* Encodes the network schedule into the stream - At Coordinator */
+static void
+dynsched_encode_stream(void)
+{
+	struct tsch_slotframe *sf0 = tsch_schedule_get_slotframe_by_handle(0);
+	uint16_t size = sf0 != NULL ? sf0->size.val : net_schedules_links.num_links;
+	uint8_t bits = timeslot_bits(size);
+	uint16_t pos;
+	int i;
+
+	stream[0] = 0;
+	stream[1] = size & 0xff;
+	stream[2] = size >> 8;
+	stream[3] = net_schedules_links.num_links & 0xff;
+	stream[4] = net_schedules_links.num_links >> 8;
+	pos = STREAM_HEADER_LEN * 8;
+	for(i = 0; i < net_schedules_links.num_links; i++) {
+		put_bits(&pos, net_schedules_links.links[i].timeslot, bits);
+		put_bits(&pos, net_schedules_links.links[i].channel_offset, 4);
+		put_bits(&pos, net_schedules_links.links[i].link_options, 4);
+		put_bits(&pos, net_schedules_links.links[i].nodeid, 8);
+	}
+	stream_len = (pos + 7) / 8;
+	stream_version = net_schedules_links.version;
+	stream_count = (stream_len + DYNSCHED_FRAGMENT_SIZE - 1) / DYNSCHED_FRAGMENT_SIZE;
+	stream_next = 0;
+	LOG_INFO("Encoded %u links in %u bytes, %u fragments\n",
+		net_schedules_links.num_links, stream_len, stream_count);
+}
+/*---------------------------------------------------------------------------*/
+
 /*---------------------------------------------------------------------------*/
 /* Updates Network Schedules struct used for EB creation - At Coordinator*/
 
-void dynsched_update_network_schedules(int num_links, uint16_t arr[FRAME802154E_IE_MAX_LINKS][4])
+void dynsched_update_network_schedules(int num_links, uint16_t arr[][4])
 {
     int i;
-    net_schedules_links.num_links = num_links;
 
-	if (num_links > FRAME802154E_IE_MAX_LINKS) {
+	if (num_links > DYNSCHED_MAX_LINKS) {
 		LOG_ERR("Could not update Network schedule\n");
 		return;
 	}
+    net_schedules_links.num_links = num_links;
 	LOG_INFO ("Updating Network schedule\n");
     for (i=0; i<num_links; i++) {
     	net_schedules_links.links[i].timeslot = arr[i][0];
     	net_schedules_links.links[i].channel_offset = arr[i][1];
        	net_schedules_links.links[i].link_options = (uint8_t)arr[i][2];
       	net_schedules_links.links[i].nodeid = (uint8_t)arr[i][3];
+      	net_schedules_links.links[i].op = FRAME802154E_IE_LINK_OP_ADD;
  	}
-	
+	net_schedules_links.version++;
+	/* The complete schedule replaces any delta not sent yet */
+	delta_eb_count = 0;
+	if (num_links > FRAME802154E_IE_MAX_LINKS) {
+		/* Too large for the slotframe and link IE: send it in fragments */
+		dynsched_encode_stream();
+	}
 }
 
 /*---------------------------------------------------------------------------*/
@@ -124,66 +226,205 @@ void dynsched_print_network_schedules(void)
 
 /*---------------------------------------------------------------------------*/
 
+/*---------------------------------------------------------------------------*/
+/* Applies a link of the network schedule to the local slotframe.
+ * Links destined to other nodes become RX links in their timeslot */
+static void
+dynsched_apply_link(struct tsch_slotframe *sf,
+		const struct tsch_slotframe_and_links_link *link,
+		uint8_t link_options, enum link_type link_type)
+{
+	if(link->op == FRAME802154E_IE_LINK_OP_REMOVE) {
+		tsch_schedule_remove_link_by_timeslot(sf, link->timeslot);
+	} else if(link->nodeid == node_id) {
+		dynsched_led_debug();
+		tsch_schedule_add_link(sf, link->link_options | link_options,
+			link_type, &tsch_broadcast_address,
+			link->timeslot, link->channel_offset);
+	} else {
+		tsch_schedule_add_link(sf,
+			LINK_OPTION_RX | LINK_OPTION_TIME_KEEPING,
+			LINK_TYPE_ADVERTISING, &tsch_broadcast_address,
+			link->timeslot, 0);
+	}
+}
+/*---------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------*/
+/* Decodes the link at a given index of the stream */
+static void
+dynsched_stream_link(uint16_t index, uint8_t bits,
+		struct tsch_slotframe_and_links_link *link)
+{
+	uint16_t pos = STREAM_HEADER_LEN * 8 + index * (bits + 16);
+
+	link->timeslot = get_bits(&pos, bits);
+	link->channel_offset = get_bits(&pos, 4);
+	link->link_options = get_bits(&pos, 4);
+	link->nodeid = get_bits(&pos, 8);
+	link->op = FRAME802154E_IE_LINK_OP_ADD;
+}
+/*---------------------------------------------------------------------------*/
+/* Applies the reassembled stream to the schedule in one go - At Node */
+static void
+dynsched_apply_stream(void)
+{
+	struct tsch_slotframe *sf;
+	struct tsch_slotframe_and_links_link link;
+	struct tsch_link *l, *next;
+	uint16_t size, num_links, i;
+	uint8_t bits;
+
+	size = stream[1] | (stream[2] << 8);
+	num_links = stream[3] | (stream[4] << 8);
+	bits = timeslot_bits(size);
+	if(size == 0 || STREAM_HEADER_LEN + ((uint32_t)num_links * (bits + 16) + 7) / 8 > stream_len) {
+		LOG_ERR("! Malformed schedule stream version %u\n", stream_version);
+		return;
+	}
+
+	sf = tsch_schedule_get_slotframe_by_handle(stream[0]);
+	if(sf == NULL || sf->size.val != size) {
+		tsch_schedule_remove_all_slotframes();
+		sf = tsch_schedule_add_slotframe(stream[0], size);
+		if(sf == NULL) {
+			return;
+		}
+	} else {
+		/* Keep the slotframe, and remove only the links that are gone */
+		for(l = list_head(sf->links_list); l != NULL; l = next) {
+			next = list_item_next(l);
+			for(i = 0; i < num_links; i++) {
+				dynsched_stream_link(i, bits, &link);
+				if(link.timeslot == l->timeslot) {
+					break;
+				}
+			}
+			if(i == num_links) {
+				tsch_schedule_remove_link(sf, l);
+			}
+		}
+	}
+
+	for(i = 0; i < num_links; i++) {
+		dynsched_stream_link(i, bits, &link);
+		dynsched_apply_link(sf, &link, 0, LINK_TYPE_NORMAL);
+	}
+	local_version = stream_version;
+	LOG_INFO("Applied schedule version %u with %u links\n", stream_version, num_links);
+}
+/*---------------------------------------------------------------------------*/
+/* Stores a fragment of the stream, and applies the stream once all
+ * fragments of its version are received - At Node */
+static void
+dynsched_input_fragment(const struct tsch_schedule_fragment *frag)
+{
+	if(frag->version == local_version || frag->count == 0
+		|| frag->index >= frag->count
+		|| frag->offset + frag->len > STREAM_MAX_LEN) {
+		return;
+	}
+
+	if(frag->version != stream_version || frag->count != stream_count
+		|| stream_num_received == 0) {
+		/* Start reassembling a new version */
+		memset(stream_received, 0, sizeof(stream_received));
+		stream_num_received = 0;
+		stream_version = frag->version;
+		stream_count = frag->count;
+		stream_len = 0;
+	}
+
+	if(stream_received[frag->index / 32] & ((uint32_t)1 << (frag->index % 32))) {
+		return;
+	}
+	memcpy(stream + frag->offset, frag->data, frag->len);
+	stream_received[frag->index / 32] |= (uint32_t)1 << (frag->index % 32);
+	stream_num_received++;
+	if(frag->offset + frag->len > stream_len) {
+		stream_len = frag->offset + frag->len;
+	}
+	LOG_DBG("Schedule fragment %u/%u of version %u\n",
+		frag->index + 1, frag->count, frag->version);
+
+	if(stream_num_received == stream_count) {
+		dynsched_apply_stream();
+		stream_num_received = 0;
+	}
+}
+/*---------------------------------------------------------------------------*/
+
 /*---------------------------------------------------------------------------*/
 /* Creates schedule from the IE obtained from received EB - At Node*/
-void dynsched_create_schedule_from_ies(struct ieee802154_ies ies0)
+int dynsched_create_schedule_from_ies(struct ieee802154_ies ies0)
 {
 	int num_links;
+	uint8_t version, base_version;
 	struct tsch_slotframe *sf;
 
+	if(ies0.ie_schedule_fragment.len > 0) {
+		dynsched_input_fragment(&ies0.ie_schedule_fragment);
+	}
+
 	if(ies0.ie_tsch_slotframe_and_link.num_slotframes > 0) {
-		LOG_INFO ("Updating schedule from EB IES\n");
 		num_links = ies0.ie_tsch_slotframe_and_link.num_links;
 		
 		if (num_links > FRAME802154E_IE_MAX_LINKS) {
 			LOG_ERR("! parse_eb: too many links in schedule (%u)\n", num_links);
-			return;
+			return 0;
 		}
-		
-  		/* Evaluation */
-  		long unsigned start, end, diff;
-  		start = (unsigned long)clock_time();
-		//LOG_WARN("Start: %lu TICKS", start);
+
+		version = ies0.ie_tsch_slotframe_and_link.version;
+		base_version = ies0.ie_tsch_slotframe_and_link.base_version;
+		sf = tsch_schedule_get_slotframe_by_handle(
+			ies0.ie_tsch_slotframe_and_link.slotframe_handle);
+		if(local_version == version && sf != NULL) {
+			/* Nothing to do, the schedule is up to date */
+			return 1;
+		}
+
+		if(base_version != version) {
+			/* A delta, which is patched into the schedule in place if it
+			 * applies to the version we have */
+			if(local_version != base_version || sf == NULL
+				|| sf->size.val != ies0.ie_tsch_slotframe_and_link.slotframe_size) {
+				LOG_INFO("Ignoring schedule delta %u->%u, local version %d\n",
+					base_version, version, local_version);
+				return 0;
+			}
+			LOG_INFO("Applying schedule delta %u->%u from EB IES\n",
+				base_version, version);
+			for(int i = 0; i < num_links; i++) {
+				dynsched_apply_link(sf, &ies0.ie_tsch_slotframe_and_link.links[i],
+					0, LINK_TYPE_NORMAL);
+			}
+			local_version = version;
+			return 1;
+		}
+
+		LOG_INFO ("Updating schedule from EB IES\n");
 
 		tsch_schedule_remove_all_slotframes();
 		
 		sf = tsch_schedule_add_slotframe(
           ies0.ie_tsch_slotframe_and_link.slotframe_handle,
           ies0.ie_tsch_slotframe_and_link.slotframe_size);
+		if(sf == NULL) {
+			return 0;
+		}
 		
+		/* The same links as a delta would install, so that the schedule
+		 * does not depend on how it was received */
 		for(int i = 0; i < num_links; i++) {
-        	if (ies0.ie_tsch_slotframe_and_link.links[i].nodeid == node_id) {
-        	/* If the schedule is destined to the node, then follow IE */
-        		LOG_INFO ("Link for node: %d timeslot: %d\n linkopt: %d", node_id,
-				ies0.ie_tsch_slotframe_and_link.links[i].timeslot,
-				ies0.ie_tsch_slotframe_and_link.links[i].link_options);
-				dynsched_led_debug();
-        		
-				tsch_schedule_add_link(sf, 
-					ies0.ie_tsch_slotframe_and_link.links[i].link_options,
-            		LINK_TYPE_NORMAL, &tsch_broadcast_address,
-            		ies0.ie_tsch_slotframe_and_link.links[i].timeslot, 
-	    			ies0.ie_tsch_slotframe_and_link.links[i].channel_offset);
-        	} else {
-        		/* 
-				 * If not, add a default RX Link in that timeslot
-         		 * Here, timeslot and the loop integer i are the same
-	 			 * because every time slot has only one channel offset 
-				 */
-				tsch_schedule_add_link(sf,
-            		LINK_OPTION_RX | LINK_OPTION_TIME_KEEPING,
-            		LINK_TYPE_ADVERTISING, &tsch_broadcast_address,
-            		i, 0);
-        	}
-      	}
-		/* Evaluation */		
-  		end = (unsigned long)clock_time();
-		//LOG_WARN("End: %lu TICKS", end);
-  		diff = end - start;
-  		LOG_WARN("Diff= %lu ticks\n", diff);
+			dynsched_apply_link(sf, &ies0.ie_tsch_slotframe_and_link.links[i],
+				0, LINK_TYPE_NORMAL);
+		}
+		local_version = version;
+		return 1;
 	} else {
 	LOG_INFO ("No schedule found in the EB\n");
 	}	
+	return 0;
 }
 
 /*---------------------------------------------------------------------------*/
@@ -191,7 +432,7 @@ void dynsched_create_schedule_from_ies(struct ieee802154_ies ies0)
 /*---------------------------------------------------------------------------*/
 /* Create schedule from the input 2D array - At Coordinator*/
 void
-dynsched_schedule_create_from_array(int num_links, uint16_t arr[FRAME802154E_IE_MAX_LINKS][4])
+dynsched_schedule_create_from_array(int num_links, uint16_t arr[][4])
 {
   struct tsch_slotframe *sfa;
   int t_slot, ch_off;
@@ -200,13 +441,10 @@ dynsched_schedule_create_from_array(int num_links, uint16_t arr[FRAME802154E_IE_
   linkaddr_t addr=tsch_broadcast_address;
 
   LOG_INFO("Creating schedule from array input\n");
-  /* Evaluation */
-  long unsigned start, end, diff;
-  start = (unsigned long)clock_time();
-  //LOG_WARN("Start: %lu ticks\n", start); 
   
   /* First, empty current schedule */
   tsch_schedule_remove_all_slotframes();
+  local_version = -1;
   /* Build 6TiSCH custom schedule.
    * We pick a slotframe length equal to the param num_links
    * And add two links according to the table */
@@ -222,19 +460,99 @@ dynsched_schedule_create_from_array(int num_links, uint16_t arr[FRAME802154E_IE_
             	(link_opt | LINK_OPTION_TIME_KEEPING), 
             	link_typ, &addr, t_slot, ch_off);
 		} else {
-		/* If not, Add a default RX Link in that timeslot
-         * Here, timeslot and the loop integer i are the same
-	 	 * because every time slot has only one channel offset */
+		/* If not, Add a default RX Link in that timeslot */
 			tsch_schedule_add_link(sfa,
             	LINK_OPTION_RX | LINK_OPTION_TIME_KEEPING,
             	link_typ, &tsch_broadcast_address,
-            	i, 0);
+            	arr[i][0], 0);
     	}
   } 
-  end = (unsigned long)clock_time();
-  //LOG_WARN("End: %lu ticks\n", end);
-  diff = end - start;
-  LOG_WARN("Diff= %lu ticks\n", diff);
+}
+/*---------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------*/
+/* Appends a link to the pending delta, returns 0 if the delta is full */
+static int
+dynsched_delta_add(uint8_t op, const struct tsch_slotframe_and_links_link *link)
+{
+	if(net_schedules_delta.num_links == FRAME802154E_IE_MAX_LINKS) {
+		return 0;
+	}
+	net_schedules_delta.links[net_schedules_delta.num_links] = *link;
+	net_schedules_delta.links[net_schedules_delta.num_links].op = op;
+	net_schedules_delta.num_links++;
+	return 1;
+}
+/*---------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------*/
+/* Updates the schedule from the input 2D array by changing only the
+ * links that differ from the network schedule - At Coordinator */
+void
+dynsched_schedule_update_from_array(int num_links, uint16_t arr[][4])
+{
+	struct tsch_slotframe *sf;
+	struct tsch_slotframe_and_links_link link;
+	int i, j, fits;
+
+	sf = tsch_schedule_get_slotframe_by_handle(0);
+	fits = sf != NULL && num_links == net_schedules_links.num_links;
+
+	/* Links that are new or changed */
+	net_schedules_delta.num_links = 0;
+	for(i = 0; fits && i < num_links; i++) {
+		link.timeslot = arr[i][0];
+		link.channel_offset = arr[i][1];
+		link.link_options = (uint8_t)arr[i][2];
+		link.nodeid = (uint8_t)arr[i][3];
+		for(j = 0; j < net_schedules_links.num_links; j++) {
+			if(net_schedules_links.links[j].timeslot == link.timeslot) {
+				break;
+			}
+		}
+		if(j == net_schedules_links.num_links) {
+			fits = dynsched_delta_add(FRAME802154E_IE_LINK_OP_ADD, &link);
+		} else if(net_schedules_links.links[j].channel_offset != link.channel_offset
+			|| net_schedules_links.links[j].link_options != link.link_options
+			|| net_schedules_links.links[j].nodeid != link.nodeid) {
+			fits = dynsched_delta_add(FRAME802154E_IE_LINK_OP_MODIFY, &link);
+		}
+	}
+
+	/* Links that are gone */
+	for(j = 0; fits && j < net_schedules_links.num_links; j++) {
+		for(i = 0; i < num_links; i++) {
+			if(arr[i][0] == net_schedules_links.links[j].timeslot) {
+				break;
+			}
+		}
+		if(i == num_links) {
+			fits = dynsched_delta_add(FRAME802154E_IE_LINK_OP_REMOVE,
+				&net_schedules_links.links[j]);
+		}
+	}
+
+	if(!fits) {
+		/* The slotframe size changes with the number of links, or too many
+		 * links change for a delta: rebuild the schedule */
+		dynsched_schedule_create_from_array(num_links, arr);
+		dynsched_update_network_schedules(num_links, arr);
+		return;
+	}
+
+	if(net_schedules_delta.num_links == 0) {
+		LOG_INFO("Network schedule unchanged\n");
+		return;
+	}
+
+	LOG_INFO("Updating %u links of the schedule\n", net_schedules_delta.num_links);
+	for(i = 0; i < net_schedules_delta.num_links; i++) {
+		dynsched_apply_link(sf, &net_schedules_delta.links[i],
+			LINK_OPTION_TIME_KEEPING, LINK_TYPE_ADVERTISING);
+	}
+	dynsched_update_network_schedules(num_links, arr);
+	net_schedules_delta.version = net_schedules_links.version;
+	delta_eb_count = DYNSCHED_DELTA_EB_COUNT;
 }
 /*---------------------------------------------------------------------------*/
 
@@ -244,28 +562,43 @@ void dynsched_create_ies_sf_and_link(struct ieee802154_ies *ies0)
 {
 	LOG_INFO("Creating schedule in EB Packet\n");
 	struct tsch_slotframe *sf0 = tsch_schedule_get_slotframe_by_handle(0);
-    struct network_schedules ns = dynsched_get_network_schedules();
-    int i;
+	struct network_schedules *ns = &net_schedules_links;
+	struct tsch_schedule_fragment *frag = &ies0->ie_schedule_fragment;
+	int i;
+
+	if(sf0 == NULL) {
+		return;
+	}
+
+	if(delta_eb_count == 0 && ns->num_links > FRAME802154E_IE_MAX_LINKS) {
+		/* Send the next fragment of the encoded schedule instead */
+		frag->version = stream_version;
+		frag->count = stream_count;
+		frag->index = stream_next;
+		frag->offset = stream_next * DYNSCHED_FRAGMENT_SIZE;
+		frag->len = MIN(DYNSCHED_FRAGMENT_SIZE, stream_len - frag->offset);
+		frag->data = stream + frag->offset;
+		stream_next = (stream_next + 1) % stream_count;
+		return;
+	}
+
+	ies0->ie_tsch_slotframe_and_link.num_slotframes = 1;
+	ies0->ie_tsch_slotframe_and_link.slotframe_handle = sf0->handle;
+	ies0->ie_tsch_slotframe_and_link.slotframe_size = sf0->size.val;
+	ies0->ie_tsch_slotframe_and_link.version = ns->version;
+	ies0->ie_tsch_slotframe_and_link.base_version = ns->version;
+	if(delta_eb_count > 0 && net_schedules_delta.version == ns->version) {
+		/* Send only the links changed since the previous version */
+		delta_eb_count--;
+		ns = &net_schedules_delta;
+		ies0->ie_tsch_slotframe_and_link.base_version = ns->version - 1;
+	}
+	ies0->ie_tsch_slotframe_and_link.num_links = ns->num_links;
 
-   	if(sf0) {
-      	ies0->ie_tsch_slotframe_and_link.num_slotframes = 1;
-      	ies0->ie_tsch_slotframe_and_link.slotframe_handle = sf0->handle;
-     	ies0->ie_tsch_slotframe_and_link.slotframe_size = sf0->size.val;
-      	ies0->ie_tsch_slotframe_and_link.num_links = ns.num_links;
-      
-    	for (i=0; i<ies0->ie_tsch_slotframe_and_link.num_links; i++) {	
-      		/* Populate links from dynamic_schedules struct*/
-      		ies0->ie_tsch_slotframe_and_link.links[i].timeslot = 
-			ns.links[i].timeslot;
-      		ies0->ie_tsch_slotframe_and_link.links[i].channel_offset = 
-			ns.links[i].channel_offset;
-      		ies0->ie_tsch_slotframe_and_link.links[i].link_options = 
-			ns.links[i].link_options;
-      		ies0->ie_tsch_slotframe_and_link.links[i].nodeid = 
-			ns.links[i].nodeid;
-      	}
-    }
-	
+	for (i=0; i<ies0->ie_tsch_slotframe_and_link.num_links; i++) {
+		/* Populate links from dynamic_schedules struct*/
+		ies0->ie_tsch_slotframe_and_link.links[i] = ns->links[i];
+	}
 }
 
 /*---------------------------------------------------------------------------*/
@@ -50,9 +50,35 @@
 #define __DYN_SCHED_H__
 
 
+/* Number of EBs that carry a schedule delta before the coordinator
+ * falls back to sending the complete schedule, for the nodes that
+ * missed the delta */
+#ifdef DYNSCHED_CONF_DELTA_EB_COUNT
+#define DYNSCHED_DELTA_EB_COUNT DYNSCHED_CONF_DELTA_EB_COUNT
+#else
+#define DYNSCHED_DELTA_EB_COUNT 3
+#endif
+
+/* Maximum number of links in the network schedule. Schedules with more
+ * links than fit in the slotframe and link IE are sent in fragments */
+#ifdef DYNSCHED_CONF_MAX_LINKS
+#define DYNSCHED_MAX_LINKS DYNSCHED_CONF_MAX_LINKS
+#else
+#define DYNSCHED_MAX_LINKS 32
+#endif
+
+/* Maximum number of bytes of the encoded schedule carried per EB */
+#ifdef DYNSCHED_CONF_FRAGMENT_SIZE
+#define DYNSCHED_FRAGMENT_SIZE DYNSCHED_CONF_FRAGMENT_SIZE
+#else
+#define DYNSCHED_FRAGMENT_SIZE 48
+#endif
+
 struct network_schedules {
-  uint8_t num_links;
-  struct tsch_slotframe_and_links_link links[FRAME802154E_IE_MAX_LINKS];
+  uint16_t num_links;
+  /* Incremented on every change of the network schedule */
+  uint8_t version;
+  struct tsch_slotframe_and_links_link links[DYNSCHED_MAX_LINKS];
 };
 
 struct network_schedules net_schedules_links;
@@ -61,7 +87,9 @@ struct network_schedules net_schedules_links;
  * RX state and only Coordinator remains in tx state */ 
 extern uint16_t default_ns_arr[DYNSCHED_TSCH_SCHEDULE_DEFAULT_LENGTH][4];
 
-void  dynsched_update_network_schedules(int num_links, uint16_t arr[FRAME802154E_IE_MAX_LINKS][4]);
+/* The schedule arrays below hold num_links rows of {timeslot,
+ * channel offset, link options, node id}, up to DYNSCHED_MAX_LINKS */
+void  dynsched_update_network_schedules(int num_links, uint16_t arr[][4]);
 
 void dynsched_print_network_schedules(void);
 
@@ -73,13 +101,24 @@ void dynsched_create_ies_sf_and_link(struct ieee802154_ies *ies0);
  * \brief Create a schedule based on the array input
  */
 void dynsched_schedule_create_from_array
-(int num_links, uint16_t arr[FRAME802154E_IE_MAX_LINKS][4]);
+(int num_links, uint16_t arr[][4]);
+
+/**
+ * \brief Update the schedule of the coordinator and the network
+ * schedule from the array input. When the slotframe size is unchanged,
+ * only the links that differ are changed, and the EBs carry them as a
+ * delta to the previous schedule version.
+ */
+void dynsched_schedule_update_from_array
+(int num_links, uint16_t arr[][4]);
 
 /**
  * \brief Create a schedule based on the IE recived from EB
+ * \return 1 if the schedule is in sync with the version of the IE,
+ * 0 if the IE holds a delta to a version the node does not have
  */
 
-void dynsched_create_schedule_from_ies(struct ieee802154_ies ies0);
+int dynsched_create_schedule_from_ies(struct ieee802154_ies ies0);
 
 
 #endif /* __DYN_SCHED_H__ */
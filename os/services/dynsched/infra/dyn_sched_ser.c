@@ -46,7 +46,12 @@
 #include "net/mac/tsch/tsch.h"
 #include "dev/serial-line.h"
 #include "dev/leds.h" // Enables use of LEDs
+#include "lib/crc16.h"
 #include "dyn_sched.h"
+#include "dyn_sched_ser.h"
+
+#include <stdio.h>
+#include <string.h>
 
 
 /* Log configuration */
@@ -55,78 +60,295 @@
 #define LOG_LEVEL LOG_LEVEL_INFO
 
 
-/* Serial input string parsing */
-#define SERIAL_STR_START_OF_LINKS 3
-#define SERIAL_STR_NEXT_LINK 11
-
 /* Number of links in the schedule */
 int links_count;
 
 // Initialize default values for serial schedules 
-uint16_t ds_ser[DYNSCHED_TSCH_SCHEDULE_DEFAULT_LENGTH][4] = {
+uint16_t ds_ser[DYNSCHED_MAX_LINKS][4] = {
     {0, 0, 1, 1}, // t_slot:0 ch_off: 0 Link_opt:TX Nodeid: 1 (Coordinator usually)
     {1, 0, 1, 2}, // t_slot:1 ch_off: 0 Link_opt:TX Nodeid: 2
     {2, 0, 1, 3}, // t_slot:2 ch_off: 0 Link_opt:TX Nodeid: 3
 	{3, 0, 1, 4}, // t_slot:3 ch_off: 0 Link_opt:TX Nodeid: 4
 };
 
+#if DYNSCHED_SER_BINARY
+
+/* SLIP special characters */
+#define SLIP_END     0300
+#define SLIP_ESC     0333
+#define SLIP_ESC_END 0334
+#define SLIP_ESC_ESC 0335
+
+/* Function used to send a byte to the Network Manager */
+#ifdef DYNSCHED_SER_CONF_WRITEB
+#define DYNSCHED_SER_WRITEB DYNSCHED_SER_CONF_WRITEB
+#else
+#define DYNSCHED_SER_WRITEB putchar
+#endif
+
+/* Receiver state, shared with the UART interrupt */
+enum {
+	RX_STATE_IDLE,
+	RX_STATE_DATA,
+	RX_STATE_ESC,
+	RX_STATE_DROP,
+	RX_STATE_READY
+};
+static volatile uint8_t rx_state;
+static volatile uint16_t rx_len;
+static uint8_t rx_buf[DYNSCHED_SER_FRAME_SIZE];
+
+/* Ack frame: frame status plus one (id, status) pair per update */
+static uint8_t tx_buf[DYNSCHED_SER_HEADER_LEN + 1 +
+	2 * (DYNSCHED_SER_FRAME_SIZE / DYNSCHED_SER_UPDATE_HEADER_LEN) +
+	DYNSCHED_SER_CRC_LEN];
+
+#endif /* DYNSCHED_SER_BINARY */
+
 /*************************************************************/
 /* Process for serial communication */
 PROCESS(serial_process, "Serial process");
 
+#if DYNSCHED_SER_BINARY
+/*************************************************************/
+/* SLIP decoding of the received bytes, called from the UART driver.
+ * Bytes outside of frames go to the serial-line driver. */
+int dynsched_ser_input_byte(unsigned char c)
+{
+	if (rx_state == RX_STATE_IDLE) {
+		if (c == SLIP_END) {
+			rx_state = RX_STATE_DATA;
+			rx_len = 0;
+			return 0;
+		}
+		return serial_line_input_byte(c);
+	}
+
+	if (rx_state == RX_STATE_READY) {
+		/* The previous frame is not handled yet */
+		return 0;
+	}
+
+	if (c == SLIP_END) {
+		if (rx_state == RX_STATE_DATA && rx_len > 0) {
+			rx_state = RX_STATE_READY;
+			process_poll(&serial_process);
+			return 1;
+		}
+		if (rx_state != RX_STATE_DATA) {
+			/* The end of a frame that was too long or badly escaped */
+			rx_state = RX_STATE_IDLE;
+		}
+		/* Otherwise, the leading END of a frame */
+		return 0;
+	}
+
+	if (rx_state == RX_STATE_DROP) {
+		return 0;
+	}
+	if (rx_state == RX_STATE_ESC) {
+		rx_state = RX_STATE_DATA;
+		if (c == SLIP_ESC_END) {
+			c = SLIP_END;
+		} else if (c == SLIP_ESC_ESC) {
+			c = SLIP_ESC;
+		}
+	} else if (c == SLIP_ESC) {
+		rx_state = RX_STATE_ESC;
+		return 0;
+	}
+
+	if (rx_len == sizeof(rx_buf)) {
+		/* Too long, drop until the next frame */
+		rx_state = RX_STATE_DROP;
+		return 0;
+	}
+	rx_buf[rx_len++] = c;
+	return 0;
+}
+
+/*************************************************************/
+/* SLIP encodes and sends a frame */
+static void send_frame(const uint8_t *buf, int len)
+{
+	DYNSCHED_SER_WRITEB(SLIP_END);
+	while (len-- > 0) {
+		if (*buf == SLIP_END) {
+			DYNSCHED_SER_WRITEB(SLIP_ESC);
+			DYNSCHED_SER_WRITEB(SLIP_ESC_END);
+		} else if (*buf == SLIP_ESC) {
+			DYNSCHED_SER_WRITEB(SLIP_ESC);
+			DYNSCHED_SER_WRITEB(SLIP_ESC_ESC);
+		} else {
+			DYNSCHED_SER_WRITEB(*buf);
+		}
+		buf++;
+	}
+	DYNSCHED_SER_WRITEB(SLIP_END);
+}
+
+/*************************************************************/
+/* Sends the ack of a frame, tx_buf holds len bytes of ack payload */
+static void send_ack(uint8_t seq, uint16_t len)
+{
+	uint16_t crc;
+
+	tx_buf[0] = DYNSCHED_SER_FRAME_ACK;
+	tx_buf[1] = seq;
+	tx_buf[2] = len & 0xff;
+	tx_buf[3] = len >> 8;
+	crc = crc16_data(tx_buf, DYNSCHED_SER_HEADER_LEN + len, 0);
+	tx_buf[DYNSCHED_SER_HEADER_LEN + len] = crc & 0xff;
+	tx_buf[DYNSCHED_SER_HEADER_LEN + len + 1] = crc >> 8;
+	send_frame(tx_buf, DYNSCHED_SER_HEADER_LEN + len + DYNSCHED_SER_CRC_LEN);
+}
+
+/*************************************************************/
+/* Validates one schedule update, and copies it to ds_ser only if all
+ * of its links are valid */
+static uint8_t parse_update(const uint8_t *p, uint8_t num_links)
+{
+	uint16_t ts, nid;
+	uint8_t choff, lo;
+	const uint8_t *link;
+	int i;
+
+	if (num_links == 0 || num_links > DYNSCHED_MAX_LINKS) {
+		return DYNSCHED_SER_STATUS_TOO_MANY;
+	}
+	for (i = 0, link = p; i < num_links; i++, link += DYNSCHED_SER_LINK_LEN) {
+		ts = link[0] | (link[1] << 8);
+		choff = link[2];
+		lo = link[3];
+		nid = link[4] | (link[5] << 8);
+		/* The slotframe is as long as the schedule, and the links are
+		 * packed with 4-bit channel offsets and options and 8-bit ids */
+		if (ts >= num_links || choff > 0x0f || lo == 0 || lo > 0x0f || nid > 0xff) {
+			LOG_ERR("Invalid link %d: ts %u choff %u lo %u nid %u\n",
+					i, ts, choff, lo, nid);
+			return DYNSCHED_SER_STATUS_BAD_LINK;
+		}
+	}
+	for (i = 0, link = p; i < num_links; i++, link += DYNSCHED_SER_LINK_LEN) {
+		ds_ser[i][0] = link[0] | (link[1] << 8);
+		ds_ser[i][1] = link[2];
+		ds_ser[i][2] = link[3];
+		ds_ser[i][3] = link[4] | (link[5] << 8);
+	}
+	return DYNSCHED_SER_STATUS_OK;
+}
+
+/*************************************************************/
+/* Checks a received frame, applies its updates and acks them */
+static void handle_frame(void)
+{
+	const uint8_t *p, *end;
+	uint16_t len, crc, ack_len;
+	uint8_t seq, status, num_links;
+
+	if (rx_len < DYNSCHED_SER_HEADER_LEN + DYNSCHED_SER_CRC_LEN) {
+		LOG_ERR("Serial frame too short (%u)\n", rx_len);
+		return;
+	}
+	seq = rx_buf[1];
+	ack_len = 1;
+
+	crc = rx_buf[rx_len - 2] | (rx_buf[rx_len - 1] << 8);
+	len = rx_buf[2] | (rx_buf[3] << 8);
+	if (crc != crc16_data(rx_buf, rx_len - DYNSCHED_SER_CRC_LEN, 0)) {
+		status = DYNSCHED_SER_STATUS_BAD_CRC;
+	} else if (len != rx_len - DYNSCHED_SER_HEADER_LEN - DYNSCHED_SER_CRC_LEN) {
+		status = DYNSCHED_SER_STATUS_BAD_LEN;
+	} else if (rx_buf[0] != DYNSCHED_SER_FRAME_SCHEDULE) {
+		status = DYNSCHED_SER_STATUS_BAD_TYPE;
+	} else {
+		status = DYNSCHED_SER_STATUS_OK;
+		p = rx_buf + DYNSCHED_SER_HEADER_LEN;
+		end = p + len;
+		while (p < end) {
+			if (end - p < DYNSCHED_SER_UPDATE_HEADER_LEN) {
+				status = DYNSCHED_SER_STATUS_BAD_LEN;
+				break;
+			}
+			num_links = p[1];
+			if (end - p < DYNSCHED_SER_UPDATE_HEADER_LEN
+					+ num_links * DYNSCHED_SER_LINK_LEN) {
+				status = DYNSCHED_SER_STATUS_BAD_LEN;
+				break;
+			}
+			tx_buf[DYNSCHED_SER_HEADER_LEN + ack_len] = p[0];
+			tx_buf[DYNSCHED_SER_HEADER_LEN + ack_len + 1] =
+				parse_update(p + DYNSCHED_SER_UPDATE_HEADER_LEN, num_links);
+			if (tx_buf[DYNSCHED_SER_HEADER_LEN + ack_len + 1] == DYNSCHED_SER_STATUS_OK) {
+				links_count = num_links;
+				LOG_INFO("Schedule update %u with %u links\n", p[0], num_links);
+				// For updating schedule locally (Coordinator) and sending
+				// the changed links over EBs
+				dynsched_schedule_update_from_array(links_count, ds_ser);
+			}
+			ack_len += 2;
+			p += DYNSCHED_SER_UPDATE_HEADER_LEN + num_links * DYNSCHED_SER_LINK_LEN;
+		}
+	}
+
+	if (status != DYNSCHED_SER_STATUS_OK) {
+		LOG_ERR("!! Serial frame %u error %u\n", seq, status);
+	}
+	tx_buf[DYNSCHED_SER_HEADER_LEN] = status;
+	send_ack(seq, ack_len);
+}
+
+#else /* DYNSCHED_SER_BINARY */
 /*************************************************************/
-/* Parse and populate schedule from serial input */
+/* Parse and populate schedule from serial input, of the form
+ * "N<num links> L<row> <ts>,<choff>,<lo>,<nid> ...". The links are
+ * validated into a local array, and copied to ds_ser only if all of
+ * them are valid. */
 static int parse_serial_schedule_input(char* serial_ip)
 {
-	int ds[DYNSCHED_TSCH_SCHEDULE_DEFAULT_LENGTH][4];
-	int match, link;
+	uint16_t ds[DYNSCHED_MAX_LINKS][4];
+	uint8_t seen[DYNSCHED_MAX_LINKS];
+	int match, link, num, len;
 	int row, ts, choff, lo, nid;
-	LOG_INFO("String length: %d\n", strlen(serial_ip));
-	/*
-	for (int k=0; k<6; k++) {
-		LOG_INFO("Data1: %c\n", *serial_ip);
-		serial_ip++;
-	}
-	*/
-	if (*serial_ip == 'N') {
-		LOG_DBG("Start of string identified\n");
-		match = sscanf(serial_ip, "N%d", &links_count);
-		if ((match < 1) || (strlen(serial_ip) < links_count * 11 + 3)) {
-			LOG_ERR("Error in serial string format\n");
+	LOG_INFO("String length: %d\n", (int)strlen(serial_ip));
+
+	match = sscanf(serial_ip, "N%d%n", &num, &len);
+	if (match < 1 || num <= 0 || num > DYNSCHED_MAX_LINKS) {
+		LOG_ERR("Error in serial string format\n");
+		return -1;
+	}
+	LOG_DBG("Start of string identified\n");
+	serial_ip += len; //Bring ptr to start of linkinfo
+	memset(seen, 0, sizeof(seen));
+	for (link = 0; link < num; link++) {
+		match = sscanf(serial_ip, " L%d %d,%d,%d,%d%n",
+						&row, &ts, &choff, &lo, &nid, &len);
+		LOG_DBG("Match:%d\n", match);
+		if (match < 5 || row < 0 || row >= num || seen[row] || ts < 0 || ts >= num
+				|| choff < 0 || choff > 0x0f || lo <= 0 || lo > 0x0f
+				|| nid < 0 || nid > 0xff) {
+			LOG_ERR("Error in serial string: Link %d\n", link);
 			return -1;
 		}
-		serial_ip += SERIAL_STR_START_OF_LINKS;//Bring ptr to start of linkinfo
-		LOG_DBG("Current string:%s", serial_ip);
-		for (link = 0; link<links_count; link++) {
-			match = sscanf(serial_ip, "L%d %d,%d,%d,%d ",
-							&row, &ts, &choff, &lo, &nid);
-			LOG_DBG("Match:%d\n", match);
-			LOG_DBG("row:%d ts:%d choff:%d lo:%d, nid:%d",
-						row, ts, choff, lo, nid);
-			if (!match) {
-				LOG_ERR("Error in serial string: Link %d", link);
-				return -1;
-			}
-			/* If matches are found as per format, populate local array */
-			ds[row][0] = ts;
-			ds[row][1] = choff;
-			ds[row][2] = lo;
-			ds[row][3] = nid;
-			
-			/* Set ptr to next link */
-			serial_ip += SERIAL_STR_NEXT_LINK;
-		}	
-	}
-	
+		LOG_DBG("row:%d ts:%d choff:%d lo:%d, nid:%d\n",
+					row, ts, choff, lo, nid);
+		/* If matches are found as per format, populate local array */
+		seen[row] = 1;
+		ds[row][0] = ts;
+		ds[row][1] = choff;
+		ds[row][2] = lo;
+		ds[row][3] = nid;
+
+		/* Set ptr to next link */
+		serial_ip += len;
+	}
+
 	/* 
  	 * If parsing goes fine, then 
      * Assign ds back to the global variable ds_ser 
 	 */
-	for (int i=0; i<DYNSCHED_TSCH_SCHEDULE_DEFAULT_LENGTH; i++) {
-		for (int j=0; j<4; j++) {
-			ds_ser[i][j] = (uint16_t)ds[i][j];
-		}
-	}
+	memcpy(ds_ser, ds, num * sizeof(ds[0]));
+	links_count = num;
 	return 0;
 }
 
@@ -142,6 +364,7 @@ static void dynsched_print_serial_schedules()
 		/* Fix me: Stop printing default values */
 	}
 }
+#endif /* DYNSCHED_SER_BINARY */
 
 /*************************************************************/
 /* Function to start Serial process */
@@ -154,8 +377,28 @@ void dynsched_start_serial_process()
 /*************************************************************/
 PROCESS_THREAD(serial_process, ev, data)
 {
+#if DYNSCHED_SER_BINARY
+	PROCESS_BEGIN();
+
+	rx_state = RX_STATE_IDLE;
+	rx_len = 0;
+	DYNSCHED_SER_SET_INPUT(dynsched_ser_input_byte);
+
+	while(1) {
+		PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_POLL);
+		if (rx_state == RX_STATE_READY) {
+			handle_frame();
+			rx_len = 0;
+			rx_state = RX_STATE_IDLE;
+		}
+	}
+
+	PROCESS_END();
+#else /* DYNSCHED_SER_BINARY */
 	int status;
 	PROCESS_BEGIN();
+
+	process_subscribe(PROCESS_CURRENT(), serial_line_event_message);
 		
 	while(1) {
     	PROCESS_YIELD();
@@ -168,14 +411,14 @@ PROCESS_THREAD(serial_process, ev, data)
 			continue;
 			}
 			dynsched_print_serial_schedules(); 
-			// For updating schedule locally (Coordinator)
-			dynsched_schedule_create_from_array(links_count, ds_ser);
-			// For sending schedules over EBs
-			dynsched_update_network_schedules(links_count, ds_ser);
+			// For updating schedule locally (Coordinator) and sending
+			// the changed links over EBs
+			dynsched_schedule_update_from_array(links_count, ds_ser);
 		}
 	}
 
 	PROCESS_END();
+#endif /* DYNSCHED_SER_BINARY */
 }
 
 /*************************************************************/
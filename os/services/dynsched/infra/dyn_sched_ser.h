@@ -35,6 +35,77 @@
 #ifndef __DYN_SCHED_SER_H__
 #define __DYN_SCHED_SER_H__
 
+#include "contiki.h"
+
+/*
+ * Binary schedule frames. The Network Manager sends SLIP framed
+ * (RFC 1055) frames of the form
+ *
+ *   type (1) | seq (1) | payload length (2) | payload | CRC16 (2)
+ *
+ * with 16-bit fields in little endian and the CRC16 (lib/crc16) computed
+ * over everything before it. A schedule frame carries a batch of updates:
+ *
+ *   id (1) | num_links (1) | num_links x [ts (2) choff (1) lo (1) nid (2)]
+ *
+ * and is answered by an ack frame with the same seq whose payload is the
+ * frame status followed by one (id, status) pair per update.
+ */
+#define DYNSCHED_SER_FRAME_SCHEDULE   0x01
+#define DYNSCHED_SER_FRAME_ACK        0x02
+
+#define DYNSCHED_SER_HEADER_LEN       4
+#define DYNSCHED_SER_CRC_LEN          2
+#define DYNSCHED_SER_UPDATE_HEADER_LEN 2
+#define DYNSCHED_SER_LINK_LEN         6
+
+/* Status codes, for frames and for each update */
+#define DYNSCHED_SER_STATUS_OK        0
+#define DYNSCHED_SER_STATUS_BAD_CRC   1
+#define DYNSCHED_SER_STATUS_BAD_LEN   2
+#define DYNSCHED_SER_STATUS_BAD_TYPE  3
+#define DYNSCHED_SER_STATUS_TOO_MANY  4
+#define DYNSCHED_SER_STATUS_BAD_LINK  5
+
+/* Maximum length of a decoded frame */
+#ifdef DYNSCHED_SER_CONF_FRAME_SIZE
+#define DYNSCHED_SER_FRAME_SIZE DYNSCHED_SER_CONF_FRAME_SIZE
+#else
+#define DYNSCHED_SER_FRAME_SIZE 256
+#endif
+
+/*
+ * The ASCII serial-line protocol is used by default. The binary
+ * protocol needs its byte handler to be registered with the UART
+ * driver, in place of serial_line_input_byte(). The bytes received
+ * outside of frames are passed on to serial_line_input_byte(), so that
+ * the shell and the other serial-line users keep working.
+ *
+ * The acks are sent on the same output as the log, in between log
+ * lines. The host takes the bytes outside of frames as log output, and
+ * drops the frames that fail the CRC to resynchronize.
+ */
+#ifdef DYNSCHED_SER_CONF_BINARY
+#define DYNSCHED_SER_BINARY DYNSCHED_SER_CONF_BINARY
+#else
+#define DYNSCHED_SER_BINARY 0
+#endif
+
+/* Function used to register the byte input handler with the UART driver */
+#if DYNSCHED_SER_BINARY
+#ifdef DYNSCHED_SER_CONF_SET_INPUT
+#define DYNSCHED_SER_SET_INPUT DYNSCHED_SER_CONF_SET_INPUT
+#elif CONTIKI_TARGET_COOJA
+#include "dev/rs232.h"
+#define DYNSCHED_SER_SET_INPUT rs232_set_input
+#else
+#error DYNSCHED_SER_CONF_BINARY needs DYNSCHED_SER_CONF_SET_INPUT on this platform
+#endif
+#endif /* DYNSCHED_SER_BINARY */
+
 void dynsched_start_serial_process();
 
+/* Passes one byte received on the UART to the binary protocol decoder */
+int dynsched_ser_input_byte(unsigned char c);
+
 #endif /* __DYN_SCHED_SER_H__ */
@@ -0,0 +1,445 @@
+"""
+Host library for the binary serial protocol of Dynamic Scheduling
+
+Schedules are sent to the Coordinator in SLIP framed (RFC 1055) frames:
+
+	type (1) | seq (1) | payload length (2) | payload | CRC16 (2)
+
+A schedule frame carries a batch of updates, each one being
+
+	id (1) | num_links (1) | num_links x [ts (2) choff (1) lo (1) nid (2)]
+
+and the Coordinator answers with an ack frame with the same seq, whose
+payload is the frame status followed by an (id, status) pair per update.
+16-bit fields are little endian, and the CRC16 is the one of Contiki's
+lib/crc16, computed over the whole frame before it.
+
+Bytes received outside of frames are the Coordinator's log output. A
+frame that fails the CRC is taken as log output that was mistaken for a
+frame, and its closing END as the start of the next frame, so that the
+decoder resynchronizes on the next valid frame.
+
+The binary protocol is only used by firmware built with
+DYNSCHED_SER_CONF_BINARY. Other firmware reads schedules as ASCII lines
+
+	N<num_links> L<row> <ts>,<choff>,<lo>,<nid> L<row> ...
+
+which AsciiCoordinator sends, without any ack.
+"""
+
+import json
+import struct
+import threading
+
+FRAME_SCHEDULE = 0x01
+FRAME_ACK = 0x02
+
+HEADER = struct.Struct('<BBH')
+UPDATE_HEADER = struct.Struct('<BB')
+LINK = struct.Struct('<HBBH')
+CRC = struct.Struct('<H')
+
+STATUS_OK = 0
+STATUS_NAMES = {
+	0: 'ok',
+	1: 'bad CRC',
+	2: 'bad length',
+	3: 'bad frame type',
+	4: 'too many links',
+	5: 'invalid link',
+}
+
+# DYNSCHED_SER_FRAME_SIZE
+MAX_FRAME_SIZE = 256
+# DYNSCHED_MAX_LINKS
+MAX_LINKS = 32
+
+LINK_OPTION_TX = 1
+LINK_OPTION_RX = 2
+LINK_OPTION_SHARED = 4
+
+SLIP_END = 0xC0
+SLIP_ESC = 0xDB
+SLIP_ESC_END = 0xDC
+SLIP_ESC_ESC = 0xDD
+
+
+def crc16(data, acc=0):
+	"""
+	CRC16 of data, bit for bit the same as crc16_data() of Contiki
+	"""
+	for b in bytearray(data):
+		acc ^= b
+		acc = ((acc >> 8) | (acc << 8)) & 0xffff
+		acc ^= (acc & 0xff00) << 4
+		acc &= 0xffff
+		acc ^= (acc >> 8) >> 4
+		acc ^= (acc & 0xff00) >> 5
+	return acc
+
+
+def slip_encode(frame):
+	"""
+	SLIP encodes a frame, with a leading END to flush line noise
+	"""
+	out = bytearray([SLIP_END])
+	for b in bytearray(frame):
+		if b == SLIP_END:
+			out += bytearray([SLIP_ESC, SLIP_ESC_END])
+		elif b == SLIP_ESC:
+			out += bytearray([SLIP_ESC, SLIP_ESC_ESC])
+		else:
+			out.append(b)
+	out.append(SLIP_END)
+	return bytes(out)
+
+
+class SlipDecoder:
+	"""
+	Splits the received byte stream into SLIP frames and log text
+	"""
+	def __init__(self):
+		self.frame = None
+		self.esc = False
+		self.text = bytearray()
+		self.lines = []
+
+	def _text(self, data):
+		for b in bytearray(data):
+			if b == ord('\n'):
+				self.lines.append(self.text.decode('ascii', 'replace').rstrip('\r'))
+				self.text = bytearray()
+			else:
+				self.text.append(b)
+
+	def feed(self, data):
+		"""
+		:return: list of (frames, text lines) found in data
+		"""
+		frames = []
+		for b in bytearray(data):
+			if self.frame is None:
+				if b == SLIP_END:
+					self.frame = bytearray()
+				else:
+					self._text([b])
+			elif b == SLIP_END:
+				self.esc = False
+				if not self.frame:
+					# An empty frame is the leading END of the next one
+					continue
+				if unpack_frame(bytes(self.frame)) is None:
+					# Log text taken for a frame: this END starts the next one
+					self._text(self.frame)
+					self.frame = bytearray()
+				else:
+					frames.append(bytes(self.frame))
+					self.frame = None
+			elif self.esc:
+				self.esc = False
+				self.frame.append(SLIP_END if b == SLIP_ESC_END else
+						SLIP_ESC if b == SLIP_ESC_ESC else b)
+			elif b == SLIP_ESC:
+				self.esc = True
+			else:
+				self.frame.append(b)
+		lines, self.lines = self.lines, []
+		return frames, lines
+
+
+class Link:
+	"""
+	A link of the schedule
+	:params ts, choff: Timeslot, Channel offset
+	:params lo, nid: Link options (1=TX/2=RX/4=Shared), NodeID
+	"""
+	def __init__(self, ts, choff, lo, nid):
+		self.timeslot = ts
+		self.channel_offset = choff
+		self.linkopt = lo
+		self.nodeid = nid
+
+	def pack(self):
+		return LINK.pack(self.timeslot, self.channel_offset,
+				self.linkopt, self.nodeid)
+
+	def __repr__(self):
+		return 'Link(ts={}, choff={}, lo={}, nid={})'.format(self.timeslot,
+				self.channel_offset, self.linkopt, self.nodeid)
+
+
+class Schedule:
+	"""
+	A network schedule, i.e. one link per timeslot of the slotframe
+	"""
+	def __init__(self, links, name=None):
+		self.links = list(links)
+		self.name = name
+
+	@property
+	def num_links(self):
+		return len(self.links)
+
+	@classmethod
+	def from_rows(cls, rows, name=None):
+		"""
+		Creates a schedule from [timeslot, channel offset, link option,
+		node id] rows, the format of the arrays used by the firmware
+		"""
+		return cls([Link(*row) for row in rows], name)
+
+	def validate(self):
+		"""
+		Raises ValueError if the Coordinator would reject the schedule
+		"""
+		if not 0 < self.num_links <= MAX_LINKS:
+			raise ValueError('schedule needs 1 to {} links'.format(MAX_LINKS))
+		for link in self.links:
+			if (link.timeslot >= self.num_links or link.channel_offset > 15
+					or not 0 < link.linkopt <= 15 or link.nodeid > 255):
+				raise ValueError('invalid {}'.format(link))
+
+	def pack(self, update_id):
+		return (UPDATE_HEADER.pack(update_id, self.num_links) +
+				b''.join(link.pack() for link in self.links))
+
+	def ascii_line(self):
+		"""
+		:return: the schedule in the ASCII serial-line format
+		"""
+		return 'N{}'.format(self.num_links) + ''.join(
+				' L{} {},{},{},{}'.format(i, link.timeslot, link.channel_offset,
+					link.linkopt, link.nodeid)
+				for i, link in enumerate(self.links)) + '\n'
+
+	def __str__(self):
+		out = 'Number of links: {}\n'.format(self.num_links)
+		for i, link in enumerate(self.links):
+			out += 'Link {}:  Timeslot:{}  Choff:{} Linkopt:{} NodeID:{}\n'.format(
+					i, link.timeslot, link.channel_offset, link.linkopt,
+					link.nodeid)
+		return out
+
+
+def load_schedules(path):
+	"""
+	Loads schedules from a JSON file holding either a list of row
+	arrays, or a list of {"name": ..., "links": rows} objects
+	"""
+	with open(path) as f:
+		entries = json.load(f)
+	schedules = []
+	for i, entry in enumerate(entries):
+		if isinstance(entry, dict):
+			schedules.append(Schedule.from_rows(entry['links'],
+					entry.get('name', 'Schedule {}'.format(i + 1))))
+		else:
+			schedules.append(Schedule.from_rows(entry, 'Schedule {}'.format(i + 1)))
+	return schedules
+
+
+def pack_frame(frame_type, seq, payload):
+	frame = HEADER.pack(frame_type, seq, len(payload)) + payload
+	return frame + CRC.pack(crc16(frame))
+
+
+def unpack_frame(frame):
+	"""
+	:return: (type, seq, payload), or None if the frame is corrupted
+	"""
+	if len(frame) < HEADER.size + CRC.size:
+		return None
+	(crc,) = CRC.unpack(frame[-CRC.size:])
+	if crc != crc16(frame[:-CRC.size]):
+		return None
+	frame_type, seq, length = HEADER.unpack(frame[:HEADER.size])
+	payload = frame[HEADER.size:-CRC.size]
+	if length != len(payload):
+		return None
+	return frame_type, seq, payload
+
+
+class Ack:
+	"""
+	Ack of a schedule frame
+	:param status: Frame status
+	:param updates: dict of update id to update status
+	"""
+	def __init__(self, seq, status, updates):
+		self.seq = seq
+		self.status = status
+		self.updates = updates
+
+	@property
+	def ok(self):
+		return (self.status == STATUS_OK and
+				all(s == STATUS_OK for s in self.updates.values()))
+
+	def __repr__(self):
+		return 'Ack(seq={}, status={}, updates={})'.format(self.seq,
+				STATUS_NAMES.get(self.status, self.status),
+				{k: STATUS_NAMES.get(v, v) for k, v in self.updates.items()})
+
+
+class Coordinator:
+	"""
+	Sends schedules to a Coordinator over a serial port, e.g.
+	serial.Serial('/dev/ttyUSB0', 115200), and matches its acks
+	"""
+	def __init__(self, port, log=None):
+		self.port = port
+		self.log = log
+		self.seq = 0
+		self.update_id = 0
+		self.decoder = SlipDecoder()
+		self.acks = {}
+		self.cond = threading.Condition()
+		self.running = False
+		self.reader = None
+
+	def start(self):
+		"""
+		Starts a thread reading acks and log lines from the port
+		"""
+		self.running = True
+		self.reader = threading.Thread(target=self._read_loop)
+		self.reader.daemon = True
+		self.reader.start()
+
+	def stop(self):
+		self.running = False
+		if self.reader is not None:
+			self.reader.join()
+
+	def _read_loop(self):
+		while self.running:
+			data = self.port.read(max(1, self.port.in_waiting))
+			if data:
+				self.input(data)
+
+	def input(self, data):
+		"""
+		Handles bytes read from the port
+		"""
+		frames, lines = self.decoder.feed(data)
+		for line in lines:
+			if self.log is not None:
+				self.log(line)
+		for frame in frames:
+			unpacked = unpack_frame(frame)
+			if unpacked is None or unpacked[0] != FRAME_ACK or not unpacked[2]:
+				continue
+			_, seq, payload = unpacked
+			payload = bytearray(payload)
+			updates = dict(zip(payload[1::2], payload[2::2]))
+			with self.cond:
+				self.acks[seq] = Ack(seq, payload[0], updates)
+				self.cond.notify_all()
+
+	def batches(self, schedules):
+		"""
+		Splits schedules into payloads that fit in a frame
+		:return: list of lists of (update id, schedule)
+		"""
+		room = MAX_FRAME_SIZE - HEADER.size - CRC.size
+		batches = [[]]
+		used = 0
+		for sch in schedules:
+			sch.validate()
+			size = UPDATE_HEADER.size + sch.num_links * LINK.size
+			if size > room:
+				raise ValueError('schedule does not fit in a frame')
+			if used + size > room:
+				batches.append([])
+				used = 0
+			batches[-1].append((self.update_id, sch))
+			self.update_id = (self.update_id + 1) & 0xff
+			used += size
+		return [b for b in batches if b]
+
+	def send(self, schedules, timeout=2.0, retries=3):
+		"""
+		Sends schedules, batched in as few frames as possible, and
+		resends a frame until it is acked
+		:return: list of Acks, one per frame
+		"""
+		acks = []
+		for batch in self.batches(schedules):
+			payload = b''.join(sch.pack(uid) for uid, sch in batch)
+			seq = self.seq
+			self.seq = (self.seq + 1) & 0xff
+			frame = slip_encode(pack_frame(FRAME_SCHEDULE, seq, payload))
+			ack = None
+			for _ in range(retries):
+				self.port.write(frame)
+				ack = self.wait_ack(seq, timeout)
+				# A corrupted frame is worth sending again, rejected links are not
+				if ack is not None and ack.status not in (1, 2):
+					break
+			if ack is None:
+				raise IOError('no ack for frame {}'.format(seq))
+			acks.append(ack)
+		return acks
+
+	def wait_ack(self, seq, timeout):
+		with self.cond:
+			if seq not in self.acks:
+				self.cond.wait_for(lambda: seq in self.acks, timeout)
+			return self.acks.pop(seq, None)
+
+
+class AsciiCoordinator:
+	"""
+	Sends schedules to a Coordinator that uses the ASCII serial-line
+	protocol, with the same interface as Coordinator. The Coordinator
+	does not ack the schedules, so send() returns no acks.
+	"""
+	def __init__(self, port, log=None):
+		self.port = port
+		self.log = log
+		self.text = bytearray()
+		self.running = False
+		self.reader = None
+
+	def start(self):
+		"""
+		Starts a thread reading log lines from the port
+		"""
+		self.running = True
+		self.reader = threading.Thread(target=self._read_loop)
+		self.reader.daemon = True
+		self.reader.start()
+
+	def stop(self):
+		self.running = False
+		if self.reader is not None:
+			self.reader.join()
+
+	def _read_loop(self):
+		while self.running:
+			data = self.port.read(max(1, self.port.in_waiting))
+			if data:
+				self.input(data)
+
+	def input(self, data):
+		"""
+		Handles bytes read from the port
+		"""
+		for b in bytearray(data):
+			if b == ord('\n'):
+				if self.log is not None:
+					self.log(self.text.decode('ascii', 'replace').rstrip('\r'))
+				self.text = bytearray()
+			else:
+				self.text.append(b)
+
+	def send(self, schedules):
+		"""
+		Sends schedules, one line each
+		:return: an empty list, as there are no acks
+		"""
+		for sch in schedules:
+			sch.validate()
+		for sch in schedules:
+			self.port.write(sch.ascii_line().encode('ascii'))
+		return []
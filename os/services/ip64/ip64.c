@@ -269,42 +269,11 @@ ip64_set_ipv6_address(const uip_ip6addr_t *addr)
 }
 /*---------------------------------------------------------------------------*/
 static uint16_t
-chksum(uint16_t sum, const uint8_t *data, uint16_t len)
-{
-  uint16_t t;
-  const uint8_t *dataptr;
-  const uint8_t *last_byte;
-
-  dataptr = data;
-  last_byte = data + len - 1;
-
-  while(dataptr < last_byte) {	/* At least two more bytes */
-    t = (dataptr[0] << 8) + dataptr[1];
-    sum += t;
-    if(sum < t) {
-      sum++;		/* carry */
-    }
-    dataptr += 2;
-  }
-
-  if(dataptr == last_byte) {
-    t = (dataptr[0] << 8) + 0;
-    sum += t;
-    if(sum < t) {
-      sum++;		/* carry */
-    }
-  }
-
-  /* Return sum in host byte order. */
-  return sum;
-}
-/*---------------------------------------------------------------------------*/
-static uint16_t
 ipv4_checksum(struct ipv4_hdr *hdr)
 {
   uint16_t sum;
 
-  sum = chksum(0, (uint8_t *)hdr, IPV4_HDRLEN);
+  sum = uip_chksum_add(0, (uint8_t *)hdr, IPV4_HDRLEN);
   return (sum == 0) ? 0xffff : uip_htons(sum);
 }
 /*---------------------------------------------------------------------------*/
@@ -323,14 +292,14 @@ ipv4_transport_checksum(const uint8_t *packet, uint16_t len, uint8_t proto)
     /* IP protocol and length fields. This addition cannot carry. */
     sum = transport_layer_len + proto;
     /* Sum IP source and destination addresses. */
-    sum = chksum(sum, (uint8_t *)&v4hdr->srcipaddr, 2 * sizeof(uip_ip4addr_t));
+    sum = uip_chksum_add(sum, (uint8_t *)&v4hdr->srcipaddr, 2 * sizeof(uip_ip4addr_t));
   } else {
     /* ping replies' checksums are calculated over the icmp-part only */
     sum = 0;
   }
 
   /* Sum transport layer header and data. */
-  sum = chksum(sum, &packet[IPV4_HDRLEN], transport_layer_len);
+  sum = uip_chksum_add(sum, &packet[IPV4_HDRLEN], transport_layer_len);
 
   return (sum == 0) ? 0xffff : uip_htons(sum);
 }
@@ -349,15 +318,36 @@ ipv6_transport_checksum(const uint8_t *packet, uint16_t len, uint8_t proto)
   /* IP protocol and length fields. This addition cannot carry. */
   sum = transport_layer_len + proto;
   /* Sum IP source and destination addresses. */
-  sum = chksum(sum, (uint8_t *)&v6hdr->srcipaddr, sizeof(uip_ip6addr_t));
-  sum = chksum(sum, (uint8_t *)&v6hdr->destipaddr, sizeof(uip_ip6addr_t));
+  sum = uip_chksum_add(sum, (uint8_t *)&v6hdr->srcipaddr, sizeof(uip_ip6addr_t));
+  sum = uip_chksum_add(sum, (uint8_t *)&v6hdr->destipaddr, sizeof(uip_ip6addr_t));
 
   /* Sum transport layer header and data. */
-  sum = chksum(sum, &packet[IPV6_HDRLEN], transport_layer_len);
+  sum = uip_chksum_add(sum, &packet[IPV6_HDRLEN], transport_layer_len);
 
   return (sum == 0) ? 0xffff : uip_htons(sum);
 }
 /*---------------------------------------------------------------------------*/
+/* Updates the TCP or UDP checksum of a translated packet for its new
+   pseudo-header addresses and transport header fields (RFC 1624),
+   instead of summing the whole packet again. The pseudo-header length
+   and protocol must be the same before and after the translation. */
+static uint16_t
+transport_checksum_update(uint16_t chksum,
+                          const uint8_t *oldaddrs, uint16_t oldaddrlen,
+                          const uint8_t *oldhdr,
+                          const uint8_t *newaddrs, uint16_t newaddrlen,
+                          const uint8_t *newhdr, uint16_t hdrlen)
+{
+  uint16_t old_sum, new_sum;
+
+  old_sum = uip_chksum_add(0, oldaddrs, oldaddrlen);
+  old_sum = uip_chksum_add(old_sum, oldhdr, hdrlen);
+  new_sum = uip_chksum_add(0, newaddrs, newaddrlen);
+  new_sum = uip_chksum_add(new_sum, newhdr, hdrlen);
+
+  return uip_htons(uip_chksum_adjust(uip_ntohs(chksum), old_sum, new_sum));
+}
+/*---------------------------------------------------------------------------*/
 int
 ip64_6to4(const uint8_t *ipv6packet, const uint16_t ipv6packet_len,
 	  uint8_t *resultpacket)
@@ -425,14 +415,8 @@ ip64_6to4(const uint8_t *ipv6packet, const uint16_t ipv6packet_len,
     PRINTF("ip64_6to4: TCP header\n");
     v4hdr->proto = IP_PROTO_TCP;
 
-    /* Compute and check the TCP checksum - since we're going to
-       recompute it ourselves, we must ensure that it was correct in
-       the first place. */
-    if(ipv6_transport_checksum(ipv6packet, ipv6len,
-                               IP_PROTO_TCP) != 0xffff) {
-      PRINTF("Bad TCP checksum, dropping packet\n");
-    }
-
+    /* The TCP checksum is updated incrementally below, so that it
+       stays invalid if it was invalid in the first place. */
     break;
 
   case IP_PROTO_UDP:
@@ -446,13 +430,13 @@ ip64_6to4(const uint8_t *ipv6packet, const uint16_t ipv6packet_len,
                       ipv6len - IPV6_HDRLEN - sizeof(struct udp_hdr),
                       (uint8_t *)udphdr + sizeof(struct udp_hdr),
                       BUFSIZE - IPV4_HDRLEN - sizeof(struct udp_hdr));
-    }
-    /* Compute and check the UDP checksum - since we're going to
-       recompute it ourselves, we must ensure that it was correct in
-       the first place. */
-    if(ipv6_transport_checksum(ipv6packet, ipv6len,
-                               IP_PROTO_UDP) != 0xffff) {
-      PRINTF("Bad UDP checksum, dropping packet\n");
+      /* Compute and check the UDP checksum - since we're going to
+         recompute it ourselves, we must ensure that it was correct in
+         the first place. */
+      if(ipv6_transport_checksum(ipv6packet, ipv6len,
+                                 IP_PROTO_UDP) != 0xffff) {
+        PRINTF("Bad UDP checksum, dropping packet\n");
+      }
     }
     break;
 
@@ -619,14 +603,31 @@ ip64_6to4(const uint8_t *ipv6packet, const uint16_t ipv6packet_len,
      field. */
   switch(v4hdr->proto) {
   case IP_PROTO_TCP:
-    tcphdr->tcpchksum = 0;
-    tcphdr->tcpchksum = ~(ipv4_transport_checksum(resultpacket, ipv4len,
-						  IP_PROTO_TCP));
+    tcphdr->tcpchksum =
+      transport_checksum_update(tcphdr->tcpchksum,
+                                (uint8_t *)&v6hdr->srcipaddr,
+                                2 * sizeof(uip_ip6addr_t),
+                                &ipv6packet[IPV6_HDRLEN],
+                                (uint8_t *)&v4hdr->srcipaddr,
+                                2 * sizeof(uip_ip4addr_t),
+                                (uint8_t *)tcphdr, 4);
     break;
   case IP_PROTO_UDP:
-    udphdr->udpchksum = 0;
-    udphdr->udpchksum = ~(ipv4_transport_checksum(resultpacket, ipv4len,
-						  IP_PROTO_UDP));
+    if(udphdr->destport == UIP_HTONS(DNS_PORT)) {
+      /* The payload was rewritten by DNS64 */
+      udphdr->udpchksum = 0;
+      udphdr->udpchksum = ~(ipv4_transport_checksum(resultpacket, ipv4len,
+                                                    IP_PROTO_UDP));
+    } else {
+      udphdr->udpchksum =
+        transport_checksum_update(udphdr->udpchksum,
+                                  (uint8_t *)&v6hdr->srcipaddr,
+                                  2 * sizeof(uip_ip6addr_t),
+                                  &ipv6packet[IPV6_HDRLEN],
+                                  (uint8_t *)&v4hdr->srcipaddr,
+                                  2 * sizeof(uip_ip4addr_t),
+                                  (uint8_t *)udphdr, 4);
+    }
     if(udphdr->udpchksum == 0) {
       udphdr->udpchksum = 0xffff;
     }
@@ -854,18 +855,36 @@ ip64_4to6(const uint8_t *ipv4packet, const uint16_t ipv4packet_len,
      field. */
   switch(v6hdr->nxthdr) {
   case IP_PROTO_TCP:
-    tcphdr->tcpchksum = 0;
-    tcphdr->tcpchksum = ~(ipv6_transport_checksum(resultpacket,
-						  ipv6len,
-						  IP_PROTO_TCP));
+    tcphdr->tcpchksum =
+      transport_checksum_update(tcphdr->tcpchksum,
+                                (uint8_t *)&v4hdr->srcipaddr,
+                                2 * sizeof(uip_ip4addr_t),
+                                &ipv4packet[IPV4_HDRLEN],
+                                (uint8_t *)&v6hdr->srcipaddr,
+                                2 * sizeof(uip_ip6addr_t),
+                                (uint8_t *)tcphdr, 4);
     break;
   case IP_PROTO_UDP:
-    udphdr->udpchksum = 0;
     /* As the udplen might have changed (DNS) we need to update it also */
     udphdr->udplen = uip_htons(ipv6_packet_len);
-    udphdr->udpchksum = ~(ipv6_transport_checksum(resultpacket,
-						  ipv6len,
-						  IP_PROTO_UDP));
+    if(udphdr->udpchksum == 0 || udphdr->srcport == UIP_HTONS(DNS_PORT)) {
+      /* The checksum is optional in IPv4 but not in IPv6, and DNS64 may
+         have rewritten the payload */
+      udphdr->udpchksum = 0;
+      udphdr->udpchksum = ~(ipv6_transport_checksum(resultpacket,
+                                                    ipv6len,
+                                                    IP_PROTO_UDP));
+    } else {
+      /* Ports and length */
+      udphdr->udpchksum =
+        transport_checksum_update(udphdr->udpchksum,
+                                  (uint8_t *)&v4hdr->srcipaddr,
+                                  2 * sizeof(uip_ip4addr_t),
+                                  &ipv4packet[IPV4_HDRLEN],
+                                  (uint8_t *)&v6hdr->srcipaddr,
+                                  2 * sizeof(uip_ip6addr_t),
+                                  (uint8_t *)udphdr, 6);
+    }
     if(udphdr->udpchksum == 0) {
       udphdr->udpchksum = 0xffff;
     }
@@ -157,8 +157,12 @@ PROCESS_THREAD(ipso_button_process, ev, data)
 {
   PROCESS_BEGIN();
 
-#if !PLATFORM_SUPPORTS_BUTTON_HAL
+#if PLATFORM_SUPPORTS_BUTTON_HAL
+  process_subscribe(PROCESS_CURRENT(), button_hal_press_event);
+  process_subscribe(PROCESS_CURRENT(), button_hal_release_event);
+#else
   SENSORS_ACTIVATE(IPSO_BUTTON_SENSOR);
+  process_subscribe(PROCESS_CURRENT(), sensors_event);
 #endif
 
   while(1) {
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+/**
+ * \file
+ *         MSF configuration
+ */
+
+#ifndef __MSF_CONF_H__
+#define __MSF_CONF_H__
+
+/* SFID of MSF, as allocated by IANA (RFC 9033) */
+#ifdef MSF_CONF_SFID
+#define MSF_SFID                        MSF_CONF_SFID
+#else /* MSF_CONF_SFID */
+#define MSF_SFID                        0x00
+#endif /* MSF_CONF_SFID */
+
+/* Handle and length of the slotframe holding the negotiated cells */
+#ifdef MSF_CONF_SLOTFRAME_HANDLE
+#define MSF_SLOTFRAME_HANDLE            MSF_CONF_SLOTFRAME_HANDLE
+#else /* MSF_CONF_SLOTFRAME_HANDLE */
+#define MSF_SLOTFRAME_HANDLE            1
+#endif /* MSF_CONF_SLOTFRAME_HANDLE */
+
+#ifdef MSF_CONF_SLOTFRAME_LENGTH
+#define MSF_SLOTFRAME_LENGTH            MSF_CONF_SLOTFRAME_LENGTH
+#else /* MSF_CONF_SLOTFRAME_LENGTH */
+#define MSF_SLOTFRAME_LENGTH            101
+#endif /* MSF_CONF_SLOTFRAME_LENGTH */
+
+/* Maximum number of Tx cells negotiated with the parent. A node keeps at
+ * least one */
+#ifdef MSF_CONF_MAX_NUM_TX_CELLS
+#define MSF_MAX_NUM_TX_CELLS            MSF_CONF_MAX_NUM_TX_CELLS
+#else /* MSF_CONF_MAX_NUM_TX_CELLS */
+#define MSF_MAX_NUM_TX_CELLS            8
+#endif /* MSF_CONF_MAX_NUM_TX_CELLS */
+
+/* Number of candidate cells sent in ADD and RELOCATE requests */
+#ifdef MSF_CONF_NUM_CANDIDATES
+#define MSF_NUM_CANDIDATES              MSF_CONF_NUM_CANDIDATES
+#else /* MSF_CONF_NUM_CANDIDATES */
+#define MSF_NUM_CANDIDATES              5
+#endif /* MSF_CONF_NUM_CANDIDATES */
+
+/* Number of elapsed Tx cells after which their utilization is checked */
+#ifdef MSF_CONF_MAX_NUM_CELLS
+#define MSF_MAX_NUM_CELLS               MSF_CONF_MAX_NUM_CELLS
+#else /* MSF_CONF_MAX_NUM_CELLS */
+#define MSF_MAX_NUM_CELLS               100
+#endif /* MSF_CONF_MAX_NUM_CELLS */
+
+/* Utilization of the Tx cells (in percent) above which a cell is added,
+ * and below which one is deleted */
+#ifdef MSF_CONF_LIM_NUMCELLSUSED_HIGH
+#define MSF_LIM_NUMCELLSUSED_HIGH       MSF_CONF_LIM_NUMCELLSUSED_HIGH
+#else /* MSF_CONF_LIM_NUMCELLSUSED_HIGH */
+#define MSF_LIM_NUMCELLSUSED_HIGH       75
+#endif /* MSF_CONF_LIM_NUMCELLSUSED_HIGH */
+
+#ifdef MSF_CONF_LIM_NUMCELLSUSED_LOW
+#define MSF_LIM_NUMCELLSUSED_LOW        MSF_CONF_LIM_NUMCELLSUSED_LOW
+#else /* MSF_CONF_LIM_NUMCELLSUSED_LOW */
+#define MSF_LIM_NUMCELLSUSED_LOW        25
+#endif /* MSF_CONF_LIM_NUMCELLSUSED_LOW */
+
+/* Transmissions after which the counters of a cell are halved, so that its
+ * PDR follows recent conditions */
+#ifdef MSF_CONF_MAX_NUM_TX
+#define MSF_MAX_NUM_TX                  MSF_CONF_MAX_NUM_TX
+#else /* MSF_CONF_MAX_NUM_TX */
+#define MSF_MAX_NUM_TX                  256
+#endif /* MSF_CONF_MAX_NUM_TX */
+
+/* A cell is relocated when it has seen at least MSF_MIN_NUM_TX transmissions
+ * and its PDR is MSF_RELOCATE_PDR_THRES (in percent) below the best one */
+#ifdef MSF_CONF_MIN_NUM_TX
+#define MSF_MIN_NUM_TX                  MSF_CONF_MIN_NUM_TX
+#else /* MSF_CONF_MIN_NUM_TX */
+#define MSF_MIN_NUM_TX                  16
+#endif /* MSF_CONF_MIN_NUM_TX */
+
+#ifdef MSF_CONF_RELOCATE_PDR_THRES
+#define MSF_RELOCATE_PDR_THRES          MSF_CONF_RELOCATE_PDR_THRES
+#else /* MSF_CONF_RELOCATE_PDR_THRES */
+#define MSF_RELOCATE_PDR_THRES          50
+#endif /* MSF_CONF_RELOCATE_PDR_THRES */
+
+/* Period of the housekeeping, which follows parent switches and checks the
+ * utilization and PDR of the Tx cells */
+#ifdef MSF_CONF_HOUSEKEEPING_PERIOD
+#define MSF_HOUSEKEEPING_PERIOD         MSF_CONF_HOUSEKEEPING_PERIOD
+#else /* MSF_CONF_HOUSEKEEPING_PERIOD */
+#define MSF_HOUSEKEEPING_PERIOD         (10 * CLOCK_SECOND)
+#endif /* MSF_CONF_HOUSEKEEPING_PERIOD */
+
+/* Timeout of 6P transactions */
+#ifdef MSF_CONF_TIMEOUT_INTERVAL
+#define MSF_TIMEOUT_INTERVAL            MSF_CONF_TIMEOUT_INTERVAL
+#else /* MSF_CONF_TIMEOUT_INTERVAL */
+#define MSF_TIMEOUT_INTERVAL            (30 * CLOCK_SECOND)
+#endif /* MSF_CONF_TIMEOUT_INTERVAL */
+
+#endif /* __MSF_CONF_H__ */
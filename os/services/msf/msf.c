@@ -0,0 +1,786 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+/**
+ * \file
+ *         MSF: a scheduling function on top of 6P, after the 6TiSCH Minimal
+ *         Scheduling Function (RFC 9033)
+ */
+
+#include "contiki.h"
+#include "lib/random.h"
+#include "sys/critical.h"
+#include "net/mac/tsch/sixtop/sixp.h"
+#include "net/mac/tsch/sixtop/sixp-nbr.h"
+#include "net/mac/tsch/sixtop/sixp-pkt.h"
+#include "net/mac/tsch/sixtop/sixp-trans.h"
+#include "msf.h"
+
+/* Log configuration */
+#include "sys/log.h"
+#define LOG_MODULE "MSF"
+#define LOG_LEVEL LOG_LEVEL_6TOP
+
+/* Cells are sent as timeslot (2) | channel offset (2), little endian */
+#define CELL_LEN sizeof(sixp_pkt_cell_t)
+/* Metadata, CellOptions, NumCells */
+#define REQ_HDR_LEN 4
+
+/* A Tx cell to the parent, with its transmission statistics. Cells are
+ * kept by timeslot and channel offset rather than by link, as the links
+ * and the slotframe are freed when TSCH resets the schedule */
+struct msf_cell {
+  uint8_t in_use;
+  uint16_t timeslot;
+  uint16_t channel_offset;
+  /* Updated from interrupt, in msf_callback_link_tx_done */
+  volatile uint16_t num_tx;
+  volatile uint16_t num_tx_ack;
+};
+
+static struct msf_cell tx_cells[MSF_MAX_NUM_TX_CELLS];
+static linkaddr_t parent_addr;
+static struct ctimer housekeeping_timer;
+
+/* Transmissions in Tx cells since last_asn, to compute their utilization */
+static volatile uint16_t num_cells_used;
+static struct tsch_asn_t last_asn;
+/* The Tx cell under relocation, if any */
+static struct msf_cell *relocating_cell;
+
+static uint8_t req_storage[REQ_HDR_LEN + (1 + MSF_NUM_CANDIDATES) * CELL_LEN];
+static uint8_t res_storage[MSF_NUM_CANDIDATES * CELL_LEN];
+
+/*---------------------------------------------------------------------------*/
+/* The MSF slotframe, looked up on every use as it is freed when TSCH
+ * resets the schedule, e.g. when associating again */
+static struct tsch_slotframe *
+get_slotframe(void)
+{
+  return tsch_schedule_get_slotframe_by_handle(MSF_SLOTFRAME_HANDLE);
+}
+/*---------------------------------------------------------------------------*/
+static void
+read_cell(const uint8_t *buf, uint16_t *timeslot, uint16_t *channel_offset)
+{
+  *timeslot = buf[0] | (buf[1] << 8);
+  *channel_offset = buf[2] | (buf[3] << 8);
+}
+/*---------------------------------------------------------------------------*/
+static void
+write_cell(uint8_t *buf, uint16_t timeslot, uint16_t channel_offset)
+{
+  buf[0] = timeslot & 0xff;
+  buf[1] = timeslot >> 8;
+  buf[2] = channel_offset & 0xff;
+  buf[3] = channel_offset >> 8;
+}
+/*---------------------------------------------------------------------------*/
+static int
+is_cell_available(struct tsch_slotframe *sf, uint16_t timeslot)
+{
+  return timeslot < MSF_SLOTFRAME_LENGTH
+    && tsch_schedule_get_link_by_timeslot(sf, timeslot) == NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+reset_usage(void)
+{
+  int_master_status_t status = critical_enter();
+  num_cells_used = 0;
+  last_asn = tsch_current_asn;
+  critical_exit(status);
+}
+/*---------------------------------------------------------------------------*/
+int
+msf_get_num_tx_cells(void)
+{
+  int i;
+  int n = 0;
+  for(i = 0; i < MSF_MAX_NUM_TX_CELLS; i++) {
+    if(tx_cells[i].in_use) {
+      n++;
+    }
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+int
+msf_get_num_rx_cells(void)
+{
+  struct tsch_slotframe *sf = get_slotframe();
+  struct tsch_link *l;
+  int n = 0;
+  if(sf == NULL) {
+    return 0;
+  }
+  for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+    if(l->link_options & LINK_OPTION_RX) {
+      n++;
+    }
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+static struct msf_cell *
+find_tx_cell(uint16_t timeslot, uint16_t channel_offset)
+{
+  int i;
+  for(i = 0; i < MSF_MAX_NUM_TX_CELLS; i++) {
+    if(tx_cells[i].in_use
+       && tx_cells[i].timeslot == timeslot
+       && tx_cells[i].channel_offset == channel_offset) {
+      return &tx_cells[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static int
+add_tx_cell(struct tsch_slotframe *sf, uint16_t timeslot, uint16_t channel_offset)
+{
+  int i;
+  for(i = 0; i < MSF_MAX_NUM_TX_CELLS; i++) {
+    if(!tx_cells[i].in_use) {
+      tx_cells[i].timeslot = timeslot;
+      tx_cells[i].channel_offset = channel_offset;
+      tx_cells[i].num_tx = 0;
+      tx_cells[i].num_tx_ack = 0;
+      if(tsch_schedule_add_link(sf, LINK_OPTION_TX, LINK_TYPE_NORMAL,
+                                &parent_addr, timeslot, channel_offset) == NULL) {
+        return -1;
+      }
+      tx_cells[i].in_use = 1;
+      LOG_INFO("added Tx cell %u %u to ", timeslot, channel_offset);
+      LOG_INFO_LLADDR(&parent_addr);
+      LOG_INFO_("\n");
+      return 0;
+    }
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_tx_cell(struct tsch_slotframe *sf, struct msf_cell *c)
+{
+  struct tsch_link *l = tsch_schedule_get_link_by_timeslot(sf, c->timeslot);
+  LOG_INFO("removing Tx cell %u %u\n", c->timeslot, c->channel_offset);
+  c->in_use = 0;
+  if(l != NULL && l->channel_offset == c->channel_offset
+     && (l->link_options & LINK_OPTION_TX)) {
+    tsch_schedule_remove_link(sf, l);
+  }
+  if(c == relocating_cell) {
+    relocating_cell = NULL;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_all_tx_cells(struct tsch_slotframe *sf)
+{
+  int i;
+  for(i = 0; i < MSF_MAX_NUM_TX_CELLS; i++) {
+    if(tx_cells[i].in_use) {
+      remove_tx_cell(sf, &tx_cells[i]);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_rx_cells(struct tsch_slotframe *sf, const linkaddr_t *peer_addr)
+{
+  struct tsch_link *l = list_head(sf->links_list);
+  while(l != NULL) {
+    struct tsch_link *next = list_item_next(l);
+    if((l->link_options & LINK_OPTION_RX) && linkaddr_cmp(&l->addr, peer_addr)) {
+      tsch_schedule_remove_link(sf, l);
+    }
+    l = next;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Writes up to MSF_NUM_CANDIDATES random available cells into buf, and
+ * returns the length written */
+static uint16_t
+create_candidates(struct tsch_slotframe *sf, uint8_t *buf)
+{
+  uint16_t len = 0;
+  int attempts;
+
+  for(attempts = 0;
+      attempts < 4 * MSF_NUM_CANDIDATES && len < MSF_NUM_CANDIDATES * CELL_LEN;
+      attempts++) {
+    /* Leave timeslot 0 to the minimal schedule */
+    uint16_t timeslot = 1 + random_rand() % (MSF_SLOTFRAME_LENGTH - 1);
+    uint16_t channel_offset = random_rand() % tsch_hopping_sequence_length.val;
+    uint16_t i;
+    uint16_t ts;
+    uint16_t choff;
+
+    if(!is_cell_available(sf, timeslot)) {
+      continue;
+    }
+    for(i = 0; i < len; i += CELL_LEN) {
+      read_cell(&buf[i], &ts, &choff);
+      if(ts == timeslot) {
+        break;
+      }
+    }
+    if(i == len) {
+      write_cell(&buf[len], timeslot, channel_offset);
+      len += CELL_LEN;
+    }
+  }
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+static int
+send_request(sixp_pkt_cmd_t cmd, const uint8_t *rel_cell)
+{
+  sixp_pkt_code_t code = (sixp_pkt_code_t)(uint8_t)cmd;
+  uint16_t len;
+  uint16_t cand_len = 0;
+  uint8_t candidates[MSF_NUM_CANDIDATES * CELL_LEN];
+
+  memset(req_storage, 0, sizeof(req_storage));
+
+  if(cmd == SIXP_PKT_CMD_CLEAR) {
+    len = sizeof(sixp_pkt_metadata_t);
+  } else {
+    if(cmd != SIXP_PKT_CMD_DELETE) {
+      cand_len = create_candidates(get_slotframe(), candidates);
+      if(cand_len == 0) {
+        LOG_WARN("no cell available\n");
+        return -1;
+      }
+    }
+    if(sixp_pkt_set_cell_options(SIXP_PKT_TYPE_REQUEST, code,
+                                 SIXP_PKT_CELL_OPTION_TX,
+                                 req_storage, sizeof(req_storage)) != 0
+       || sixp_pkt_set_num_cells(SIXP_PKT_TYPE_REQUEST, code, 1,
+                                 req_storage, sizeof(req_storage)) != 0) {
+      return -1;
+    }
+    len = REQ_HDR_LEN;
+    if(cmd == SIXP_PKT_CMD_ADD) {
+      if(sixp_pkt_set_cell_list(SIXP_PKT_TYPE_REQUEST, code,
+                                candidates, cand_len, 0,
+                                req_storage, sizeof(req_storage)) != 0) {
+        return -1;
+      }
+      len += cand_len;
+    } else if(cmd == SIXP_PKT_CMD_DELETE) {
+      if(sixp_pkt_set_cell_list(SIXP_PKT_TYPE_REQUEST, code,
+                                rel_cell, CELL_LEN, 0,
+                                req_storage, sizeof(req_storage)) != 0) {
+        return -1;
+      }
+      len += CELL_LEN;
+    } else {
+      if(sixp_pkt_set_rel_cell_list(SIXP_PKT_TYPE_REQUEST, code,
+                                    rel_cell, CELL_LEN, 0,
+                                    req_storage, sizeof(req_storage)) != 0
+         || sixp_pkt_set_cand_cell_list(SIXP_PKT_TYPE_REQUEST, code,
+                                        candidates, cand_len, 0,
+                                        req_storage, sizeof(req_storage)) != 0) {
+        return -1;
+      }
+      len += CELL_LEN + cand_len;
+    }
+  }
+
+  LOG_INFO("sending request %u to ", cmd);
+  LOG_INFO_LLADDR(&parent_addr);
+  LOG_INFO_("\n");
+  return sixp_output(SIXP_PKT_TYPE_REQUEST, code, MSF_SFID,
+                     req_storage, len, &parent_addr, NULL, NULL, 0);
+}
+/*---------------------------------------------------------------------------*/
+static int
+request_cell(sixp_pkt_cmd_t cmd, struct msf_cell *c)
+{
+  uint8_t cell[CELL_LEN];
+  int ret;
+
+  if(c != NULL) {
+    write_cell(cell, c->timeslot, c->channel_offset);
+  }
+  ret = send_request(cmd, c != NULL ? cell : NULL);
+  if(ret == 0 && cmd == SIXP_PKT_CMD_RELOCATE) {
+    relocating_cell = c;
+  }
+  return ret;
+}
+/*---------------------------------------------------------------------------*/
+/* The Tx cell with the lowest PDR, and the highest PDR (in percent) */
+static struct msf_cell *
+get_worst_cell(uint16_t *best_pdr, uint16_t *worst_pdr)
+{
+  struct msf_cell *worst = NULL;
+  int i;
+
+  *best_pdr = 0;
+  *worst_pdr = 100;
+  for(i = 0; i < MSF_MAX_NUM_TX_CELLS; i++) {
+    struct msf_cell *c = &tx_cells[i];
+    uint16_t pdr;
+    if(!c->in_use || c->num_tx < MSF_MIN_NUM_TX) {
+      continue;
+    }
+    pdr = (uint32_t)c->num_tx_ack * 100 / c->num_tx;
+    if(pdr > *best_pdr) {
+      *best_pdr = pdr;
+    }
+    if(worst == NULL || pdr < *worst_pdr) {
+      *worst_pdr = pdr;
+      worst = c;
+    }
+  }
+  return worst;
+}
+/*---------------------------------------------------------------------------*/
+static void
+check_tx_cells(void)
+{
+  int num_tx_cells = msf_get_num_tx_cells();
+  uint32_t num_cells_elapsed;
+  struct msf_cell *worst;
+  uint16_t best_pdr;
+  uint16_t worst_pdr;
+
+  if(num_tx_cells == 0) {
+    /* Start with one cell to the parent */
+    request_cell(SIXP_PKT_CMD_ADD, NULL);
+    return;
+  }
+
+  /* Relocate a cell that delivers much worse than the others, e.g. because
+   * it collides with the cell of another pair of nodes */
+  worst = get_worst_cell(&best_pdr, &worst_pdr);
+  if(worst != NULL && worst_pdr + MSF_RELOCATE_PDR_THRES < best_pdr) {
+    LOG_INFO("relocating cell with PDR %u%%, best %u%%\n", worst_pdr, best_pdr);
+    request_cell(SIXP_PKT_CMD_RELOCATE, worst);
+    return;
+  }
+
+  /* Each Tx cell elapses once per slotframe */
+  num_cells_elapsed = (uint32_t)num_tx_cells
+    * TSCH_ASN_DIFF(tsch_current_asn, last_asn) / MSF_SLOTFRAME_LENGTH;
+  if(num_cells_elapsed < MSF_MAX_NUM_CELLS) {
+    return;
+  }
+
+  LOG_INFO("%u cells used out of %lu\n", num_cells_used,
+           (unsigned long)num_cells_elapsed);
+  if((uint32_t)num_cells_used * 100 > num_cells_elapsed * MSF_LIM_NUMCELLSUSED_HIGH) {
+    if(num_tx_cells < MSF_MAX_NUM_TX_CELLS) {
+      request_cell(SIXP_PKT_CMD_ADD, NULL);
+    }
+  } else if((uint32_t)num_cells_used * 100 < num_cells_elapsed * MSF_LIM_NUMCELLSUSED_LOW) {
+    if(num_tx_cells > 1) {
+      /* Delete the cell that delivers worst, if known */
+      if(worst == NULL) {
+        int i;
+        for(i = 0; worst == NULL; i++) {
+          if(tx_cells[i].in_use) {
+            worst = &tx_cells[i];
+          }
+        }
+      }
+      request_cell(SIXP_PKT_CMD_DELETE, worst);
+    }
+  }
+  reset_usage();
+}
+/*---------------------------------------------------------------------------*/
+static void
+housekeeping(void *ptr)
+{
+  struct tsch_neighbor *n = tsch_queue_get_time_source();
+  const linkaddr_t *addr = n != NULL ? &n->addr : &linkaddr_null;
+  struct tsch_slotframe *sf;
+  struct tsch_link *l;
+
+  ctimer_reset(&housekeeping_timer);
+
+  if(!tsch_is_associated) {
+    return;
+  }
+
+  if((sf = get_slotframe()) == NULL) {
+    /* The schedule was reset, e.g. by tsch_schedule_create_minimal() when
+     * associating again: our cells are gone, start over with the parent */
+    LOG_INFO("slotframe removed, re-creating it\n");
+    if((sf = tsch_schedule_add_slotframe(MSF_SLOTFRAME_HANDLE,
+                                         MSF_SLOTFRAME_LENGTH)) == NULL) {
+      return;
+    }
+    memset(tx_cells, 0, sizeof(tx_cells));
+    relocating_cell = NULL;
+    if(!linkaddr_cmp(&parent_addr, &linkaddr_null)
+       && sixp_trans_find(&parent_addr) == NULL) {
+      send_request(SIXP_PKT_CMD_CLEAR, NULL);
+    }
+    linkaddr_copy(&parent_addr, &linkaddr_null);
+    reset_usage();
+    return;
+  }
+
+  /* Drop the Rx cells of neighbors we lost */
+  l = list_head(sf->links_list);
+  while(l != NULL) {
+    struct tsch_link *next = list_item_next(l);
+    if(l->link_options == LINK_OPTION_RX && sixp_nbr_find(&l->addr) == NULL) {
+      remove_rx_cells(sf, &l->addr);
+      /* The list may have changed further down */
+      next = list_head(sf->links_list);
+    }
+    l = next;
+  }
+
+  if(!linkaddr_cmp(addr, &parent_addr)) {
+    /* Parent switch: our cells to the old parent are of no use anymore */
+    if(!linkaddr_cmp(&parent_addr, &linkaddr_null)
+       && sixp_trans_find(&parent_addr) == NULL) {
+      send_request(SIXP_PKT_CMD_CLEAR, NULL);
+    }
+    remove_all_tx_cells(sf);
+    linkaddr_copy(&parent_addr, addr);
+    reset_usage();
+  }
+
+  if(linkaddr_cmp(&parent_addr, &linkaddr_null)
+     || sixp_trans_find(&parent_addr) != NULL) {
+    /* No parent, or a transaction with it is ongoing */
+    return;
+  }
+
+  check_tx_cells();
+}
+/*---------------------------------------------------------------------------*/
+void
+msf_callback_link_tx_done(const struct tsch_link *link, int mac_tx_status)
+{
+  struct msf_cell *c;
+
+  if(link == NULL || link->slotframe_handle != MSF_SLOTFRAME_HANDLE
+     || !(link->link_options & LINK_OPTION_TX)
+     || !linkaddr_cmp(&link->addr, &parent_addr)
+     || (c = find_tx_cell(link->timeslot, link->channel_offset)) == NULL) {
+    return;
+  }
+
+  num_cells_used++;
+  if(c->num_tx >= MSF_MAX_NUM_TX) {
+    c->num_tx /= 2;
+    c->num_tx_ack /= 2;
+  }
+  c->num_tx++;
+  if(mac_tx_status == MAC_TX_OK) {
+    c->num_tx_ack++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Picks up to num_cells available cells out of the candidates, installs them
+ * as Rx cells for the peer and writes them into res_storage */
+static uint16_t
+accept_candidates(struct tsch_slotframe *sf,
+                  const uint8_t *cell_list, uint16_t cell_list_len,
+                  uint8_t num_cells, const linkaddr_t *peer_addr)
+{
+  uint16_t res_len = 0;
+  uint16_t i;
+
+  for(i = 0; i + CELL_LEN <= cell_list_len
+      && res_len < num_cells * CELL_LEN
+      && res_len < sizeof(res_storage); i += CELL_LEN) {
+    uint16_t timeslot;
+    uint16_t channel_offset;
+    read_cell(&cell_list[i], &timeslot, &channel_offset);
+    if(is_cell_available(sf, timeslot)
+       && tsch_schedule_add_link(sf, LINK_OPTION_RX, LINK_TYPE_NORMAL,
+                                 peer_addr, timeslot, channel_offset) != NULL) {
+      memcpy(&res_storage[res_len], &cell_list[i], CELL_LEN);
+      res_len += CELL_LEN;
+    }
+  }
+  return res_len;
+}
+/*---------------------------------------------------------------------------*/
+/* Does the peer have an Rx cell at each of the cells of the list? */
+static int
+are_rx_cells(struct tsch_slotframe *sf,
+             const uint8_t *cell_list, uint16_t cell_list_len,
+             const linkaddr_t *peer_addr)
+{
+  uint16_t i;
+
+  for(i = 0; i + CELL_LEN <= cell_list_len; i += CELL_LEN) {
+    uint16_t timeslot;
+    uint16_t channel_offset;
+    struct tsch_link *l;
+    read_cell(&cell_list[i], &timeslot, &channel_offset);
+    l = timeslot < MSF_SLOTFRAME_LENGTH ? tsch_schedule_get_link_by_timeslot(sf, timeslot) : NULL;
+    if(l == NULL || l->channel_offset != channel_offset
+       || !(l->link_options & LINK_OPTION_RX)
+       || !linkaddr_cmp(&l->addr, peer_addr)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_cells(struct tsch_slotframe *sf,
+             const uint8_t *cell_list, uint16_t cell_list_len)
+{
+  uint16_t i;
+
+  for(i = 0; i + CELL_LEN <= cell_list_len; i += CELL_LEN) {
+    uint16_t timeslot;
+    uint16_t channel_offset;
+    read_cell(&cell_list[i], &timeslot, &channel_offset);
+    if(timeslot < MSF_SLOTFRAME_LENGTH) {
+      tsch_schedule_remove_link_by_timeslot(sf, timeslot);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_response(sixp_pkt_rc_t rc, uint16_t res_len, const linkaddr_t *peer_addr)
+{
+  sixp_output(SIXP_PKT_TYPE_RESPONSE, (sixp_pkt_code_t)(uint8_t)rc, MSF_SFID,
+              res_storage, res_len, peer_addr, NULL, NULL, 0);
+}
+/*---------------------------------------------------------------------------*/
+/* Rx cells are installed and removed when the response is sent rather than
+ * when its transmission completes, so that concurrent transactions with
+ * several children cannot hand out the same cell twice. Cells of a child
+ * that missed the response are dropped when it leaves the neighbor table */
+static void
+request_input(struct tsch_slotframe *sf,
+              sixp_pkt_cmd_t cmd, const uint8_t *body, uint16_t body_len,
+              const linkaddr_t *peer_addr)
+{
+  sixp_pkt_code_t code = (sixp_pkt_code_t)(uint8_t)cmd;
+  sixp_pkt_cell_options_t cell_options;
+  sixp_pkt_num_cells_t num_cells;
+  const uint8_t *cell_list;
+  const uint8_t *rel_cell_list;
+  sixp_pkt_offset_t cell_list_len;
+  sixp_pkt_offset_t rel_cell_list_len;
+  uint16_t res_len;
+
+  if(cmd == SIXP_PKT_CMD_CLEAR) {
+    remove_rx_cells(sf, peer_addr);
+    send_response(SIXP_PKT_RC_SUCCESS, 0, peer_addr);
+    return;
+  }
+
+  if(cmd != SIXP_PKT_CMD_ADD && cmd != SIXP_PKT_CMD_DELETE
+     && cmd != SIXP_PKT_CMD_RELOCATE) {
+    send_response(SIXP_PKT_RC_ERR, 0, peer_addr);
+    return;
+  }
+
+  if(sixp_pkt_get_cell_options(SIXP_PKT_TYPE_REQUEST, code, &cell_options,
+                               body, body_len) != 0
+     || sixp_pkt_get_num_cells(SIXP_PKT_TYPE_REQUEST, code, &num_cells,
+                               body, body_len) != 0) {
+    send_response(SIXP_PKT_RC_ERR, 0, peer_addr);
+    return;
+  }
+  if(cell_options != SIXP_PKT_CELL_OPTION_TX) {
+    /* We only install Rx cells for Tx cells of children */
+    send_response(SIXP_PKT_RC_ERR, 0, peer_addr);
+    return;
+  }
+
+  if(cmd == SIXP_PKT_CMD_RELOCATE) {
+    if(sixp_pkt_get_rel_cell_list(SIXP_PKT_TYPE_REQUEST, code,
+                                  &rel_cell_list, &rel_cell_list_len,
+                                  body, body_len) != 0
+       || sixp_pkt_get_cand_cell_list(SIXP_PKT_TYPE_REQUEST, code,
+                                      &cell_list, &cell_list_len,
+                                      body, body_len) != 0) {
+      send_response(SIXP_PKT_RC_ERR, 0, peer_addr);
+      return;
+    }
+    rel_cell_list_len = MIN(rel_cell_list_len, num_cells * CELL_LEN);
+    if(!are_rx_cells(sf, rel_cell_list, rel_cell_list_len, peer_addr)) {
+      send_response(SIXP_PKT_RC_ERR_CELLLIST, 0, peer_addr);
+      return;
+    }
+    res_len = accept_candidates(sf, cell_list, cell_list_len, num_cells, peer_addr);
+    /* Remove as many relocated cells as were accepted */
+    remove_cells(sf, rel_cell_list, res_len);
+  } else {
+    if(sixp_pkt_get_cell_list(SIXP_PKT_TYPE_REQUEST, code,
+                              &cell_list, &cell_list_len,
+                              body, body_len) != 0) {
+      send_response(SIXP_PKT_RC_ERR, 0, peer_addr);
+      return;
+    }
+    if(cmd == SIXP_PKT_CMD_ADD) {
+      res_len = accept_candidates(sf, cell_list, cell_list_len, num_cells, peer_addr);
+    } else {
+      cell_list_len = MIN(cell_list_len, MIN(num_cells * CELL_LEN, sizeof(res_storage)));
+      if(!are_rx_cells(sf, cell_list, cell_list_len, peer_addr)) {
+        send_response(SIXP_PKT_RC_ERR_CELLLIST, 0, peer_addr);
+        return;
+      }
+      memcpy(res_storage, cell_list, cell_list_len);
+      res_len = cell_list_len;
+      remove_cells(sf, cell_list, cell_list_len);
+    }
+  }
+
+  send_response(SIXP_PKT_RC_SUCCESS, res_len, peer_addr);
+}
+/*---------------------------------------------------------------------------*/
+static void
+response_input(struct tsch_slotframe *sf,
+               sixp_pkt_rc_t rc, const uint8_t *body, uint16_t body_len,
+               const linkaddr_t *peer_addr)
+{
+  sixp_trans_t *trans = sixp_trans_find(peer_addr);
+  sixp_pkt_cmd_t cmd;
+  const uint8_t *cell_list;
+  sixp_pkt_offset_t cell_list_len;
+  uint16_t i;
+
+  if(trans == NULL || !linkaddr_cmp(peer_addr, &parent_addr)) {
+    return;
+  }
+  cmd = sixp_trans_get_cmd(trans);
+
+  if(rc != SIXP_PKT_RC_SUCCESS) {
+    LOG_WARN("request %u failed with rc %u\n", cmd, rc);
+    if(cmd == SIXP_PKT_CMD_RELOCATE) {
+      relocating_cell = NULL;
+    }
+    if(rc == SIXP_PKT_RC_ERR_SEQNUM || rc == SIXP_PKT_RC_ERR_CELLLIST) {
+      /* Our schedules disagree: start over */
+      remove_all_tx_cells(sf);
+      reset_usage();
+    }
+    return;
+  }
+
+  if(cmd == SIXP_PKT_CMD_CLEAR) {
+    return;
+  }
+
+  if(sixp_pkt_get_cell_list(SIXP_PKT_TYPE_RESPONSE,
+                            (sixp_pkt_code_t)(uint8_t)SIXP_PKT_RC_SUCCESS,
+                            &cell_list, &cell_list_len, body, body_len) != 0) {
+    return;
+  }
+
+  for(i = 0; i + CELL_LEN <= cell_list_len; i += CELL_LEN) {
+    uint16_t timeslot;
+    uint16_t channel_offset;
+    struct msf_cell *c;
+    read_cell(&cell_list[i], &timeslot, &channel_offset);
+
+    if(cmd == SIXP_PKT_CMD_DELETE) {
+      if((c = find_tx_cell(timeslot, channel_offset)) != NULL) {
+        remove_tx_cell(sf, c);
+      }
+    } else if(is_cell_available(sf, timeslot)) {
+      if(cmd == SIXP_PKT_CMD_RELOCATE) {
+        if(relocating_cell == NULL) {
+          break;
+        }
+        remove_tx_cell(sf, relocating_cell);
+      }
+      add_tx_cell(sf, timeslot, channel_offset);
+    }
+  }
+  if(cmd == SIXP_PKT_CMD_RELOCATE) {
+    relocating_cell = NULL;
+  }
+  reset_usage();
+}
+/*---------------------------------------------------------------------------*/
+static void
+input(sixp_pkt_type_t type, sixp_pkt_code_t code,
+      const uint8_t *body, uint16_t body_len, const linkaddr_t *src_addr)
+{
+  struct tsch_slotframe *sf = get_slotframe();
+
+  if(sf == NULL || body == NULL || src_addr == NULL) {
+    return;
+  }
+  switch(type) {
+    case SIXP_PKT_TYPE_REQUEST:
+      request_input(sf, code.cmd, body, body_len, src_addr);
+      break;
+    case SIXP_PKT_TYPE_RESPONSE:
+      response_input(sf, code.rc, body, body_len, src_addr);
+      break;
+    default:
+      /* 3-step transactions are not used */
+      break;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+timeout(sixp_pkt_cmd_t cmd, const linkaddr_t *peer_addr)
+{
+  LOG_WARN("request %u timed out\n", cmd);
+  if(cmd == SIXP_PKT_CMD_RELOCATE) {
+    relocating_cell = NULL;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(void)
+{
+  struct tsch_slotframe *sf;
+
+  /* Start from an empty slotframe */
+  if((sf = get_slotframe()) != NULL) {
+    tsch_schedule_remove_slotframe(sf);
+  }
+  memset(tx_cells, 0, sizeof(tx_cells));
+  relocating_cell = NULL;
+  linkaddr_copy(&parent_addr, &linkaddr_null);
+  tsch_schedule_add_slotframe(MSF_SLOTFRAME_HANDLE, MSF_SLOTFRAME_LENGTH);
+  reset_usage();
+  ctimer_set(&housekeeping_timer, MSF_HOUSEKEEPING_PERIOD, housekeeping, NULL);
+}
+/*---------------------------------------------------------------------------*/
+const sixtop_sf_t msf_driver = {
+  MSF_SFID,
+  MSF_TIMEOUT_INTERVAL,
+  init,
+  input,
+  timeout
+};
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+/**
+ * \file
+ *         MSF: a scheduling function on top of 6P, after the 6TiSCH Minimal
+ *         Scheduling Function (RFC 9033). Every node negotiates Tx cells to
+ *         its time source (RPL parent) in a dedicated slotframe. It adds a
+ *         cell when the Tx cells are busy, deletes one when they are idle,
+ *         and relocates a cell whose PDR is much lower than that of the
+ *         others. The parent installs the matching Rx cells.
+ *
+ *         To use it:
+ *           MODULES += os/net/mac/tsch/sixtop os/services/msf
+ *           #define TSCH_CONF_WITH_SIXTOP 1
+ *         and sixtop_add_sf(&msf_driver) at startup.
+ */
+
+#ifndef __MSF_H__
+#define __MSF_H__
+
+#include "net/mac/tsch/tsch.h"
+#include "net/mac/tsch/sixtop/sixtop.h"
+#include "msf-conf.h"
+
+extern const sixtop_sf_t msf_driver;
+
+/* Number of Tx cells negotiated with the parent */
+int msf_get_num_tx_cells(void);
+/* Number of Rx cells installed for children */
+int msf_get_num_rx_cells(void);
+
+/* Set with #define TSCH_CALLBACK_LINK_TX_DONE msf_callback_link_tx_done */
+void msf_callback_link_tx_done(const struct tsch_link *link, int mac_tx_status);
+
+#endif /* __MSF_H__ */
@@ -72,6 +72,48 @@
 #define ORCHESTRA_UNICAST_PERIOD                  17
 #endif /* ORCHESTRA_CONF_UNICAST_PERIOD */
 
+/* Length of the slotframe of the adaptive unicast rule, and maximum number
+ * of extra cells a node listens at. Shorter than ORCHESTRA_UNICAST_PERIOD so
+ * that a single cell already offers more capacity than the unicast slotframe,
+ * which packets to the parent stop using once it has extra cells.
+ * Example configuration with adaptive cells towards the parent:
+ * #define ORCHESTRA_CONF_RULES { &eb_per_time_source, &unicast_adaptive, &unicast_per_neighbor_rpl_ns, &default_common }
+ * #define TSCH_PACKET_CONF_EACK_WITH_LOAD_LEVEL 1 */
+#ifdef ORCHESTRA_CONF_ADAPTIVE_PERIOD
+#define ORCHESTRA_ADAPTIVE_PERIOD                 ORCHESTRA_CONF_ADAPTIVE_PERIOD
+#else /* ORCHESTRA_CONF_ADAPTIVE_PERIOD */
+#define ORCHESTRA_ADAPTIVE_PERIOD                 11
+#endif /* ORCHESTRA_CONF_ADAPTIVE_PERIOD */
+
+#ifdef ORCHESTRA_CONF_ADAPTIVE_MAX_LEVEL
+#define ORCHESTRA_ADAPTIVE_MAX_LEVEL              ORCHESTRA_CONF_ADAPTIVE_MAX_LEVEL
+#else /* ORCHESTRA_CONF_ADAPTIVE_MAX_LEVEL */
+#define ORCHESTRA_ADAPTIVE_MAX_LEVEL              3
+#endif /* ORCHESTRA_CONF_ADAPTIVE_MAX_LEVEL */
+
+/* Period over which the adaptive rule measures the load before updating its level */
+#ifdef ORCHESTRA_CONF_ADAPTIVE_WINDOW
+#define ORCHESTRA_ADAPTIVE_WINDOW                 ORCHESTRA_CONF_ADAPTIVE_WINDOW
+#else /* ORCHESTRA_CONF_ADAPTIVE_WINDOW */
+#define ORCHESTRA_ADAPTIVE_WINDOW                 (30 * CLOCK_SECOND)
+#endif /* ORCHESTRA_CONF_ADAPTIVE_WINDOW */
+
+/* Utilization of the Rx cells (in percent) above which the adaptive rule adds
+ * a cell, and below which it removes one. A cell is also added above the low
+ * threshold when the share of received frames with the frame pending bit
+ * is above the high threshold */
+#ifdef ORCHESTRA_CONF_ADAPTIVE_HIGH_LOAD
+#define ORCHESTRA_ADAPTIVE_HIGH_LOAD              ORCHESTRA_CONF_ADAPTIVE_HIGH_LOAD
+#else /* ORCHESTRA_CONF_ADAPTIVE_HIGH_LOAD */
+#define ORCHESTRA_ADAPTIVE_HIGH_LOAD              70
+#endif /* ORCHESTRA_CONF_ADAPTIVE_HIGH_LOAD */
+
+#ifdef ORCHESTRA_CONF_ADAPTIVE_LOW_LOAD
+#define ORCHESTRA_ADAPTIVE_LOW_LOAD               ORCHESTRA_CONF_ADAPTIVE_LOW_LOAD
+#else /* ORCHESTRA_CONF_ADAPTIVE_LOW_LOAD */
+#define ORCHESTRA_ADAPTIVE_LOW_LOAD               30
+#endif /* ORCHESTRA_CONF_ADAPTIVE_LOW_LOAD */
+
 /* Is the per-neighbor unicast slotframe sender-based (if not, it is receiver-based).
  * Note: sender-based works only with RPL storing mode as it relies on DAO and
  * routing entries to keep track of children and parents. */
@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+/**
+ * \file
+ *         Orchestra: a receiver-based slotframe with extra unicast cells that
+ *         follow the load of the receiver. Each node computes a load level from
+ *         the frames it ACKs at its unicast cells in every
+ *         ORCHESTRA_ADAPTIVE_WINDOW, and listens at one cell per level:
+ *           (hash(MAC) + i * ORCHESTRA_ADAPTIVE_PERIOD / ORCHESTRA_ADAPTIVE_MAX_LEVEL)
+ *             % ORCHESTRA_ADAPTIVE_PERIOD, for i < level
+ *         The level is sent in the enhanced ACKs (requires
+ *         TSCH_PACKET_CONF_EACK_WITH_LOAD_LEVEL), so that children compute the
+ *         same cells from their parent's MAC and level, and transmit there.
+ *         Must be listed right before the unicast rule, as it takes over the
+ *         packets to the parent while the parent has a non-zero level, and
+ *         counts the frames received in the unicast rule's slotframe while
+ *         its own level is zero.
+ */
+
+#include "contiki.h"
+#include "orchestra.h"
+#include "net/packetbuf.h"
+#include "sys/critical.h"
+
+#define ADAPTIVE_CELL_SPACING (ORCHESTRA_ADAPTIVE_PERIOD / ORCHESTRA_ADAPTIVE_MAX_LEVEL)
+
+#if ADAPTIVE_CELL_SPACING == 0
+#error "ORCHESTRA_ADAPTIVE_MAX_LEVEL must not exceed ORCHESTRA_ADAPTIVE_PERIOD"
+#endif
+
+static uint16_t slotframe_handle = 0;
+/* The slotframe of the unicast rule, listed right after this one */
+static uint16_t unicast_slotframe_handle = 0;
+static uint16_t channel_offset = 0;
+static struct tsch_slotframe *sf_adaptive;
+
+/* Our level, i.e. the number of cells we listen at */
+static uint8_t rx_level;
+/* Our level in the previous window. We keep listening at its cells for a
+ * window after lowering the level, for children that did not notice yet */
+static uint8_t rx_level_prev;
+/* Frames we ACKed at our cells in the current window, and those of them with
+ * the frame pending bit set, i.e. sent from a backlogged queue. Updated from
+ * interrupt */
+static volatile uint16_t rx_frames;
+static volatile uint16_t rx_pending_frames;
+
+/* Our time source, and the level it sent in its last enhanced ACK */
+static linkaddr_t parent_linkaddr;
+static volatile uint8_t parent_level;
+/* The parent and parent level our Tx cells are installed for */
+static linkaddr_t tx_linkaddr;
+static uint8_t tx_level;
+/* The Tx cells of a previous parent or level. Packets queued for our cells
+ * can only be sent at them, so we keep them until the queue to that parent
+ * is empty, checked at the end of every window */
+static linkaddr_t tx_prev_linkaddr;
+static uint8_t tx_level_prev;
+
+PROCESS(orchestra_adaptive_process, "Orchestra adaptive");
+
+/*---------------------------------------------------------------------------*/
+static uint16_t
+get_cell_timeslot(const linkaddr_t *addr, uint8_t i)
+{
+  return (ORCHESTRA_LINKADDR_HASH(addr) + i * ADAPTIVE_CELL_SPACING) % ORCHESTRA_ADAPTIVE_PERIOD;
+}
+/*---------------------------------------------------------------------------*/
+static int
+is_cell(const linkaddr_t *addr, uint8_t level, uint16_t timeslot)
+{
+  uint8_t i;
+  for(i = 0; i < level; i++) {
+    if(get_cell_timeslot(addr, i) == timeslot) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+update_cells(void)
+{
+  uint16_t ts;
+  uint8_t rx_cells = MAX(rx_level, rx_level_prev);
+  uint8_t level = linkaddr_cmp(&parent_linkaddr, &linkaddr_null) ? 0 : parent_level;
+
+  if(tx_level > 0
+     && (level < tx_level || !linkaddr_cmp(&tx_linkaddr, &parent_linkaddr))) {
+    /* Cells are removed: keep them for the packets already queued */
+    if(!linkaddr_cmp(&tx_prev_linkaddr, &tx_linkaddr)) {
+      linkaddr_copy(&tx_prev_linkaddr, &tx_linkaddr);
+      tx_level_prev = 0;
+    }
+    tx_level_prev = MAX(tx_level_prev, tx_level);
+  }
+  linkaddr_copy(&tx_linkaddr, &parent_linkaddr);
+  tx_level = level;
+  if(linkaddr_cmp(&tx_prev_linkaddr, &tx_linkaddr) && tx_level >= tx_level_prev) {
+    /* The current cells include the previous ones */
+    tx_level_prev = 0;
+  }
+
+  for(ts = 0; ts < ORCHESTRA_ADAPTIVE_PERIOD; ts++) {
+    uint8_t link_options = 0;
+    struct tsch_link *l = tsch_schedule_get_link_by_timeslot(sf_adaptive, ts);
+
+    if(is_cell(&linkaddr_node_addr, rx_cells, ts)) {
+      link_options |= LINK_OPTION_RX;
+    }
+    if(is_cell(&tx_linkaddr, tx_level, ts)
+       || is_cell(&tx_prev_linkaddr, tx_level_prev, ts)) {
+      link_options |= LINK_OPTION_TX | LINK_OPTION_SHARED;
+    }
+
+    if(l != NULL && l->link_options == link_options) {
+      continue;
+    }
+    if(link_options == 0) {
+      if(l != NULL) {
+        tsch_schedule_remove_link(sf_adaptive, l);
+      }
+    } else {
+      /* Add/update link */
+      tsch_schedule_add_link(sf_adaptive, link_options, LINK_TYPE_NORMAL,
+          &tsch_broadcast_address, ts, channel_offset);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+update_level(void)
+{
+  uint32_t slots;
+  uint32_t cell_slots;
+  uint32_t capacity;
+  uint16_t rx;
+  uint16_t rx_pending;
+  int_master_status_t status;
+
+  status = critical_enter();
+  rx = rx_frames;
+  rx_pending = rx_pending_frames;
+  rx_frames = 0;
+  rx_pending_frames = 0;
+  critical_exit(status);
+
+  /* Timeslots in a window, and occurrences of a given cell in a window */
+  slots = (uint32_t)(ORCHESTRA_ADAPTIVE_WINDOW / CLOCK_SECOND)
+    * (RTIMER_SECOND / tsch_timing[tsch_ts_timeslot_length]);
+  cell_slots = slots / ORCHESTRA_ADAPTIVE_PERIOD;
+  /* At level 0, children use the unicast slotframe */
+  capacity = rx_level > 0 ? rx_level * cell_slots : slots / ORCHESTRA_UNICAST_PERIOD;
+
+  rx_level_prev = rx_level;
+  if(rx_level < ORCHESTRA_ADAPTIVE_MAX_LEVEL
+     && ((uint32_t)rx * 100 > capacity * ORCHESTRA_ADAPTIVE_HIGH_LOAD
+         || ((uint32_t)rx * 100 > capacity * ORCHESTRA_ADAPTIVE_LOW_LOAD
+             && (uint32_t)rx_pending * 100 > (uint32_t)rx * ORCHESTRA_ADAPTIVE_HIGH_LOAD))) {
+    /* The cells are busy, or fairly busy with senders that have more to send */
+    rx_level++;
+  } else if(rx_level > 0) {
+    /* Would the load still be low with one cell less? */
+    capacity = rx_level > 1 ? (rx_level - 1) * cell_slots : slots / ORCHESTRA_UNICAST_PERIOD;
+    if((uint32_t)rx * 100 < capacity * ORCHESTRA_ADAPTIVE_LOW_LOAD) {
+      rx_level--;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+update_tx_prev(void)
+{
+  struct tsch_neighbor *n;
+
+  if(tx_level_prev > 0) {
+    n = tsch_queue_get_nbr(&tx_prev_linkaddr);
+    if(n == NULL || tsch_queue_is_empty(n)) {
+      tx_level_prev = 0;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(orchestra_adaptive_process, ev, data)
+{
+  static struct etimer et;
+
+  PROCESS_BEGIN();
+
+  etimer_set(&et, ORCHESTRA_ADAPTIVE_WINDOW);
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL
+                             || (ev == PROCESS_EVENT_TIMER && data == &et));
+    if(ev == PROCESS_EVENT_TIMER) {
+      update_level();
+      update_tx_prev();
+      etimer_reset(&et);
+    }
+    update_cells();
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+orchestra_callback_eack_load_level(const struct tsch_link *link,
+                                   const linkaddr_t *src, int frame_pending)
+{
+  /* Only count the frames sent to us at the cells our load level is
+   * computed for: ours, or those of the unicast rule at level 0 */
+  if(link != NULL && link->slotframe_handle
+     == (rx_level > 0 ? slotframe_handle : unicast_slotframe_handle)) {
+    rx_frames++;
+    if(frame_pending) {
+      rx_pending_frames++;
+    }
+  }
+  return rx_level;
+}
+/*---------------------------------------------------------------------------*/
+void
+orchestra_callback_load_level_received(const linkaddr_t *addr, uint8_t level)
+{
+  level = MIN(level, ORCHESTRA_ADAPTIVE_MAX_LEVEL);
+  if(level != parent_level && linkaddr_cmp(addr, &parent_linkaddr)) {
+    parent_level = level;
+    process_poll(&orchestra_adaptive_process);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+select_packet(uint16_t *slotframe, uint16_t *timeslot)
+{
+  /* Select data packets to our parent, if it has extra cells */
+  const linkaddr_t *dest = packetbuf_addr(PACKETBUF_ADDR_RECEIVER);
+  if(tx_level > 0
+     && packetbuf_attr(PACKETBUF_ATTR_FRAME_TYPE) == FRAME802154_DATAFRAME
+     && linkaddr_cmp(dest, &tx_linkaddr)) {
+    if(slotframe != NULL) {
+      *slotframe = slotframe_handle;
+    }
+    if(timeslot != NULL) {
+      *timeslot = 0xffff;
+    }
+    return 1;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+new_time_source(const struct tsch_neighbor *old, const struct tsch_neighbor *new)
+{
+  if(new != old) {
+    /* Wait for the level of the new parent */
+    linkaddr_copy(&parent_linkaddr, new != NULL ? &new->addr : &linkaddr_null);
+    parent_level = 0;
+    update_cells();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(uint16_t sf_handle)
+{
+  slotframe_handle = sf_handle;
+  unicast_slotframe_handle = sf_handle + 1;
+  channel_offset = sf_handle;
+  linkaddr_copy(&parent_linkaddr, &linkaddr_null);
+  linkaddr_copy(&tx_linkaddr, &linkaddr_null);
+  linkaddr_copy(&tx_prev_linkaddr, &linkaddr_null);
+  /* Slotframe for the extra unicast cells, empty until there is some load */
+  sf_adaptive = tsch_schedule_add_slotframe(slotframe_handle, ORCHESTRA_ADAPTIVE_PERIOD);
+  process_start(&orchestra_adaptive_process, NULL);
+}
+/*---------------------------------------------------------------------------*/
+struct orchestra_rule unicast_adaptive = {
+  init,
+  new_time_source,
+  select_packet,
+  NULL,
+  NULL,
+};
@@ -50,10 +50,11 @@ struct orchestra_rule {
   void (* child_removed)(const linkaddr_t *addr);
 };
 
-struct orchestra_rule eb_per_time_source;
-struct orchestra_rule unicast_per_neighbor_rpl_storing;
-struct orchestra_rule unicast_per_neighbor_rpl_ns;
-struct orchestra_rule default_common;
+extern struct orchestra_rule eb_per_time_source;
+extern struct orchestra_rule unicast_per_neighbor_rpl_storing;
+extern struct orchestra_rule unicast_per_neighbor_rpl_ns;
+extern struct orchestra_rule default_common;
+extern struct orchestra_rule unicast_adaptive;
 
 extern linkaddr_t orchestra_parent_linkaddr;
 extern int orchestra_parent_knows_us;
@@ -69,5 +70,10 @@ void orchestra_callback_new_time_source(const struct tsch_neighbor *old, const s
 void orchestra_callback_child_added(const linkaddr_t *addr);
 /* Set with #define NETSTACK_CONF_ROUTING_NEIGHBOR_REMOVED_CALLBACK orchestra_callback_child_removed */
 void orchestra_callback_child_removed(const linkaddr_t *addr);
+/* Set with #define TSCH_CALLBACK_EACK_LOAD_LEVEL orchestra_callback_eack_load_level */
+uint8_t orchestra_callback_eack_load_level(const struct tsch_link *link,
+                                           const linkaddr_t *src, int frame_pending);
+/* Set with #define TSCH_CALLBACK_LOAD_LEVEL_RECEIVED orchestra_callback_load_level_received */
+void orchestra_callback_load_level_received(const linkaddr_t *addr, uint8_t level);
 
 #endif /* __ORCHESTRA_H__ */
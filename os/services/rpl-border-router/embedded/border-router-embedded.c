@@ -72,8 +72,11 @@ PROCESS_THREAD(border_router_process, ev, data)
 
   PROCESS_PAUSE();
 
-#if !PLATFORM_SUPPORTS_BUTTON_HAL
+#if PLATFORM_SUPPORTS_BUTTON_HAL
+  process_subscribe(PROCESS_CURRENT(), button_hal_release_event);
+#else
   SENSORS_ACTIVATE(button_sensor);
+  process_subscribe(PROCESS_CURRENT(), sensors_event);
 #endif
 
   LOG_INFO("RPL-Border router started\n");
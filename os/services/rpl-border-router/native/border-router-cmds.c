@@ -231,6 +231,7 @@ PROCESS_THREAD(border_router_cmd_process, ev, data)
   PROCESS_BEGIN();
 
   shell_init();
+  process_subscribe(PROCESS_CURRENT(), serial_line_event_message);
 
   while(1) {
     PROCESS_YIELD();
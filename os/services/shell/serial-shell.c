@@ -62,6 +62,7 @@ PROCESS_THREAD(serial_shell_process, ev, data)
   PROCESS_BEGIN();
 
   shell_init();
+  process_subscribe(PROCESS_CURRENT(), serial_line_event_message);
 
   while(1) {
     static struct pt shell_input_pt;
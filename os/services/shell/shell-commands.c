@@ -611,6 +611,58 @@ PT_THREAD(cmd_tsch_status(struct pt *pt, shell_output_func output, char *args))
 
   PT_END(pt);
 }
+#if TSCH_PROFILE_ON
+/*---------------------------------------------------------------------------*/
+static
+PT_THREAD(cmd_tsch_profile(struct pt *pt, shell_output_func output, char *args))
+{
+  static uint8_t dump[TSCH_PROFILE_DUMP_SIZE];
+  struct tsch_profile_histogram h;
+  uint32_t timer_misses;
+  int metric;
+  int i;
+  int len;
+  char *next_args;
+
+  PT_BEGIN(pt);
+
+  SHELL_ARGS_INIT(args, next_args);
+
+  /* Get first arg (reset/dump) */
+  SHELL_ARGS_NEXT(args, next_args);
+
+  if(args != NULL && !strcmp(args, "reset")) {
+    tsch_profile_reset();
+    SHELL_OUTPUT(output, "TSCH profile reset\n");
+  } else if(args != NULL && !strcmp(args, "dump")) {
+    len = tsch_profile_dump(dump, sizeof(dump));
+    SHELL_OUTPUT(output, "TSCH profile dump, %d bytes:\n", len);
+    for(i = 0; i < len; i++) {
+      SHELL_OUTPUT(output, "%02x%s", dump[i], (i % 32 == 31 || i == len - 1) ? "\n" : "");
+    }
+  } else if(args == NULL) {
+    timer_misses = tsch_profile_get(TSCH_PROFILE_SLOT, NULL);
+    SHELL_OUTPUT(output, "TSCH profile (us, bucket i < 2^i):\n");
+    SHELL_OUTPUT(output, "-- Timer misses: %lu\n", (unsigned long)timer_misses);
+    for(metric = 0; metric < TSCH_PROFILE_NUM_METRICS; metric++) {
+      tsch_profile_get(metric, &h);
+      SHELL_OUTPUT(output, "-- %s: count %lu, min %lu, avg %lu, max %lu\n",
+                   tsch_profile_metric_name(metric), (unsigned long)h.count,
+                   (unsigned long)h.min,
+                   (unsigned long)(h.count ? h.sum / h.count : 0), (unsigned long)h.max);
+      SHELL_OUTPUT(output, "  ");
+      for(i = 0; i < TSCH_PROFILE_NUM_BUCKETS; i++) {
+        SHELL_OUTPUT(output, " %lu", (unsigned long)h.buckets[i]);
+      }
+      SHELL_OUTPUT(output, "\n");
+    }
+  } else {
+    SHELL_OUTPUT(output, "Invalid argument: %s\n", args);
+  }
+
+  PT_END(pt);
+}
+#endif /* TSCH_PROFILE_ON */
 #endif /* MAC_CONF_WITH_TSCH */
 #if NETSTACK_CONF_WITH_IPV6
 /*---------------------------------------------------------------------------*/
@@ -893,6 +945,9 @@ const struct shell_command_t builtin_shell_commands[] = {
   { "tsch-set-coordinator", cmd_tsch_set_coordinator, "'> tsch-set-coordinator 0/1 [0/1]': Sets node as coordinator (1) or not (0). Second, optional parameter: enable (1) or disable (0) security." },
   { "tsch-schedule",        cmd_tsch_schedule,        "'> tsch-schedule': Shows the current TSCH schedule" },
   { "tsch-status",          cmd_tsch_status,          "'> tsch-status': Shows a summary of the current TSCH state" },
+#if TSCH_PROFILE_ON
+  { "tsch-profile",         cmd_tsch_profile,         "'> tsch-profile [reset|dump]': Shows the TSCH slot timing histograms, clears them, or prints their binary dump in hex" },
+#endif /* TSCH_PROFILE_ON */
 #endif /* MAC_CONF_WITH_TSCH */
 #if TSCH_WITH_SIXTOP
   { "6top",                 cmd_6top,                 "'> 6top help': Shows 6top command usage" },
@@ -46,6 +46,10 @@
 #include "contiki.h"
 #include "lib/list.h"
 
+#include <stddef.h>
+
+/* Callback timers set before ctimer_process has started. Once it
+   has, the timers are only kept by the event timer module. */
 LIST(ctimer_list);
 
 static char initialized;
@@ -63,31 +67,45 @@ PROCESS(ctimer_process, "Ctimer process");
 PROCESS_THREAD(ctimer_process, ev, data)
 {
   struct ctimer *c;
+#if ETIMER_WITH_SLACK
+  clock_time_t slack;
+#endif /* ETIMER_WITH_SLACK */
   PROCESS_BEGIN();
 
   for(c = list_head(ctimer_list); c != NULL; c = c->next) {
+#if ETIMER_WITH_SLACK
+    slack = c->etimer.slack;
+    etimer_set(&c->etimer, c->etimer.timer.interval);
+    etimer_set_slack(&c->etimer, slack);
+#else /* ETIMER_WITH_SLACK */
     etimer_set(&c->etimer, c->etimer.timer.interval);
+#endif /* ETIMER_WITH_SLACK */
   }
+  list_init(ctimer_list);
   initialized = 1;
 
+  /* Expired callback timers are run directly by the event timer
+     module, see ctimer_run(). The process only owns their etimers. */
   while(1) {
-    PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_TIMER);
-    for(c = list_head(ctimer_list); c != NULL; c = c->next) {
-      if(&c->etimer == data) {
-	list_remove(ctimer_list, c);
-	PROCESS_CONTEXT_BEGIN(c->p);
-	if(c->f != NULL) {
-	  c->f(c->ptr);
-	}
-	PROCESS_CONTEXT_END(c->p);
-	break;
-      }
-    }
+    PROCESS_YIELD();
   }
   PROCESS_END();
 }
 /*---------------------------------------------------------------------------*/
 void
+ctimer_run(struct etimer *et)
+{
+  struct ctimer *c;
+
+  c = (struct ctimer *)((char *)et - offsetof(struct ctimer, etimer));
+  PROCESS_CONTEXT_BEGIN(c->p);
+  if(c->f != NULL) {
+    c->f(c->ptr);
+  }
+  PROCESS_CONTEXT_END(c->p);
+}
+/*---------------------------------------------------------------------------*/
+void
 ctimer_init(void)
 {
   initialized = 0;
@@ -116,9 +134,11 @@ ctimer_set_with_process(struct ctimer *c, clock_time_t t,
     PROCESS_CONTEXT_END(&ctimer_process);
   } else {
     c->etimer.timer.interval = t;
+#if ETIMER_WITH_SLACK
+    c->etimer.slack = 0;
+#endif /* ETIMER_WITH_SLACK */
+    list_add(ctimer_list, c);
   }
-
-  list_add(ctimer_list, c);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -128,9 +148,9 @@ ctimer_reset(struct ctimer *c)
     PROCESS_CONTEXT_BEGIN(&ctimer_process);
     etimer_reset(&c->etimer);
     PROCESS_CONTEXT_END(&ctimer_process);
+  } else {
+    list_add(ctimer_list, c);
   }
-
-  list_add(ctimer_list, c);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -140,10 +160,22 @@ ctimer_restart(struct ctimer *c)
     PROCESS_CONTEXT_BEGIN(&ctimer_process);
     etimer_restart(&c->etimer);
     PROCESS_CONTEXT_END(&ctimer_process);
+  } else {
+    list_add(ctimer_list, c);
+  }
+}
+/*---------------------------------------------------------------------------*/
+#if ETIMER_WITH_SLACK
+void
+ctimer_set_slack(struct ctimer *c, clock_time_t slack)
+{
+  if(initialized) {
+    etimer_set_slack(&c->etimer, slack);
+  } else {
+    c->etimer.slack = slack;
   }
-
-  list_add(ctimer_list, c);
 }
+#endif /* ETIMER_WITH_SLACK */
 /*---------------------------------------------------------------------------*/
 void
 ctimer_stop(struct ctimer *c)
@@ -153,8 +185,8 @@ ctimer_stop(struct ctimer *c)
   } else {
     c->etimer.next = NULL;
     c->etimer.p = PROCESS_NONE;
+    list_remove(ctimer_list, c);
   }
-  list_remove(ctimer_list, c);
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -155,6 +155,34 @@ void ctimer_stop(struct ctimer *c);
  */
 int ctimer_expired(struct ctimer *c);
 
+/**
+ * \brief      Set the tolerated expiration delay of a callback timer
+ * \param c    A pointer to the callback timer.
+ * \param slack The number of clock ticks the timer may expire after
+ *             its deadline.
+ *
+ *             Callback timers are kept together with the event
+ *             timers, so a callback timer with a slack is expired
+ *             together with any event or callback timer due within
+ *             that window. The slack is cleared by ctimer_set().
+ *
+ * \sa etimer_set_slack()
+ */
+#if ETIMER_WITH_SLACK
+void ctimer_set_slack(struct ctimer *c, clock_time_t slack);
+#else /* ETIMER_WITH_SLACK */
+#define ctimer_set_slack(c, slack)
+#endif /* ETIMER_WITH_SLACK */
+
+/**
+ * \brief      Run the callback of an expired callback timer
+ * \param et   A pointer to the event timer of the callback timer
+ *
+ *             This function is called by the event timer module when
+ *             the event timer of a callback timer expires.
+ */
+void ctimer_run(struct etimer *et);
+
 /**
  * \brief      Initialize the callback timer library.
  *
@@ -163,6 +191,8 @@ int ctimer_expired(struct ctimer *c);
  */
 void ctimer_init(void);
 
+PROCESS_NAME(ctimer_process);
+
 #endif /* CTIMER_H_ */
 /** @} */
 /** @} */
@@ -47,79 +47,283 @@
 #include "contiki.h"
 
 #include "sys/etimer.h"
+#include "sys/ctimer.h"
 #include "sys/process.h"
 
 static struct etimer *timerlist;
 static clock_time_t next_expiration;
 
+#if ETIMER_WITH_HEAP
+/* Binary min-heap of pending event timers, ordered by the time
+   remaining until expiration. Timers that do not fit in the heap are
+   kept on timerlist. */
+static struct etimer *heap[ETIMER_HEAP_SIZE];
+static uint16_t heap_len;
+#endif /* ETIMER_WITH_HEAP */
+
+#if ETIMER_WITH_SLACK
+#define SLACK(t) ((t)->slack)
+#else /* ETIMER_WITH_SLACK */
+#define SLACK(t) 0
+#endif /* ETIMER_WITH_SLACK */
+
 PROCESS(etimer_process, "Event timer");
 /*---------------------------------------------------------------------------*/
+#if ETIMER_WITH_HEAP
+/* Time remaining until t expires, zero if it already has. Unlike the
+   expiration time itself, this gives an ordering of the timers that
+   does not change as the clock advances or wraps. */
+static clock_time_t
+remaining(struct etimer *t, clock_time_t now)
+{
+  clock_time_t elapsed = now - t->timer.start;
+
+  return elapsed >= t->timer.interval ? 0 : t->timer.interval - elapsed;
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_place(struct etimer *t, uint16_t i)
+{
+  heap[i] = t;
+  t->index = i;
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_sift_up(uint16_t i, clock_time_t now)
+{
+  struct etimer *t = heap[i];
+  clock_time_t r = remaining(t, now);
+  uint16_t parent;
+
+  while(i > 0) {
+    parent = (i - 1) / 2;
+    if(remaining(heap[parent], now) <= r) {
+      break;
+    }
+    heap_place(heap[parent], i);
+    i = parent;
+  }
+  heap_place(t, i);
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_sift_down(uint16_t i, clock_time_t now)
+{
+  struct etimer *t = heap[i];
+  clock_time_t r = remaining(t, now);
+  uint16_t child;
+
+  while((child = 2 * i + 1) < heap_len) {
+    if(child + 1 < heap_len &&
+       remaining(heap[child + 1], now) < remaining(heap[child], now)) {
+      child++;
+    }
+    if(r <= remaining(heap[child], now)) {
+      break;
+    }
+    heap_place(heap[child], i);
+    i = child;
+  }
+  heap_place(t, i);
+}
+/*---------------------------------------------------------------------------*/
+static int
+heap_contains(struct etimer *t)
+{
+  return t->index < heap_len && heap[t->index] == t;
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_remove(uint16_t i)
+{
+  clock_time_t now = clock_time();
+  struct etimer *moved;
+
+  heap[i]->index = ETIMER_HEAP_SIZE;
+  heap_len--;
+  if(i < heap_len) {
+    /* Fill the hole with the last timer and restore the heap order */
+    moved = heap[heap_len];
+    heap_place(moved, i);
+    heap_sift_up(i, now);
+    heap_sift_down(moved->index, now);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_update(struct etimer *t)
+{
+  clock_time_t now = clock_time();
+
+  heap_sift_up(t->index, now);
+  heap_sift_down(t->index, now);
+}
+#endif /* ETIMER_WITH_HEAP */
+/*---------------------------------------------------------------------------*/
 static void
 update_time(void)
 {
   clock_time_t tdist;
   clock_time_t now;
   struct etimer *t;
+#if ETIMER_WITH_HEAP
+  clock_time_t r;
+  uint16_t i;
+#endif /* ETIMER_WITH_HEAP */
 
-  if (timerlist == NULL) {
+  if(!etimer_pending()) {
     next_expiration = 0;
-  } else {
+    return;
+  }
+
+  now = clock_time();
+  tdist = (clock_time_t)-1;
+
+#if ETIMER_WITH_HEAP
+  /* Find the earliest deadline plus slack. Only timers that expire
+     before the best candidate found so far can improve on it, and as
+     children never expire before their parent, the walk descends
+     into a subtree only when its root does. */
+  i = 0;
+  while(1) {
+    if(i < heap_len && (r = remaining(heap[i], now)) < tdist) {
+      if(r + SLACK(heap[i]) >= r && r + SLACK(heap[i]) < tdist) {
+        tdist = r + SLACK(heap[i]);
+      }
+      i = 2 * i + 1;
+      continue;
+    }
+    /* Go up past right children, then on to the right sibling */
+    while(i > 0 && (i & 1) == 0) {
+      i = (i - 1) / 2;
+    }
+    if(i == 0) {
+      break;
+    }
+    i++;
+  }
+#endif /* ETIMER_WITH_HEAP */
+
+  /* Must calculate distance to next time into account due to wraps */
+  for(t = timerlist; t != NULL; t = t->next) {
+    if(t->timer.start + t->timer.interval + SLACK(t) - now < tdist) {
+      tdist = t->timer.start + t->timer.interval + SLACK(t) - now;
+    }
+  }
+  next_expiration = now + tdist;
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_process_timers(struct process *p)
+{
+  struct etimer *t;
+#if ETIMER_WITH_HEAP
+  uint16_t i, j;
+  clock_time_t now;
+
+  for(i = j = 0; i < heap_len; i++) {
+    if(heap[i]->p == p) {
+      heap[i]->index = ETIMER_HEAP_SIZE;
+    } else {
+      heap_place(heap[i], j++);
+    }
+  }
+  if(j < heap_len) {
+    heap_len = j;
     now = clock_time();
+    for(i = heap_len / 2; i > 0; i--) {
+      heap_sift_down(i - 1, now);
+    }
+  }
+#endif /* ETIMER_WITH_HEAP */
+
+  while(timerlist != NULL && timerlist->p == p) {
+    timerlist = timerlist->next;
+  }
+
+  if(timerlist != NULL) {
     t = timerlist;
-    /* Must calculate distance to next time into account due to wraps */
-    tdist = t->timer.start + t->timer.interval - now;
-    for(t = t->next; t != NULL; t = t->next) {
-      if(t->timer.start + t->timer.interval - now < tdist) {
-	tdist = t->timer.start + t->timer.interval - now;
-      }
+    while(t->next != NULL) {
+      if(t->next->p == p) {
+	t->next = t->next->next;
+      } else
+	t = t->next;
     }
-    next_expiration = now + tdist;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Deliver the expiration of t. Callback timers are run directly
+   rather than through an event posted to ctimer_process. Returns
+   non-zero if t has expired and must be removed from the pending
+   timers, zero if the event could not be posted. */
+static int
+expire(struct etimer *t)
+{
+  if(t->p == &ctimer_process) {
+    return 1;
+  }
+  return process_post(t->p, PROCESS_EVENT_TIMER, t) == PROCESS_ERR_OK;
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_ctimer(struct etimer *t, struct process *p)
+{
+  if(p == &ctimer_process) {
+    ctimer_run(t);
   }
 }
 /*---------------------------------------------------------------------------*/
 PROCESS_THREAD(etimer_process, ev, data)
 {
   struct etimer *t, *u;
+  struct process *p;
 	
   PROCESS_BEGIN();
 
   timerlist = NULL;
+#if ETIMER_WITH_HEAP
+  heap_len = 0;
+#endif /* ETIMER_WITH_HEAP */
   
   while(1) {
     PROCESS_YIELD();
 
     if(ev == PROCESS_EVENT_EXITED) {
-      struct process *p = data;
-
-      while(timerlist != NULL && timerlist->p == p) {
-	timerlist = timerlist->next;
-      }
-
-      if(timerlist != NULL) {
-	t = timerlist;
-	while(t->next != NULL) {
-	  if(t->next->p == p) {
-	    t->next = t->next->next;
-	  } else
-	    t = t->next;
-	}
-      }
+      remove_process_timers((struct process *)data);
       continue;
     } else if(ev != PROCESS_EVENT_POLL) {
       continue;
     }
 
+#if ETIMER_WITH_HEAP
+    /* Expired timers are at the top of the heap */
+    while(heap_len > 0 && timer_expired(&heap[0]->timer)) {
+      t = heap[0];
+      if(expire(t)) {
+        p = t->p;
+        t->p = PROCESS_NONE;
+        heap_remove(0);
+        run_ctimer(t, p);
+      } else {
+        etimer_request_poll();
+        break;
+      }
+    }
+    update_time();
+#endif /* ETIMER_WITH_HEAP */
+
   again:
     
     u = NULL;
     
     for(t = timerlist; t != NULL; t = t->next) {
       if(timer_expired(&t->timer)) {
-	if(process_post(t->p, PROCESS_EVENT_TIMER, t) == PROCESS_ERR_OK) {
+	if(expire(t)) {
 	  
 	  /* Reset the process ID of the event timer, to signal that the
 	     etimer has expired. This is later checked in the
 	     etimer_expired() function. */
+	  p = t->p;
 	  t->p = PROCESS_NONE;
 	  if(u != NULL) {
 	    u->next = t->next;
@@ -128,6 +332,7 @@ PROCESS_THREAD(etimer_process, ev, data)
 	  }
 	  t->next = NULL;
 	  update_time();
+	  run_ctimer(t, p);
 	  goto again;
 	} else {
 	  etimer_request_poll();
@@ -154,6 +359,16 @@ add_timer(struct etimer *timer)
 
   etimer_request_poll();
 
+#if ETIMER_WITH_HEAP
+  if(heap_contains(timer)) {
+    /* Timer already in the heap, restore the heap order. */
+    timer->p = PROCESS_CURRENT();
+    heap_update(timer);
+    update_time();
+    return;
+  }
+#endif /* ETIMER_WITH_HEAP */
+
   if(timer->p != PROCESS_NONE) {
     for(t = timerlist; t != NULL; t = t->next) {
       if(t == timer) {
@@ -165,8 +380,19 @@ add_timer(struct etimer *timer)
     }
   }
 
-  /* Timer not on list. */
   timer->p = PROCESS_CURRENT();
+
+#if ETIMER_WITH_HEAP
+  if(heap_len < ETIMER_HEAP_SIZE) {
+    heap_place(timer, heap_len++);
+    heap_sift_up(timer->index, clock_time());
+    update_time();
+    return;
+  }
+  timer->index = ETIMER_HEAP_SIZE;
+#endif /* ETIMER_WITH_HEAP */
+
+  /* Timer not on list. */
   timer->next = timerlist;
   timerlist = timer;
 
@@ -177,6 +403,9 @@ void
 etimer_set(struct etimer *et, clock_time_t interval)
 {
   timer_set(&et->timer, interval);
+#if ETIMER_WITH_SLACK
+  et->slack = 0;
+#endif /* ETIMER_WITH_SLACK */
   add_timer(et);
 }
 /*---------------------------------------------------------------------------*/
@@ -206,9 +435,23 @@ void
 etimer_adjust(struct etimer *et, int timediff)
 {
   et->timer.start += timediff;
+#if ETIMER_WITH_HEAP
+  if(heap_contains(et)) {
+    heap_update(et);
+  }
+#endif /* ETIMER_WITH_HEAP */
   update_time();
 }
 /*---------------------------------------------------------------------------*/
+#if ETIMER_WITH_SLACK
+void
+etimer_set_slack(struct etimer *et, clock_time_t slack)
+{
+  et->slack = slack;
+  update_time();
+}
+#endif /* ETIMER_WITH_SLACK */
+/*---------------------------------------------------------------------------*/
 int
 etimer_expired(struct etimer *et)
 {
@@ -230,6 +473,11 @@ etimer_start_time(struct etimer *et)
 int
 etimer_pending(void)
 {
+#if ETIMER_WITH_HEAP
+  if(heap_len > 0) {
+    return 1;
+  }
+#endif /* ETIMER_WITH_HEAP */
   return timerlist != NULL;
 }
 /*---------------------------------------------------------------------------*/
@@ -244,6 +492,15 @@ etimer_stop(struct etimer *et)
 {
   struct etimer *t;
 
+#if ETIMER_WITH_HEAP
+  if(heap_contains(et)) {
+    heap_remove(et->index);
+    update_time();
+    et->p = PROCESS_NONE;
+    return;
+  }
+#endif /* ETIMER_WITH_HEAP */
+
   /* First check if et is the first event timer on the list. */
   if(et == timerlist) {
     timerlist = timerlist->next;
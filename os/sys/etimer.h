@@ -64,6 +64,41 @@
 
 #include "contiki.h"
 
+/**
+ * \brief Keep pending event timers in a binary heap.
+ *
+ * By default, pending event timers are kept on a linked list that
+ * is scanned on every expiration. With a large number of timers,
+ * the heap gives O(log n) insertion and expiration instead. Timers
+ * beyond ETIMER_HEAP_SIZE are kept on the list.
+ */
+#ifdef ETIMER_CONF_WITH_HEAP
+#define ETIMER_WITH_HEAP ETIMER_CONF_WITH_HEAP
+#else /* ETIMER_CONF_WITH_HEAP */
+#define ETIMER_WITH_HEAP 0
+#endif /* ETIMER_CONF_WITH_HEAP */
+
+/** \brief The maximum number of event timers kept in the heap */
+#ifdef ETIMER_CONF_HEAP_SIZE
+#define ETIMER_HEAP_SIZE ETIMER_CONF_HEAP_SIZE
+#else /* ETIMER_CONF_HEAP_SIZE */
+#define ETIMER_HEAP_SIZE 32
+#endif /* ETIMER_CONF_HEAP_SIZE */
+
+/**
+ * \brief Allow event timers to expire later than their deadline.
+ *
+ * With this enabled, etimer_set_slack() lets an event timer expire
+ * up to a given number of clock ticks after its deadline, so that
+ * timers due within that window are expired together and the system
+ * wakes up less often.
+ */
+#ifdef ETIMER_CONF_WITH_SLACK
+#define ETIMER_WITH_SLACK ETIMER_CONF_WITH_SLACK
+#else /* ETIMER_CONF_WITH_SLACK */
+#define ETIMER_WITH_SLACK 0
+#endif /* ETIMER_CONF_WITH_SLACK */
+
 /**
  * A timer.
  *
@@ -76,6 +111,12 @@ struct etimer {
   struct timer timer;
   struct etimer *next;
   struct process *p;
+#if ETIMER_WITH_HEAP
+  uint16_t index;
+#endif /* ETIMER_WITH_HEAP */
+#if ETIMER_WITH_SLACK
+  clock_time_t slack;
+#endif /* ETIMER_WITH_SLACK */
 };
 
 /**
@@ -166,6 +207,26 @@ void etimer_restart(struct etimer *et);
  */
 void etimer_adjust(struct etimer *et, int td);
 
+/**
+ * \brief      Set the tolerated expiration delay of an event timer
+ * \param et   A pointer to the event timer.
+ * \param slack The number of clock ticks the timer may expire after
+ *             its deadline.
+ *
+ *             This function allows the event timer to expire up to
+ *             \e slack clock ticks late, so that it can be expired
+ *             together with other timers instead of causing a wakeup
+ *             of its own. The slack is kept when the timer is reset
+ *             or restarted, and cleared by etimer_set().
+ *
+ *             \note Has no effect unless ETIMER_CONF_WITH_SLACK is set.
+ */
+#if ETIMER_WITH_SLACK
+void etimer_set_slack(struct etimer *et, clock_time_t slack);
+#else /* ETIMER_WITH_SLACK */
+#define etimer_set_slack(et, slack)
+#endif /* ETIMER_WITH_SLACK */
+
 /**
  * \brief      Get the expiration time for the event timer.
  * \param et   A pointer to the event timer
@@ -236,7 +297,8 @@ int etimer_pending(void);
 
 /**
  * \brief      Get next event timer expiration time.
- * \return     Next expiration time of all pending event timers.
+ * \return     Next expiration time of all pending event timers,
+ *             including their slack.
  *             If there are no pending event timers this function
  *	       returns 0.
  *
@@ -44,9 +44,11 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "contiki.h"
 #include "sys/process.h"
+#include "sys/int-master.h"
 
 /*
  * Pointer to the currently running process structure.
@@ -65,20 +67,60 @@ struct event_data {
   struct process *p;
 };
 
-static process_num_events_t nevents, fevent;
-static struct event_data events[PROCESS_CONF_NUMEVENTS];
+/*
+ * One event queue per priority class. Events are queued according
+ * to the priority of the receiving process; broadcast events go to
+ * the normal priority queue.
+ */
+struct event_queue {
+  process_num_events_t nevents, fevent;
+  struct event_data events[PROCESS_CONF_NUMEVENTS];
+};
+
+static struct event_queue queues[PROCESS_PRIORITIES];
+
+/* Total number of queued events, over all priority classes. Each
+   queue holds up to PROCESS_CONF_NUMEVENTS events, so the total may
+   not fit in a process_num_events_t. */
+static uint16_t nevents;
 
 #if PROCESS_CONF_STATS
-process_num_events_t process_maxevents;
+uint16_t process_maxevents;
+uint16_t process_dropped_events;
 #endif
 
 static volatile unsigned char poll_requested;
 
+/*
+ * Processes that have requested to be polled, in the order of the
+ * requests, and the processes being polled by the ongoing do_poll().
+ * Both lists are linked through the nextpoll field.
+ */
+static struct process *poll_head, *poll_tail;
+static struct process *polling;
+
+#if PROCESS_SUBSCRIPTIONS
+/*
+ * Registry of the broadcast events that processes have subscribed
+ * to, sorted by event and then by process. The subscribers of an
+ * event are thus a contiguous run of entries, found by a binary
+ * search.
+ */
+struct subscription {
+  struct process *p;
+  process_event_t ev;
+};
+
+static struct subscription subscriptions[PROCESS_SUBSCRIPTIONS];
+static unsigned num_subscriptions;
+#endif /* PROCESS_SUBSCRIPTIONS */
+
 #define PROCESS_STATE_NONE        0
 #define PROCESS_STATE_RUNNING     1
 #define PROCESS_STATE_CALLED      2
 
 static void call_process(struct process *p, process_event_t ev, process_data_t data);
+static void do_poll(void);
 
 #define DEBUG 0
 #if DEBUG
@@ -120,6 +162,150 @@ process_start(struct process *p, process_data_t data)
   process_post_synch(p, PROCESS_EVENT_INIT, data);
 }
 /*---------------------------------------------------------------------------*/
+#if PROCESS_SUBSCRIPTIONS
+/*
+ * Index of the first subscription that is not ordered before the one
+ * of process p to event ev.
+ */
+static unsigned
+find_subscription(process_event_t ev, const struct process *p)
+{
+  unsigned lo, hi, mid;
+
+  lo = 0;
+  hi = num_subscriptions;
+  while(lo < hi) {
+    mid = (lo + hi) / 2;
+    if(subscriptions[mid].ev < ev ||
+       (subscriptions[mid].ev == ev &&
+        (uintptr_t)subscriptions[mid].p < (uintptr_t)p)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+/*---------------------------------------------------------------------------*/
+int
+process_subscribe(struct process *p, process_event_t ev)
+{
+  unsigned i;
+
+  i = find_subscription(ev, p);
+  if(i < num_subscriptions &&
+     subscriptions[i].ev == ev && subscriptions[i].p == p) {
+    return PROCESS_ERR_OK;
+  }
+
+  if(num_subscriptions == PROCESS_SUBSCRIPTIONS) {
+    return PROCESS_ERR_FULL;
+  }
+
+  memmove(&subscriptions[i + 1], &subscriptions[i],
+          (num_subscriptions - i) * sizeof(struct subscription));
+  subscriptions[i].p = p;
+  subscriptions[i].ev = ev;
+  num_subscriptions++;
+  p->nsubscriptions++;
+  return PROCESS_ERR_OK;
+}
+/*---------------------------------------------------------------------------*/
+void
+process_unsubscribe(struct process *p, process_event_t ev)
+{
+  unsigned i;
+
+  i = find_subscription(ev, p);
+  if(i < num_subscriptions &&
+     subscriptions[i].ev == ev && subscriptions[i].p == p) {
+    num_subscriptions--;
+    memmove(&subscriptions[i], &subscriptions[i + 1],
+            (num_subscriptions - i) * sizeof(struct subscription));
+    p->nsubscriptions--;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+unsubscribe_all(struct process *p)
+{
+  unsigned i, j;
+
+  for(i = j = 0; i < num_subscriptions; i++) {
+    if(subscriptions[i].p != p) {
+      subscriptions[j++] = subscriptions[i];
+    }
+  }
+  num_subscriptions = j;
+  p->nsubscriptions = 0;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Deliver a broadcast event to the processes that subscribed to it.
+ * As the process called may change the subscriptions, the next
+ * subscriber is looked up again after each call.
+ */
+static void
+broadcast_to_subscribers(process_event_t ev, process_data_t data)
+{
+  struct process *p;
+  unsigned i;
+
+  p = NULL;
+  while(1) {
+    /* If we have been requested to poll a process, we do this in
+       between processing the broadcast event. */
+    if(poll_requested) {
+      do_poll();
+    }
+
+    i = find_subscription(ev, p);
+    if(i < num_subscriptions && subscriptions[i].p == p) {
+      i++;
+    }
+    if(i >= num_subscriptions || subscriptions[i].ev != ev) {
+      return;
+    }
+    p = subscriptions[i].p;
+    call_process(p, ev, data);
+  }
+}
+#endif /* PROCESS_SUBSCRIPTIONS */
+/*---------------------------------------------------------------------------*/
+static void
+remove_poll_request(struct process *p)
+{
+  struct process **q;
+  struct process *prev;
+  int_master_status_t status;
+
+  status = int_master_read_and_disable();
+
+  for(q = &polling; *q != NULL; q = &(*q)->nextpoll) {
+    if(*q == p) {
+      *q = p->nextpoll;
+      break;
+    }
+  }
+
+  prev = NULL;
+  for(q = &poll_head; *q != NULL; q = &(*q)->nextpoll) {
+    if(*q == p) {
+      *q = p->nextpoll;
+      if(poll_tail == p) {
+        poll_tail = prev;
+      }
+      break;
+    }
+    prev = *q;
+  }
+
+  p->needspoll = 0;
+  p->nextpoll = NULL;
+
+  int_master_status_set(status);
+}
+/*---------------------------------------------------------------------------*/
 static void
 exit_process(struct process *p, struct process *fromprocess)
 {
@@ -135,6 +321,16 @@ exit_process(struct process *p, struct process *fromprocess)
     return;
   }
 
+  if(p->needspoll) {
+    remove_poll_request(p);
+  }
+
+#if PROCESS_SUBSCRIPTIONS
+  if(p->nsubscriptions > 0) {
+    unsubscribe_all(p);
+  }
+#endif /* PROCESS_SUBSCRIPTIONS */
+
   if(process_is_running(p)) {
     /* Process was running */
     p->state = PROCESS_STATE_NONE;
@@ -207,13 +403,25 @@ process_exit(struct process *p)
 void
 process_init(void)
 {
+  uint8_t i;
+
   lastevent = PROCESS_EVENT_MAX;
 
-  nevents = fevent = 0;
+  nevents = 0;
+  for(i = 0; i < PROCESS_PRIORITIES; i++) {
+    queues[i].nevents = queues[i].fevent = 0;
+  }
 #if PROCESS_CONF_STATS
   process_maxevents = 0;
+  process_dropped_events = 0;
 #endif /* PROCESS_CONF_STATS */
 
+  poll_head = poll_tail = polling = NULL;
+
+#if PROCESS_SUBSCRIPTIONS
+  num_subscriptions = 0;
+#endif /* PROCESS_SUBSCRIPTIONS */
+
   process_current = process_list = NULL;
 }
 /*---------------------------------------------------------------------------*/
@@ -225,15 +433,26 @@ static void
 do_poll(void)
 {
   struct process *p;
+  int_master_status_t status;
+
+  /* Take the pending poll requests. Requests made while polling are
+     handled in the next round. If called from within a poll handler,
+     keep going with the requests taken by the outer round. */
+  status = int_master_read_and_disable();
+  if(polling == NULL) {
+    polling = poll_head;
+    poll_head = poll_tail = NULL;
+    poll_requested = 0;
+  }
+  int_master_status_set(status);
 
-  poll_requested = 0;
   /* Call the processes that needs to be polled. */
-  for(p = process_list; p != NULL; p = p->next) {
-    if(p->needspoll) {
-      p->state = PROCESS_STATE_RUNNING;
-      p->needspoll = 0;
-      call_process(p, PROCESS_EVENT_POLL, NULL);
-    }
+  while(polling != NULL) {
+    p = polling;
+    polling = p->nextpoll;
+    p->state = PROCESS_STATE_RUNNING;
+    p->needspoll = 0;
+    call_process(p, PROCESS_EVENT_POLL, NULL);
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -249,6 +468,7 @@ do_event(void)
   process_data_t data;
   struct process *receiver;
   struct process *p;
+  struct event_queue *q;
 
   /*
    * If there are any events in the queue, take the first one and walk
@@ -260,20 +480,34 @@ do_event(void)
 
   if(nevents > 0) {
 
+    /* Take the event from the highest priority queue that has one. */
+    q = &queues[PROCESS_PRIORITIES - 1];
+    while(q->nevents == 0) {
+      q--;
+    }
+
     /* There are events that we should deliver. */
-    ev = events[fevent].ev;
+    ev = q->events[q->fevent].ev;
 
-    data = events[fevent].data;
-    receiver = events[fevent].p;
+    data = q->events[q->fevent].data;
+    receiver = q->events[q->fevent].p;
 
     /* Since we have seen the new event, we move pointer upwards
        and decrease the number of events. */
-    fevent = (fevent + 1) % PROCESS_CONF_NUMEVENTS;
+    q->fevent = (q->fevent + 1) % PROCESS_CONF_NUMEVENTS;
+    --q->nevents;
     --nevents;
 
     /* If this is a broadcast event, we deliver it to all events, in
        order of their priority. */
     if(receiver == PROCESS_BROADCAST) {
+#if PROCESS_SUBSCRIPTIONS
+      /* Only the system events are delivered to all processes */
+      if(ev >= PROCESS_EVENT_MAX) {
+	broadcast_to_subscribers(ev, data);
+	return;
+      }
+#endif /* PROCESS_SUBSCRIPTIONS */
       for(p = process_list; p != NULL; p = p->next) {
 
 	/* If we have been requested to poll a process, we do this in
@@ -322,6 +556,7 @@ int
 process_post(struct process *p, process_event_t ev, process_data_t data)
 {
   process_num_events_t snum;
+  struct event_queue *q;
 
   if(PROCESS_CURRENT() == NULL) {
     PRINTF("process_post: NULL process posts event %d to process '%s', nevents %d\n",
@@ -332,7 +567,13 @@ process_post(struct process *p, process_event_t ev, process_data_t data)
 	   p == PROCESS_BROADCAST? "<broadcast>": PROCESS_NAME_STRING(p), nevents);
   }
 
-  if(nevents == PROCESS_CONF_NUMEVENTS) {
+  q = &queues[p == PROCESS_BROADCAST ? PROCESS_PRIORITY_NORMAL :
+              PROCESS_PRIORITY_OF(p)];
+
+  if(q->nevents == PROCESS_CONF_NUMEVENTS) {
+#if PROCESS_CONF_STATS
+    process_dropped_events++;
+#endif /* PROCESS_CONF_STATS */
 #if DEBUG
     if(p == PROCESS_BROADCAST) {
       printf("soft panic: event queue is full when broadcast event %d was posted from %s\n", ev, PROCESS_NAME_STRING(process_current));
@@ -343,10 +584,11 @@ process_post(struct process *p, process_event_t ev, process_data_t data)
     return PROCESS_ERR_FULL;
   }
 
-  snum = (process_num_events_t)(fevent + nevents) % PROCESS_CONF_NUMEVENTS;
-  events[snum].ev = ev;
-  events[snum].data = data;
-  events[snum].p = p;
+  snum = (process_num_events_t)(q->fevent + q->nevents) % PROCESS_CONF_NUMEVENTS;
+  q->events[snum].ev = ev;
+  q->events[snum].data = data;
+  q->events[snum].p = p;
+  ++q->nevents;
   ++nevents;
 
 #if PROCESS_CONF_STATS
@@ -370,15 +612,40 @@ process_post_synch(struct process *p, process_event_t ev, process_data_t data)
 void
 process_poll(struct process *p)
 {
+  int_master_status_t status;
+
   if(p != NULL) {
     if(p->state == PROCESS_STATE_RUNNING ||
        p->state == PROCESS_STATE_CALLED) {
-      p->needspoll = 1;
+      status = int_master_read_and_disable();
+      if(!p->needspoll) {
+        /* Not already waiting to be polled, add to the poll list */
+        p->needspoll = 1;
+        p->nextpoll = NULL;
+        if(poll_tail != NULL) {
+          poll_tail->nextpoll = p;
+        } else {
+          poll_head = p;
+        }
+        poll_tail = p;
+      }
       poll_requested = 1;
+      int_master_status_set(status);
     }
   }
 }
 /*---------------------------------------------------------------------------*/
+#if PROCESS_PRIORITIES > 1
+void
+process_set_priority(struct process *p, uint8_t priority)
+{
+  if(priority >= PROCESS_PRIORITIES) {
+    priority = PROCESS_PRIORITIES - 1;
+  }
+  p->priority = priority;
+}
+#endif /* PROCESS_PRIORITIES > 1 */
+/*---------------------------------------------------------------------------*/
 int
 process_is_running(struct process *p)
 {
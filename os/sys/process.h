@@ -88,6 +88,40 @@ typedef unsigned char process_num_events_t;
 #define PROCESS_CONF_NUMEVENTS 32
 #endif /* PROCESS_CONF_NUMEVENTS */
 
+/**
+ * \brief The number of process priority classes
+ *
+ * Events posted to a process are queued according to the priority
+ * class of the process, and events of a higher class are always
+ * delivered before events of a lower class. Each class has its own
+ * queue of PROCESS_CONF_NUMEVENTS events. With the default single
+ * class, events are delivered in the order they are posted.
+ */
+#ifdef PROCESS_CONF_PRIORITIES
+#define PROCESS_PRIORITIES PROCESS_CONF_PRIORITIES
+#else /* PROCESS_CONF_PRIORITIES */
+#define PROCESS_PRIORITIES 1
+#endif /* PROCESS_CONF_PRIORITIES */
+
+/**
+ * \brief The number of broadcast event subscriptions
+ *
+ * When enabled, broadcast events other than the system events are
+ * only delivered to the processes that subscribed to them with
+ * process_subscribe(). Zero disables subscriptions, and all
+ * processes then receive all broadcast events.
+ */
+#ifdef PROCESS_CONF_SUBSCRIPTIONS
+#define PROCESS_SUBSCRIPTIONS PROCESS_CONF_SUBSCRIPTIONS
+#else /* PROCESS_CONF_SUBSCRIPTIONS */
+#define PROCESS_SUBSCRIPTIONS 0
+#endif /* PROCESS_CONF_SUBSCRIPTIONS */
+
+/** \brief The priority class of processes by default */
+#define PROCESS_PRIORITY_NORMAL 0
+/** \brief The highest priority class, used for the network stack */
+#define PROCESS_PRIORITY_HIGH   (PROCESS_PRIORITIES - 1)
+
 #define PROCESS_EVENT_NONE            0x80
 #define PROCESS_EVENT_INIT            0x81
 #define PROCESS_EVENT_POLL            0x82
@@ -323,6 +357,16 @@ struct process {
   PT_THREAD((* thread)(struct pt *, process_event_t, process_data_t));
   struct pt pt;
   unsigned char state, needspoll;
+  struct process *nextpoll;
+#if PROCESS_PRIORITIES > 1
+  uint8_t priority;
+#define PROCESS_PRIORITY_OF(process) (process)->priority
+#else
+#define PROCESS_PRIORITY_OF(process) PROCESS_PRIORITY_NORMAL
+#endif
+#if PROCESS_SUBSCRIPTIONS
+  uint8_t nsubscriptions;
+#endif
 };
 
 /**
@@ -390,6 +434,65 @@ void process_post_synch(struct process *p,
 void process_exit(struct process *p);
 
 
+/**
+ * \brief      Set the priority class of a process
+ * \param p    The process
+ * \param priority The priority class, from PROCESS_PRIORITY_NORMAL
+ *             to PROCESS_PRIORITY_HIGH
+ *
+ *             Events posted to the process after this call are
+ *             delivered before any queued event of a lower priority
+ *             class. Has no effect with a single priority class.
+ */
+#if PROCESS_PRIORITIES > 1
+void process_set_priority(struct process *p, uint8_t priority);
+#else /* PROCESS_PRIORITIES > 1 */
+#define process_set_priority(p, priority)
+#endif /* PROCESS_PRIORITIES > 1 */
+
+/**
+ * \brief      Subscribe a process to a broadcast event
+ * \param p    The process
+ * \param ev   The event
+ * \retval PROCESS_ERR_OK The process is subscribed to the event
+ * \retval PROCESS_ERR_FULL There was no room for the subscription
+ *
+ *             With PROCESS_CONF_SUBSCRIPTIONS, events posted with
+ *             PROCESS_BROADCAST only reach the processes that have
+ *             subscribed to them. The system events below
+ *             PROCESS_EVENT_MAX are always delivered to all
+ *             processes. Events posted to the process itself are not
+ *             affected. Subscriptions are removed when the process
+ *             exits. The event must have been allocated with
+ *             process_alloc_event() before subscribing.
+ *
+ *             Without PROCESS_CONF_SUBSCRIPTIONS, all processes
+ *             receive all broadcast events.
+ */
+#if PROCESS_SUBSCRIPTIONS
+int process_subscribe(struct process *p, process_event_t ev);
+#else /* PROCESS_SUBSCRIPTIONS */
+static inline int
+process_subscribe(struct process *p, process_event_t ev)
+{
+  return PROCESS_ERR_OK;
+}
+#endif /* PROCESS_SUBSCRIPTIONS */
+
+/**
+ * \brief      Unsubscribe a process from a broadcast event
+ * \param p    The process
+ * \param ev   The event
+ *
+ *             The process no longer receives the event when it is
+ *             broadcast.
+ */
+#if PROCESS_SUBSCRIPTIONS
+void process_unsubscribe(struct process *p, process_event_t ev);
+#else /* PROCESS_SUBSCRIPTIONS */
+#define process_unsubscribe(p, ev)
+#endif /* PROCESS_SUBSCRIPTIONS */
+
 /**
  * Get a pointer to the currently running process.
  *
@@ -519,6 +622,14 @@ int process_is_running(struct process *p);
  */
 int process_nevents(void);
 
+#if PROCESS_CONF_STATS
+/** \brief The largest number of events that were queued at once */
+extern uint16_t process_maxevents;
+/** \brief The number of events that could not be posted because
+    their queue was full */
+extern uint16_t process_dropped_events;
+#endif /* PROCESS_CONF_STATS */
+
 /** @} */
 
 extern struct process *process_list;
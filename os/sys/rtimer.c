@@ -44,6 +44,7 @@
  */
 
 #include "sys/rtimer.h"
+#include "sys/int-master.h"
 #include "contiki.h"
 
 #define DEBUG 0
@@ -54,12 +55,71 @@
 #define PRINTF(...)
 #endif
 
-static struct rtimer *next_rtimer;
+/* Pending rtimers, ordered by deadline. The head of the list is the
+   one currently programmed into the hardware timer. */
+static struct rtimer *rtimer_list;
+/* Set while rtimer_run_next() executes callbacks, so that rtimers
+   posted from within a callback do not reprogram the hardware timer
+   until all due rtimers have been run. */
+static volatile uint8_t running;
 
+static struct rtimer_stats stats;
+
+/*---------------------------------------------------------------------------*/
+static void
+remove_timer(struct rtimer *rtimer)
+{
+  struct rtimer **p;
+
+  for(p = &rtimer_list; *p != NULL; p = &(*p)->next) {
+    if(*p == rtimer) {
+      *p = rtimer->next;
+      rtimer->next = NULL;
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+insert_timer(struct rtimer *rtimer)
+{
+  struct rtimer **p;
+
+  /* Rtimers with equal deadlines run in the order they were set */
+  for(p = &rtimer_list;
+      *p != NULL && !RTIMER_CLOCK_LT(rtimer->time, (*p)->time);
+      p = &(*p)->next);
+  rtimer->next = *p;
+  *p = rtimer;
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_timer(struct rtimer *t, rtimer_clock_t now)
+{
+  rtimer_clock_t lateness;
+
+  rtimer_list = t->next;
+  t->next = NULL;
+
+  if(RTIMER_CLOCK_LT(t->time, now)) {
+    lateness = now - t->time;
+    if(lateness > RTIMER_LATE_THRESHOLD) {
+      stats.late++;
+    }
+    if(lateness > stats.max_lateness) {
+      stats.max_lateness = lateness;
+    }
+  }
+
+  t->func(t, t->ptr);
+}
 /*---------------------------------------------------------------------------*/
 void
 rtimer_init(void)
 {
+  rtimer_list = NULL;
+  running = 0;
+  rtimer_reset_stats();
   rtimer_arch_init();
 }
 /*---------------------------------------------------------------------------*/
@@ -68,23 +128,32 @@ rtimer_set(struct rtimer *rtimer, rtimer_clock_t time,
 	   rtimer_clock_t duration,
 	   rtimer_callback_t func, void *ptr)
 {
-  int first = 0;
+  int_master_status_t status;
+  struct rtimer *head;
+  rtimer_clock_t head_time;
 
   PRINTF("rtimer_set time %d\n", time);
 
-  if(next_rtimer == NULL) {
-    first = 1;
-  }
+  status = int_master_read_and_disable();
+
+  head = rtimer_list;
+  head_time = head != NULL ? head->time : 0;
+
+  /* Setting an rtimer that is already pending reschedules it */
+  remove_timer(rtimer);
 
   rtimer->func = func;
   rtimer->ptr = ptr;
-
   rtimer->time = time;
-  next_rtimer = rtimer;
+  insert_timer(rtimer);
 
-  if(first == 1) {
-    rtimer_arch_schedule(time);
+  /* Reprogram the hardware timer whenever the head deadline changes,
+     including when the head itself was set to a later time */
+  if(!running && (rtimer_list != head || rtimer_list->time != head_time)) {
+    rtimer_arch_schedule(rtimer_list->time);
   }
+
+  int_master_status_set(status);
   return RTIMER_OK;
 }
 /*---------------------------------------------------------------------------*/
@@ -92,16 +161,50 @@ void
 rtimer_run_next(void)
 {
   struct rtimer *t;
-  if(next_rtimer == NULL) {
+  rtimer_clock_t now;
+
+  if(rtimer_list == NULL) {
     return;
   }
-  t = next_rtimer;
-  next_rtimer = NULL;
-  t->func(t, t->ptr);
-  if(next_rtimer != NULL) {
-    rtimer_arch_schedule(next_rtimer->time);
+
+  if(RTIMER_CLOCK_LT(RTIMER_NOW(), rtimer_list->time)) {
+    /* The head was rescheduled to a later time after the hardware
+       timer had been armed for it */
+    rtimer_arch_schedule(rtimer_list->time);
+    return;
+  }
+
+  running = 1;
+
+  /* Run the head of the list, then any other rtimer that became due
+     meanwhile. The latter includes rtimers whose deadline passed while
+     an earlier callback ran and which would otherwise be missed. */
+  while((t = rtimer_list) != NULL) {
+    now = RTIMER_NOW();
+    if(RTIMER_CLOCK_LT(now, t->time)) {
+      break;
+    }
+    run_timer(t, now);
   }
-  return;
+
+  running = 0;
+
+  if(rtimer_list != NULL) {
+    rtimer_arch_schedule(rtimer_list->time);
+  }
+}
+/*---------------------------------------------------------------------------*/
+const struct rtimer_stats *
+rtimer_get_stats(void)
+{
+  return &stats;
+}
+/*---------------------------------------------------------------------------*/
+void
+rtimer_reset_stats(void)
+{
+  stats.late = 0;
+  stats.max_lateness = 0;
 }
 /*---------------------------------------------------------------------------*/
 
@@ -109,6 +109,7 @@ typedef void (* rtimer_callback_t)(struct rtimer *t, void *ptr);
  *             support module for the real-time module.
  */
 struct rtimer {
+  struct rtimer *next;
   rtimer_clock_t time;
   rtimer_callback_t func;
   void *ptr;
@@ -132,7 +133,10 @@ enum {
  *             (false) if the task could not be scheduled.
  *
  *             This function schedules a real-time task at a specified
- *             time in the future.
+ *             time in the future. Several tasks can be pending at the
+ *             same time; they are executed in the order of their
+ *             deadlines. Setting a task that is already pending
+ *             reschedules it.
  *
  */
 int rtimer_set(struct rtimer *task, rtimer_clock_t time,
@@ -143,10 +147,34 @@ int rtimer_set(struct rtimer *task, rtimer_clock_t time,
  *
  *             This function is called by the architecture dependent
  *             code to execute and schedule the next real-time task.
+ *             Any other task whose deadline has passed by the time
+ *             the first one returns is executed as well.
  *
  */
 void rtimer_run_next(void);
 
+/**
+ * \brief      Real-time task execution statistics
+ */
+struct rtimer_stats {
+  /** Number of tasks executed more than RTIMER_LATE_THRESHOLD ticks
+      after their deadline */
+  uint32_t late;
+  /** Largest observed delay between a deadline and task execution */
+  rtimer_clock_t max_lateness;
+};
+
+/**
+ * \brief      Get the real-time task execution statistics
+ * \return     A pointer to the statistics
+ */
+const struct rtimer_stats *rtimer_get_stats(void);
+
+/**
+ * \brief      Reset the real-time task execution statistics
+ */
+void rtimer_reset_stats(void);
+
 /**
  * \brief      Get the current clock time
  * \return     The current time
@@ -188,6 +216,15 @@ void rtimer_arch_schedule(rtimer_clock_t t);
 #define RTIMER_GUARD_TIME (RTIMER_ARCH_SECOND >> 14)
 #endif /* RTIMER_CONF_GUARD_TIME */
 
+/* RTIMER_LATE_THRESHOLD is the number of rtimer ticks a task may be
+   executed after its deadline before it is accounted as late in the
+   rtimer statistics. */
+#ifdef RTIMER_CONF_LATE_THRESHOLD
+#define RTIMER_LATE_THRESHOLD RTIMER_CONF_LATE_THRESHOLD
+#else /* RTIMER_CONF_LATE_THRESHOLD */
+#define RTIMER_LATE_THRESHOLD (RTIMER_ARCH_SECOND / 1000)
+#endif /* RTIMER_CONF_LATE_THRESHOLD */
+
 /** \brief Busy-wait until a condition. Start time is t0, max wait time is max_time */
 #ifndef RTIMER_BUSYWAIT_UNTIL_ABS
 #define RTIMER_BUSYWAIT_UNTIL_ABS(cond, t0, max_time) \
@@ -0,0 +1,520 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Sends fragmented datagrams through a router forwarding 6LoWPAN
+ * fragments without reassembly, and checks what the next hop gets. The
+ * node is in turn the sender, the router and the next hop: a MAC driver
+ * of the test keeps the frames it is given, which are then fed back to
+ * 6LoWPAN as coming from another node.
+ */
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "net/ipv6/uip-ds6-route.h"
+#include "net/ipv6/sicslowpan.h"
+#include "net/routing/routing.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/mac/mac.h"
+#include "services/unit-test/unit-test.h"
+
+#include <string.h>
+#include <stdio.h>
+/*---------------------------------------------------------------------------*/
+PROCESS(forwarding_test_process, "6LoWPAN forwarding test process");
+AUTOSTART_PROCESSES(&forwarding_test_process);
+/*---------------------------------------------------------------------------*/
+#define MAX_FRAMES 40
+#define MAX_FRAME_LEN 80
+
+#define ORIG_IP_BUF ((struct uip_ip_hdr *)orig)
+/* The address in a source routing header of a single address */
+#define SRH_ADDR_OFFSET (sizeof(struct uip_routing_hdr) + sizeof(uip_rpl_srh_hdr))
+#define SRH_LEN (SRH_ADDR_OFFSET + sizeof(uip_ipaddr_t))
+
+struct frames {
+  int num;
+  uint8_t data[MAX_FRAMES][MAX_FRAME_LEN];
+  int len[MAX_FRAMES];
+  linkaddr_t dest[MAX_FRAMES];
+};
+
+/* What the sender, and the router, sent */
+static struct frames sent, forwarded;
+static struct frames *out;
+
+static const linkaddr_t next_hop = { { 3, 3, 3, 3, 3, 3, 3, 3 } };
+static uip_ipaddr_t router_addr;
+
+/* The datagram as sent, and as received by the next hop */
+static uint8_t orig[UIP_BUFSIZE];
+static uint16_t orig_len;
+static uint8_t received[UIP_BUFSIZE];
+static uint16_t received_len;
+
+/* Whether the node acts as the router or the next hop */
+static int routing;
+/* A destination the router rewrites the forwarded packets to, if any */
+static const uip_ipaddr_t *new_dest;
+/*---------------------------------------------------------------------------*/
+/* A MAC driver that keeps the frames */
+static void
+mac_init(void)
+{
+}
+static void
+mac_send(mac_callback_t sent_callback, void *ptr)
+{
+  if(out->num < MAX_FRAMES && packetbuf_datalen() <= MAX_FRAME_LEN) {
+    memcpy(out->data[out->num], packetbuf_dataptr(), packetbuf_datalen());
+    out->len[out->num] = packetbuf_datalen();
+    linkaddr_copy(&out->dest[out->num], packetbuf_addr(PACKETBUF_ADDR_RECEIVER));
+    out->num++;
+  }
+  sent_callback(ptr, MAC_TX_OK, 1);
+}
+static void
+mac_input(void)
+{
+}
+static int
+mac_on(void)
+{
+  return 1;
+}
+static int
+mac_off(void)
+{
+  return 1;
+}
+static int
+mac_max_payload(void)
+{
+  return MAX_FRAME_LEN;
+}
+const struct mac_driver test_mac_driver = {
+  "test", mac_init, mac_send, mac_input, mac_on, mac_off, mac_max_payload
+};
+/*---------------------------------------------------------------------------*/
+/* A routing driver that only follows source routing headers with a single
+ * uncompressed address, as RPL non-storing does at each hop */
+static void init(void) { }
+static void root_set_prefix(uip_ipaddr_t *prefix, uip_ipaddr_t *iid) { }
+static int root_start(void) { return 0; }
+static int node_is_root(void) { return 0; }
+static int get_root_ipaddr(uip_ipaddr_t *ipaddr) { return 0; }
+static int get_sr_node_ipaddr(uip_ipaddr_t *addr, const uip_sr_node_t *node) { return 0; }
+static void leave_network(void) { }
+static int node_has_joined(void) { return 1; }
+static int node_is_reachable(void) { return 1; }
+static void global_repair(const char *str) { }
+static void local_repair(const char *str) { }
+static void ext_header_remove(void) { uip_remove_ext_hdr(); }
+static int ext_header_update(void) { return 1; }
+static int ext_header_hbh_update(uint8_t *ext_buf, int opt_offset) { return 1; }
+static int ext_header_srh_get_next_hop(uip_ipaddr_t *ipaddr) { return 0; }
+static void link_callback(const linkaddr_t *addr, int status, int numtx) { }
+static void neighbor_state_changed(uip_ds6_nbr_t *nbr) { }
+static void drop_route(uip_ds6_route_t *route) { }
+
+static int
+ext_header_srh_update(void)
+{
+  struct uip_routing_hdr *rh;
+  uip_ipaddr_t *addr;
+  uip_ipaddr_t tmp;
+
+  rh = (struct uip_routing_hdr *)uipbuf_search_header(uip_buf, uip_len,
+                                                      UIP_PROTO_ROUTING);
+  if(rh == NULL || rh->seg_left != 1 || (rh->len + 1) * 8 != SRH_LEN) {
+    return 0;
+  }
+  /* Swap the destination with the next address of the route */
+  addr = (uip_ipaddr_t *)((uint8_t *)rh + SRH_ADDR_OFFSET);
+  uip_ipaddr_copy(&tmp, addr);
+  uip_ipaddr_copy(addr, &UIP_IP_BUF->destipaddr);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &tmp);
+  rh->seg_left--;
+  return 1;
+}
+
+const struct routing_driver test_routing_driver = {
+  "test",
+  init,
+  root_set_prefix,
+  root_start,
+  node_is_root,
+  get_root_ipaddr,
+  get_sr_node_ipaddr,
+  leave_network,
+  node_has_joined,
+  node_is_reachable,
+  global_repair,
+  local_repair,
+  ext_header_remove,
+  ext_header_update,
+  ext_header_hbh_update,
+  ext_header_srh_update,
+  ext_header_srh_get_next_hop,
+  link_callback,
+  neighbor_state_changed,
+  drop_route,
+};
+/*---------------------------------------------------------------------------*/
+/* At the next hop, keeps what the IP layer gets instead of processing it.
+ * The last datagram it gets is the reassembled one */
+static enum netstack_ip_action
+ip_input(void)
+{
+  if(routing) {
+    return NETSTACK_IP_PROCESS;
+  }
+  memcpy(received, uip_buf, uip_len);
+  received_len = uip_len;
+  return NETSTACK_IP_DROP;
+}
+/* At the router, rewrites the destination, as a routing protocol may */
+static enum netstack_ip_action
+ip_output(const linkaddr_t *localdest)
+{
+  if(routing && new_dest != NULL) {
+    uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, new_dest);
+  }
+  return NETSTACK_IP_PROCESS;
+}
+static struct netstack_ip_packet_processor ip_processor = {
+  .process_input = ip_input,
+  .process_output = ip_output
+};
+/*---------------------------------------------------------------------------*/
+/* Counts the packets 6LoWPAN passes to the IP layer, with the protocol it
+ * tagged the last one with */
+static int sniffed_num;
+static uint8_t sniffed_proto;
+
+static void
+sniffer_input(void)
+{
+  sniffed_num++;
+  sniffed_proto = packetbuf_attr(PACKETBUF_ATTR_NETWORK_ID);
+}
+static void
+sniffer_output(int mac_status)
+{
+}
+NETSTACK_SNIFFER(sniffer, sniffer_input, sniffer_output);
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Builds a UDP datagram from 2001:db8::1 to dest in uip_buf, with a
+ * source routing header to via if not NULL, and sends it as fragments */
+static void
+send_datagram(const uip_ipaddr_t *dest, const uip_ipaddr_t *via,
+              uint16_t payload_len)
+{
+  static const linkaddr_t router = { { 2, 2, 2, 2, 2, 2, 2, 2 } };
+  struct uip_routing_hdr *rh;
+  uint8_t *udp = uip_buf + UIP_IPH_LEN;
+  uint16_t i;
+
+  memset(uip_buf, 0, UIP_IPH_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->ttl = 64;
+  uip_ip6addr(&UIP_IP_BUF->srcipaddr, 0x2001, 0xdb8, 0, 0, 0, 0, 0, 1);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, dest);
+  if(via != NULL) {
+    /* The router is the current destination, the final one is next */
+    UIP_IP_BUF->proto = UIP_PROTO_ROUTING;
+    rh = (struct uip_routing_hdr *)udp;
+    memset(rh, 0, SRH_LEN);
+    rh->next = UIP_PROTO_UDP;
+    rh->len = SRH_LEN / 8 - 1;
+    rh->routing_type = 3;
+    rh->seg_left = 1;
+    uip_ipaddr_copy((uip_ipaddr_t *)(udp + SRH_ADDR_OFFSET),
+                    dest);
+    uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, via);
+    udp += SRH_LEN;
+  } else {
+    UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  }
+  udp[0] = 0x12;
+  udp[1] = 0x34;
+  udp[2] = 0x56;
+  udp[3] = 0x78;
+  udp[4] = (UIP_UDPH_LEN + payload_len) >> 8;
+  udp[5] = (UIP_UDPH_LEN + payload_len) & 0xff;
+  udp[6] = 0xbe;
+  udp[7] = 0xef;
+  for(i = 0; i < payload_len; i++) {
+    udp[UIP_UDPH_LEN + i] = i * 7 + 3;
+  }
+  uip_len = udp + UIP_UDPH_LEN + payload_len - uip_buf;
+  uipbuf_set_len_field(UIP_IP_BUF, uip_len - UIP_IPH_LEN);
+  memcpy(orig, uip_buf, uip_len);
+  orig_len = uip_len;
+
+  sent.num = 0;
+  out = &sent;
+  routing = 0;
+  NETSTACK_NETWORK.output(&router);
+}
+/*---------------------------------------------------------------------------*/
+/* Feeds a frame to 6LoWPAN, as coming from the given node */
+static void
+receive_frame(const struct frames *f, int i, uint8_t sender)
+{
+  linkaddr_t addr;
+
+  memset(&addr, sender, sizeof(addr));
+  packetbuf_clear();
+  packetbuf_copyfrom(f->data[i], f->len[i]);
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &addr);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &linkaddr_node_addr);
+  NETSTACK_NETWORK.input();
+}
+/*---------------------------------------------------------------------------*/
+/* Has the next hop receive what the router forwarded */
+static void
+deliver_forwarded(void)
+{
+  int i;
+
+  routing = 0;
+  received_len = 0;
+  for(i = 0; i < forwarded.num; i++) {
+    receive_frame(&forwarded, i, 4);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+all_to_next_hop(void)
+{
+  int i;
+
+  for(i = 0; i < forwarded.num; i++) {
+    if(!linkaddr_cmp(&forwarded.dest[i], &next_hop)) {
+      return 0;
+    }
+  }
+  return forwarded.num > 0;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_in_order, "Forwarding fragment by fragment");
+UNIT_TEST(test_in_order)
+{
+  uip_ipaddr_t dest;
+  uint16_t forwarded_before = sicslowpan_get_reass_stats()->forwarded;
+  uint16_t completed_before = sicslowpan_get_reass_stats()->completed;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  uip_ip6addr(&dest, 0x2001, 0xdb8, 0, 0, 0, 0, 0, 2);
+  send_datagram(&dest, NULL, 1000);
+  UNIT_TEST_ASSERT(sent.num > 3);
+
+  /* With the first fragment and a subsequent one received twice */
+  forwarded.num = 0;
+  out = &forwarded;
+  routing = 1;
+  sniffed_num = 0;
+  for(i = 0; i < sent.num; i++) {
+    receive_frame(&sent, i, 5);
+    if(i == 1) {
+      receive_frame(&sent, 0, 5);
+      receive_frame(&sent, 1, 5);
+    }
+  }
+
+  /* Each fragment went on once, without reassembly */
+  UNIT_TEST_ASSERT(forwarded.num == sent.num);
+  UNIT_TEST_ASSERT(all_to_next_hop());
+  UNIT_TEST_ASSERT(sicslowpan_get_reass_stats()->forwarded == forwarded_before + 1);
+  UNIT_TEST_ASSERT(sicslowpan_get_reass_stats()->completed == completed_before);
+  /* The IP layer got the first fragment as any received packet */
+  UNIT_TEST_ASSERT(sniffed_num == 1);
+  UNIT_TEST_ASSERT(sniffed_proto == UIP_PROTO_UDP);
+
+  deliver_forwarded();
+  ORIG_IP_BUF->ttl--;
+  UNIT_TEST_ASSERT(received_len == orig_len);
+  UNIT_TEST_ASSERT(memcmp(received, orig, orig_len) == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_out_of_order, "Reassembly of out of order fragments");
+UNIT_TEST(test_out_of_order)
+{
+  uip_ipaddr_t dest;
+  uint16_t forwarded_before = sicslowpan_get_reass_stats()->forwarded;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  uip_ip6addr(&dest, 0x2001, 0xdb8, 0, 0, 0, 0, 0, 2);
+  send_datagram(&dest, NULL, 600);
+
+  /* Fragments before the first one: the datagram is reassembled */
+  forwarded.num = 0;
+  out = &forwarded;
+  routing = 1;
+  for(i = sent.num - 1; i >= 0; i--) {
+    receive_frame(&sent, i, 5);
+  }
+  UNIT_TEST_ASSERT(all_to_next_hop());
+  UNIT_TEST_ASSERT(sicslowpan_get_reass_stats()->forwarded == forwarded_before);
+
+  deliver_forwarded();
+  ORIG_IP_BUF->ttl--;
+  UNIT_TEST_ASSERT(received_len == orig_len);
+  UNIT_TEST_ASSERT(memcmp(received, orig, orig_len) == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_new_dest, "Forwarding with the destination rewritten");
+UNIT_TEST(test_new_dest)
+{
+  uip_ipaddr_t dest;
+  uip_ipaddr_t rewritten;
+  uint16_t forwarded_before = sicslowpan_get_reass_stats()->forwarded;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  uip_ip6addr(&dest, 0x2001, 0xdb8, 0, 0, 0, 0, 0, 2);
+  uip_ip6addr(&rewritten, 0x2001, 0xdb8, 0, 0, 0, 0, 0, 3);
+  send_datagram(&dest, NULL, 1000);
+
+  forwarded.num = 0;
+  out = &forwarded;
+  routing = 1;
+  new_dest = &rewritten;
+  for(i = 0; i < sent.num; i++) {
+    receive_frame(&sent, i, 5);
+  }
+  new_dest = NULL;
+  UNIT_TEST_ASSERT(forwarded.num == sent.num);
+  UNIT_TEST_ASSERT(all_to_next_hop());
+  UNIT_TEST_ASSERT(sicslowpan_get_reass_stats()->forwarded == forwarded_before + 1);
+
+  deliver_forwarded();
+  ORIG_IP_BUF->ttl--;
+  uip_ipaddr_copy(&ORIG_IP_BUF->destipaddr, &rewritten);
+  UNIT_TEST_ASSERT(received_len == orig_len);
+  UNIT_TEST_ASSERT(memcmp(received, orig, orig_len) == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_source_route, "Forwarding on a source route");
+UNIT_TEST(test_source_route)
+{
+  uip_ipaddr_t dest;
+  uint16_t forwarded_before = sicslowpan_get_reass_stats()->forwarded;
+  struct uip_routing_hdr *rh;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  /* Addressed to the router, with the final destination in the routing
+   * header */
+  uip_ip6addr(&dest, 0x2001, 0xdb8, 0, 0, 0, 0, 0, 2);
+  send_datagram(&dest, &router_addr, 1000);
+
+  forwarded.num = 0;
+  out = &forwarded;
+  routing = 1;
+  for(i = 0; i < sent.num; i++) {
+    receive_frame(&sent, i, 5);
+  }
+  UNIT_TEST_ASSERT(forwarded.num == sent.num);
+  UNIT_TEST_ASSERT(all_to_next_hop());
+  UNIT_TEST_ASSERT(sicslowpan_get_reass_stats()->forwarded == forwarded_before + 1);
+
+  deliver_forwarded();
+  ORIG_IP_BUF->ttl--;
+  uip_ipaddr_copy(&ORIG_IP_BUF->destipaddr, &dest);
+  rh = (struct uip_routing_hdr *)(orig + UIP_IPH_LEN);
+  rh->seg_left = 0;
+  uip_ipaddr_copy((uip_ipaddr_t *)((uint8_t *)rh + SRH_ADDR_OFFSET),
+                  &router_addr);
+  UNIT_TEST_ASSERT(received_len == orig_len);
+  UNIT_TEST_ASSERT(memcmp(received, orig, orig_len) == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(forwarding_test_process, ev, data)
+{
+  uip_ipaddr_t ipaddr;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  netstack_ip_packet_processor_add(&ip_processor);
+  netstack_sniffer_add(&sniffer);
+
+  /* The next hop, as the default router */
+  uip_ip6addr(&ipaddr, 0xfe80, 0, 0, 0, 0x0103, 0x0303, 0x0303, 0x0303);
+  uip_ds6_nbr_add(&ipaddr, (const uip_lladdr_t *)&next_hop, 0,
+                  NBR_REACHABLE, NBR_TABLE_REASON_UNDEFINED, NULL);
+  uip_ds6_defrt_add(&ipaddr, 0);
+
+  /* A global address of the router */
+  uip_ip6addr(&router_addr, 0x2001, 0xdb8, 0, 0, 0, 0, 0, 0x100);
+  uip_ds6_addr_add(&router_addr, 0, ADDR_MANUAL);
+
+  UNIT_TEST_RUN(test_in_order);
+  UNIT_TEST_RUN(test_out_of_order);
+  UNIT_TEST_RUN(test_new_dest);
+  UNIT_TEST_RUN(test_source_route);
+
+  printf("=check-me= DONE\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
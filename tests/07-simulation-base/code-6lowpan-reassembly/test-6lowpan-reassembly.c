@@ -0,0 +1,507 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Feeds the fragments of datagrams to 6LoWPAN out of order, duplicated,
+ * overlapping, or interleaved with other datagrams, and checks the
+ * reassembled datagrams and the reassembly statistics. A MAC driver of
+ * the test keeps the fragments the node sends, which are then fed back
+ * to 6LoWPAN as coming from other nodes.
+ */
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/sicslowpan.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/mac/mac.h"
+#include "services/unit-test/unit-test.h"
+
+#include <string.h>
+#include <stdio.h>
+/*---------------------------------------------------------------------------*/
+PROCESS(reassembly_test_process, "6LoWPAN reassembly test process");
+AUTOSTART_PROCESSES(&reassembly_test_process);
+/*---------------------------------------------------------------------------*/
+#define MAX_FRAMES 16
+#define MAX_FRAME_LEN 80
+#define PAYLOAD_LEN 300
+
+#define FRAGN_HDR_LEN 5
+#define REASS_TIMEOUT (SICSLOWPAN_CONF_MAXAGE * CLOCK_SECOND / 16)
+
+/* A datagram, and the fragments it was sent as */
+struct datagram {
+  uint8_t orig[UIP_BUFSIZE];
+  uint16_t orig_len;
+  int num;
+  uint8_t data[MAX_FRAMES][MAX_FRAME_LEN];
+  int len[MAX_FRAMES];
+};
+
+static struct datagram dg_a, dg_b, dg_c;
+static struct datagram *out;
+
+/* The last datagram the IP layer got, and the number it got */
+static uint8_t received[UIP_BUFSIZE];
+static uint16_t received_len;
+static int received_num;
+
+static struct sicslowpan_reass_stats before;
+#define STATS sicslowpan_get_reass_stats()
+/*---------------------------------------------------------------------------*/
+/* A MAC driver that keeps the frames */
+static void
+mac_init(void)
+{
+}
+static void
+mac_send(mac_callback_t sent_callback, void *ptr)
+{
+  if(out->num < MAX_FRAMES && packetbuf_datalen() <= MAX_FRAME_LEN) {
+    memcpy(out->data[out->num], packetbuf_dataptr(), packetbuf_datalen());
+    out->len[out->num] = packetbuf_datalen();
+    out->num++;
+  }
+  sent_callback(ptr, MAC_TX_OK, 1);
+}
+static void
+mac_input(void)
+{
+}
+static int
+mac_on(void)
+{
+  return 1;
+}
+static int
+mac_off(void)
+{
+  return 1;
+}
+static int
+mac_max_payload(void)
+{
+  return MAX_FRAME_LEN;
+}
+const struct mac_driver test_mac_driver = {
+  "test", mac_init, mac_send, mac_input, mac_on, mac_off, mac_max_payload
+};
+/*---------------------------------------------------------------------------*/
+/* Keeps what the IP layer gets instead of processing it */
+static enum netstack_ip_action
+ip_input(void)
+{
+  memcpy(received, uip_buf, uip_len);
+  received_len = uip_len;
+  received_num++;
+  return NETSTACK_IP_DROP;
+}
+static struct netstack_ip_packet_processor ip_processor = {
+  .process_input = ip_input,
+};
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Builds a UDP datagram from 2001:db8::1 to 2001:db8::2 and sends it as
+ * fragments, each datagram with its own tag */
+static void
+send_datagram(struct datagram *d)
+{
+  static const linkaddr_t dest = { { 2, 2, 2, 2, 2, 2, 2, 2 } };
+  uint8_t *udp = uip_buf + UIP_IPH_LEN;
+  uint16_t i;
+
+  memset(uip_buf, 0, UIP_IPH_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->ttl = 64;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  uip_ip6addr(&UIP_IP_BUF->srcipaddr, 0x2001, 0xdb8, 0, 0, 0, 0, 0, 1);
+  uip_ip6addr(&UIP_IP_BUF->destipaddr, 0x2001, 0xdb8, 0, 0, 0, 0, 0, 2);
+  udp[0] = 0x12;
+  udp[1] = 0x34;
+  udp[2] = 0x56;
+  udp[3] = 0x78;
+  udp[4] = (UIP_UDPH_LEN + PAYLOAD_LEN) >> 8;
+  udp[5] = (UIP_UDPH_LEN + PAYLOAD_LEN) & 0xff;
+  udp[6] = 0xbe;
+  udp[7] = 0xef;
+  for(i = 0; i < PAYLOAD_LEN; i++) {
+    udp[UIP_UDPH_LEN + i] = i * 7 + (d - &dg_a);
+  }
+  uip_len = UIP_IPH_LEN + UIP_UDPH_LEN + PAYLOAD_LEN;
+  uipbuf_set_len_field(UIP_IP_BUF, uip_len - UIP_IPH_LEN);
+  memcpy(d->orig, uip_buf, uip_len);
+  d->orig_len = uip_len;
+
+  d->num = 0;
+  out = d;
+  NETSTACK_NETWORK.output(&dest);
+}
+/*---------------------------------------------------------------------------*/
+/* Feeds a frame to 6LoWPAN, as coming from the given node */
+static void
+receive(const uint8_t *data, int len, uint8_t sender)
+{
+  linkaddr_t addr;
+
+  memset(&addr, sender, sizeof(addr));
+  packetbuf_clear();
+  packetbuf_copyfrom(data, len);
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &addr);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &linkaddr_node_addr);
+  NETSTACK_NETWORK.input();
+}
+/*---------------------------------------------------------------------------*/
+static void
+receive_frame(const struct datagram *d, int i, uint8_t sender)
+{
+  receive(d->data[i], d->len[i], sender);
+}
+/*---------------------------------------------------------------------------*/
+/* Feeds a FRAGN of the datagram with the given offset and length, in
+ * bytes, which need not match the fragments it was sent as */
+static void
+receive_fragn(const struct datagram *d, uint16_t offset, uint16_t len,
+              uint8_t sender)
+{
+  uint8_t frame[MAX_FRAME_LEN];
+
+  /* The size and tag of the second fragment, which is a FRAGN */
+  memcpy(frame, d->data[1], FRAGN_HDR_LEN - 1);
+  frame[FRAGN_HDR_LEN - 1] = offset / 8;
+  memcpy(frame + FRAGN_HDR_LEN, d->orig + offset, len);
+  receive(frame, FRAGN_HDR_LEN + len, sender);
+}
+/*---------------------------------------------------------------------------*/
+/* The offset of a FRAGN, in bytes */
+static uint16_t
+fragn_offset(const struct datagram *d, int i)
+{
+  return d->data[i][FRAGN_HDR_LEN - 1] * 8;
+}
+/*---------------------------------------------------------------------------*/
+static int
+received_is(const struct datagram *d)
+{
+  return received_len == d->orig_len &&
+         memcmp(received, d->orig, d->orig_len) == 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+wait(clock_time_t t)
+{
+  clock_time_t start = clock_time();
+  while(clock_time() - start <= t);
+}
+/*---------------------------------------------------------------------------*/
+static void
+start_test(void)
+{
+  memcpy(&before, STATS, sizeof(before));
+  received_len = 0;
+  received_num = 0;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_out_of_order, "Out of order fragments");
+UNIT_TEST(test_out_of_order)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  start_test();
+  send_datagram(&dg_a);
+  UNIT_TEST_ASSERT(dg_a.num > 3);
+
+  /* The fragments in reverse order: the first one comes last */
+  for(i = dg_a.num - 1; i >= 0; i--) {
+    UNIT_TEST_ASSERT(received_num == 0);
+    receive_frame(&dg_a, i, 5);
+  }
+  UNIT_TEST_ASSERT(received_num == 1);
+  UNIT_TEST_ASSERT(received_is(&dg_a));
+
+  /* The first fragment in between the others */
+  send_datagram(&dg_a);
+  for(i = 1; i < dg_a.num; i++) {
+    receive_frame(&dg_a, i, 5);
+    if(i == 2) {
+      receive_frame(&dg_a, 0, 5);
+    }
+  }
+  UNIT_TEST_ASSERT(received_num == 2);
+  UNIT_TEST_ASSERT(received_is(&dg_a));
+
+  UNIT_TEST_ASSERT(STATS->started == before.started + 2);
+  UNIT_TEST_ASSERT(STATS->completed == before.completed + 2);
+  UNIT_TEST_ASSERT(STATS->duplicates == before.duplicates);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_duplicates, "Duplicate fragments");
+UNIT_TEST(test_duplicates)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  start_test();
+  send_datagram(&dg_a);
+
+  /* The first fragment and a subsequent one received twice */
+  for(i = 0; i < dg_a.num; i++) {
+    receive_frame(&dg_a, i, 5);
+    if(i == 1) {
+      receive_frame(&dg_a, 0, 5);
+      receive_frame(&dg_a, 1, 5);
+    }
+  }
+  UNIT_TEST_ASSERT(received_num == 1);
+  UNIT_TEST_ASSERT(received_is(&dg_a));
+
+  UNIT_TEST_ASSERT(STATS->started == before.started + 1);
+  UNIT_TEST_ASSERT(STATS->completed == before.completed + 1);
+  UNIT_TEST_ASSERT(STATS->duplicates == before.duplicates + 2);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_overlapping, "Overlapping fragments");
+UNIT_TEST(test_overlapping)
+{
+  uint16_t start1, start2;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  start_test();
+  send_datagram(&dg_a);
+  start1 = fragn_offset(&dg_a, 1);
+  start2 = fragn_offset(&dg_a, 2);
+
+  receive_frame(&dg_a, 0, 5);
+  receive_frame(&dg_a, 1, 5);
+  /* Within the second fragment: a duplicate */
+  receive_fragn(&dg_a, start1 + 8, 16, 5);
+  UNIT_TEST_ASSERT(STATS->duplicates == before.duplicates + 1);
+  /* Across the second and third fragments: new blocks */
+  receive_fragn(&dg_a, start2 - 8, 16, 5);
+  UNIT_TEST_ASSERT(STATS->duplicates == before.duplicates + 1);
+  /* The third fragment, now partly received */
+  for(i = 2; i < dg_a.num; i++) {
+    receive_frame(&dg_a, i, 5);
+  }
+  UNIT_TEST_ASSERT(received_num == 1);
+  UNIT_TEST_ASSERT(received_is(&dg_a));
+
+  UNIT_TEST_ASSERT(STATS->started == before.started + 1);
+  UNIT_TEST_ASSERT(STATS->completed == before.completed + 1);
+  UNIT_TEST_ASSERT(STATS->duplicates == before.duplicates + 1);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_interleaved, "Interleaved datagrams");
+UNIT_TEST(test_interleaved)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  start_test();
+  send_datagram(&dg_a);
+  send_datagram(&dg_b);
+
+  /* Two datagrams with the same tag from two senders */
+  for(i = 0; i < dg_a.num; i++) {
+    receive_frame(&dg_a, i, 5);
+    receive_frame(&dg_a, i, 6);
+  }
+  UNIT_TEST_ASSERT(received_num == 2);
+  UNIT_TEST_ASSERT(received_is(&dg_a));
+
+  /* Two datagrams from the same sender */
+  for(i = dg_a.num - 1; i >= 0; i--) {
+    receive_frame(&dg_a, i, 5);
+    receive_frame(&dg_b, i, 5);
+  }
+  UNIT_TEST_ASSERT(received_num == 4);
+  UNIT_TEST_ASSERT(received_is(&dg_b));
+
+  UNIT_TEST_ASSERT(STATS->started == before.started + 4);
+  UNIT_TEST_ASSERT(STATS->completed == before.completed + 4);
+  UNIT_TEST_ASSERT(STATS->duplicates == before.duplicates);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_no_context, "No reassembly context left");
+UNIT_TEST(test_no_context)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  start_test();
+  send_datagram(&dg_a);
+  send_datagram(&dg_b);
+  send_datagram(&dg_c);
+
+  /* A third datagram while two are being reassembled is dropped */
+  receive_frame(&dg_a, 0, 5);
+  receive_frame(&dg_b, 0, 6);
+  receive_frame(&dg_c, 0, 7);
+  UNIT_TEST_ASSERT(STATS->no_context == before.no_context + 1);
+  UNIT_TEST_ASSERT(STATS->evicted == before.evicted);
+
+  /* Which does not disturb the others */
+  for(i = 1; i < dg_a.num; i++) {
+    receive_frame(&dg_a, i, 5);
+    receive_frame(&dg_b, i, 6);
+  }
+  UNIT_TEST_ASSERT(received_num == 2);
+  UNIT_TEST_ASSERT(received_is(&dg_b));
+
+  UNIT_TEST_ASSERT(STATS->started == before.started + 2);
+  UNIT_TEST_ASSERT(STATS->completed == before.completed + 2);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_evict_stalled, "Eviction of a stalled reassembly");
+UNIT_TEST(test_evict_stalled)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  start_test();
+  send_datagram(&dg_a);
+  send_datagram(&dg_b);
+  send_datagram(&dg_c);
+
+  /* The first datagram stalls, the second goes on */
+  receive_frame(&dg_a, 0, 5);
+  receive_frame(&dg_a, 1, 5);
+  receive_frame(&dg_b, 0, 6);
+  wait(SICSLOWPAN_CONF_REASS_IDLE_TIMEOUT);
+  receive_frame(&dg_b, 1, 6);
+
+  /* A third datagram takes the context of the stalled one, before it
+     times out */
+  receive_frame(&dg_c, 0, 7);
+  UNIT_TEST_ASSERT(STATS->evicted == before.evicted + 1);
+  UNIT_TEST_ASSERT(STATS->no_context == before.no_context);
+  UNIT_TEST_ASSERT(STATS->timed_out == before.timed_out);
+
+  for(i = 1; i < dg_c.num; i++) {
+    receive_frame(&dg_c, i, 7);
+  }
+  UNIT_TEST_ASSERT(received_num == 1);
+  UNIT_TEST_ASSERT(received_is(&dg_c));
+  for(i = 2; i < dg_b.num; i++) {
+    receive_frame(&dg_b, i, 6);
+  }
+  UNIT_TEST_ASSERT(received_num == 2);
+  UNIT_TEST_ASSERT(received_is(&dg_b));
+
+  UNIT_TEST_ASSERT(STATS->started == before.started + 3);
+  UNIT_TEST_ASSERT(STATS->completed == before.completed + 2);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_timeout, "Reassembly timeout");
+UNIT_TEST(test_timeout)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  start_test();
+  send_datagram(&dg_a);
+  send_datagram(&dg_b);
+
+  /* A reassembly that times out is dropped when the next one starts */
+  for(i = 0; i < dg_a.num - 1; i++) {
+    receive_frame(&dg_a, i, 5);
+  }
+  wait(REASS_TIMEOUT);
+  receive_frame(&dg_b, 0, 6);
+  UNIT_TEST_ASSERT(STATS->timed_out == before.timed_out + 1);
+  UNIT_TEST_ASSERT(STATS->evicted == before.evicted);
+
+  /* The last fragment of the dropped datagram does not complete it */
+  receive_frame(&dg_a, dg_a.num - 1, 5);
+  UNIT_TEST_ASSERT(received_num == 0);
+
+  for(i = 1; i < dg_b.num; i++) {
+    receive_frame(&dg_b, i, 6);
+  }
+  UNIT_TEST_ASSERT(received_num == 1);
+  UNIT_TEST_ASSERT(received_is(&dg_b));
+
+  UNIT_TEST_ASSERT(STATS->started == before.started + 3);
+  UNIT_TEST_ASSERT(STATS->completed == before.completed + 1);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(reassembly_test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  netstack_ip_packet_processor_add(&ip_processor);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_out_of_order);
+  UNIT_TEST_RUN(test_duplicates);
+  UNIT_TEST_RUN(test_overlapping);
+  UNIT_TEST_RUN(test_interleaved);
+  UNIT_TEST_RUN(test_no_context);
+  UNIT_TEST_RUN(test_evict_stalled);
+  UNIT_TEST_RUN(test_timeout);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
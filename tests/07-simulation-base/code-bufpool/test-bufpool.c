@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-bufpool.h"
+#include "net/ipv6/uip-packetqueue.h"
+#include "services/unit-test/unit-test.h"
+
+#include <string.h>
+#include <stdio.h>
+/*---------------------------------------------------------------------------*/
+PROCESS(bufpool_test_process, "Buffer pool test process");
+AUTOSTART_PROCESSES(&bufpool_test_process);
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+fill_packet(uint8_t seed, uint16_t len)
+{
+  uint16_t i;
+
+  for(i = 0; i < len; i++) {
+    uip_buf[i] = seed + i;
+  }
+  uip_len = len;
+}
+/*---------------------------------------------------------------------------*/
+static int
+check_packet(uint8_t seed, uint16_t len)
+{
+  uint16_t i;
+
+  if(uip_len != len) {
+    return 0;
+  }
+  for(i = 0; i < len; i++) {
+    if(uip_buf[i] != (uint8_t)(seed + i)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_refcount, "Reference counting");
+UNIT_TEST(test_refcount)
+{
+  uip_buf_t *buf;
+  uip_buf_t other;
+
+  UNIT_TEST_BEGIN();
+
+  /* uip_buf holds the only buffer in use */
+  UNIT_TEST_ASSERT(uip_bufpool_num_free() == UIP_BUF_POOL_SIZE - 1);
+
+  buf = uip_bufpool_alloc();
+  UNIT_TEST_ASSERT(buf != NULL && buf != uip_current_buf);
+  UNIT_TEST_ASSERT(uip_bufpool_num_free() == UIP_BUF_POOL_SIZE - 2);
+
+  /* The buffer returns to the pool with the last reference */
+  uip_bufpool_ref(buf);
+  uip_bufpool_unref(buf);
+  UNIT_TEST_ASSERT(uip_bufpool_num_free() == UIP_BUF_POOL_SIZE - 2);
+  uip_bufpool_unref(buf);
+  UNIT_TEST_ASSERT(uip_bufpool_num_free() == UIP_BUF_POOL_SIZE - 1);
+
+  /* Extra releases, and buffers from outside the pool, are ignored */
+  uip_bufpool_unref(buf);
+  uip_bufpool_unref(&other);
+  uip_bufpool_ref(&other);
+  UNIT_TEST_ASSERT(uip_bufpool_num_free() == UIP_BUF_POOL_SIZE - 1);
+  UNIT_TEST_ASSERT(uip_bufpool_alloc() == buf);
+  uip_bufpool_unref(buf);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_exhaustion, "Pool exhaustion");
+UNIT_TEST(test_exhaustion)
+{
+  uip_buf_t *bufs[UIP_BUF_POOL_SIZE];
+  uip_buf_t *current = uip_current_buf;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < UIP_BUF_POOL_SIZE - 1; i++) {
+    bufs[i] = uip_bufpool_alloc();
+    UNIT_TEST_ASSERT(bufs[i] != NULL);
+  }
+  UNIT_TEST_ASSERT(uip_bufpool_num_free() == 0);
+  UNIT_TEST_ASSERT(uip_bufpool_alloc() == NULL);
+
+  /* Without a free buffer, the packet stays in uip_buf */
+  fill_packet(1, 64);
+  UNIT_TEST_ASSERT(uip_bufpool_detach() == NULL);
+  UNIT_TEST_ASSERT(uip_current_buf == current);
+  UNIT_TEST_ASSERT(check_packet(1, 64));
+
+  uip_bufpool_unref(bufs[0]);
+  UNIT_TEST_ASSERT(uip_bufpool_alloc() == bufs[0]);
+
+  for(i = 0; i < UIP_BUF_POOL_SIZE - 1; i++) {
+    uip_bufpool_unref(bufs[i]);
+  }
+  UNIT_TEST_ASSERT(uip_bufpool_num_free() == UIP_BUF_POOL_SIZE - 1);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_detach_attach, "Detach and attach");
+UNIT_TEST(test_detach_attach)
+{
+  uip_buf_t *current = uip_current_buf;
+  uip_buf_t *buf;
+
+  UNIT_TEST_BEGIN();
+
+  fill_packet(2, 100);
+  buf = uip_bufpool_detach();
+  UNIT_TEST_ASSERT(buf == current && uip_current_buf != current);
+  UNIT_TEST_ASSERT(uip_bufpool_num_free() == UIP_BUF_POOL_SIZE - 2);
+
+  /* uip_buf is free for another packet meanwhile */
+  fill_packet(3, 20);
+
+  /* Attaching releases the fresh buffer, and the packet is back */
+  uip_len = 100;
+  uip_bufpool_attach(buf);
+  UNIT_TEST_ASSERT(uip_current_buf == current);
+  UNIT_TEST_ASSERT(check_packet(2, 100));
+  UNIT_TEST_ASSERT(uip_bufpool_num_free() == UIP_BUF_POOL_SIZE - 1);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_packetqueue, "Packet queue on the pool");
+UNIT_TEST(test_packetqueue)
+{
+  static struct uip_packetqueue_handle h[UIP_PACKETQUEUE_NUM];
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < UIP_PACKETQUEUE_NUM; i++) {
+    uip_packetqueue_new(&h[i]);
+  }
+
+  /* Each queued packet takes a buffer */
+  for(i = 0; i < UIP_BUF_POOL_SIZE - 1; i++) {
+    fill_packet(10 * i, 50 + i);
+    UNIT_TEST_ASSERT(uip_packetqueue_alloc(&h[i], CLOCK_SECOND) != NULL);
+    UNIT_TEST_ASSERT(uip_packetqueue_save(&h[i]));
+    UNIT_TEST_ASSERT(uip_packetqueue_buflen(&h[i]) == 50 + i);
+  }
+  UNIT_TEST_ASSERT(uip_bufpool_num_free() == 0);
+
+  /* The queue has room for one more, but the pool is exhausted */
+  fill_packet(99, 30);
+  UNIT_TEST_ASSERT(uip_packetqueue_alloc(&h[i], CLOCK_SECOND) != NULL);
+  UNIT_TEST_ASSERT(!uip_packetqueue_save(&h[i]));
+  UNIT_TEST_ASSERT(check_packet(99, 30));
+  uip_packetqueue_free(&h[i]);
+
+  /* Restoring moves the buffer back to uip_buf */
+  UNIT_TEST_ASSERT(uip_packetqueue_restore(&h[0]));
+  UNIT_TEST_ASSERT(check_packet(0, 50));
+  UNIT_TEST_ASSERT(h[0].packet == NULL);
+  UNIT_TEST_ASSERT(!uip_packetqueue_restore(&h[0]));
+  UNIT_TEST_ASSERT(uip_bufpool_num_free() == 1);
+
+  /* Freeing a queued packet releases its buffer */
+  uip_packetqueue_free(&h[1]);
+  UNIT_TEST_ASSERT(uip_bufpool_num_free() == UIP_BUF_POOL_SIZE - 1);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(bufpool_test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_refcount);
+  UNIT_TEST_RUN(test_exhaustion);
+  UNIT_TEST_RUN(test_detach_attach);
+  UNIT_TEST_RUN(test_packetqueue);
+
+  printf("=check-me= DONE\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Checks the incremental checksum update (RFC 1624) used by ip64
+ * against a full recompute, for address and port rewrites.
+ */
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "lib/random.h"
+#include "services/unit-test/unit-test.h"
+
+#include <string.h>
+#include <stdio.h>
+/*---------------------------------------------------------------------------*/
+PROCESS(chksum_test_process, "Checksum test process");
+AUTOSTART_PROCESSES(&chksum_test_process);
+/*---------------------------------------------------------------------------*/
+#define ROUNDS            1000
+#define MAX_SEGMENT_LEN   200
+#define UDP_HDR_LEN       8
+#define UDP_CHKSUM_OFFSET 6
+
+/* The rewritten packet: addresses of the pseudo header, then the
+   transport header and payload. The protocol and length fields of the
+   pseudo header are not rewritten. */
+struct packet {
+  uint8_t addrs[2 * sizeof(uip_ip6addr_t)];
+  uint16_t addrlen;
+  uint8_t segment[MAX_SEGMENT_LEN];
+  uint16_t len;
+};
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* The original byte pair implementation, as a reference */
+static uint16_t
+ref_chksum(uint16_t sum, const uint8_t *data, uint16_t len)
+{
+  uint16_t t;
+
+  for(; len >= 2; len -= 2, data += 2) {
+    t = (data[0] << 8) + data[1];
+    sum += t;
+    if(sum < t) {
+      sum++;
+    }
+  }
+  if(len == 1) {
+    t = data[0] << 8;
+    sum += t;
+    if(sum < t) {
+      sum++;
+    }
+  }
+  return sum;
+}
+/*---------------------------------------------------------------------------*/
+/* 0x0000 and 0xffff are both zero in one's complement */
+static int
+same_sum(uint16_t a, uint16_t b)
+{
+  return a == b || ((uint16_t)(a + 1) <= 1 && (uint16_t)(b + 1) <= 1);
+}
+/*---------------------------------------------------------------------------*/
+static void
+fill_random(uint8_t *data, uint16_t len)
+{
+  while(len--) {
+    *data++ = random_rand();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+get_chksum(const struct packet *p)
+{
+  return (p->segment[UDP_CHKSUM_OFFSET] << 8) |
+    p->segment[UDP_CHKSUM_OFFSET + 1];
+}
+/*---------------------------------------------------------------------------*/
+static void
+set_chksum(struct packet *p, uint16_t chksum)
+{
+  p->segment[UDP_CHKSUM_OFFSET] = chksum >> 8;
+  p->segment[UDP_CHKSUM_OFFSET + 1] = chksum & 0xff;
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+packet_sum(const struct packet *p)
+{
+  uint16_t sum;
+
+  sum = p->len + UIP_PROTO_UDP;
+  sum = uip_chksum_add(sum, p->addrs, p->addrlen);
+  return uip_chksum_add(sum, p->segment, p->len);
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+full_chksum(struct packet *p)
+{
+  uint16_t old, chksum;
+
+  old = get_chksum(p);
+  set_chksum(p, 0);
+  chksum = ~packet_sum(p);
+  set_chksum(p, old);
+  return chksum;
+}
+/*---------------------------------------------------------------------------*/
+static void
+random_packet(struct packet *p, uint16_t addrlen)
+{
+  p->addrlen = addrlen;
+  fill_random(p->addrs, addrlen);
+  p->len = UDP_HDR_LEN + random_rand() % (MAX_SEGMENT_LEN - UDP_HDR_LEN);
+  fill_random(p->segment, p->len);
+  set_chksum(p, full_chksum(p));
+}
+/*---------------------------------------------------------------------------*/
+/* Rewrite the addresses and the ports as ip64 does, and update the
+   checksum from the sums of the old and the new words */
+static void
+rewrite(struct packet *p, const uint8_t *addrs, uint16_t addrlen,
+        const uint8_t *ports)
+{
+  uint16_t old_sum, new_sum;
+
+  old_sum = uip_chksum_add(0, p->addrs, p->addrlen);
+  old_sum = uip_chksum_add(old_sum, p->segment, 4);
+  new_sum = uip_chksum_add(0, addrs, addrlen);
+  new_sum = uip_chksum_add(new_sum, ports, 4);
+
+  memcpy(p->addrs, addrs, addrlen);
+  p->addrlen = addrlen;
+  memcpy(p->segment, ports, 4);
+  set_chksum(p, uip_chksum_adjust(get_chksum(p), old_sum, new_sum));
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_chksum_add, "Sum matches the byte pair reference");
+UNIT_TEST(test_chksum_add)
+{
+  static uint8_t data[MAX_SEGMENT_LEN + 8];
+  uint16_t i, offset, len, split, sum;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < ROUNDS; i++) {
+    /* Unaligned data of odd and even lengths */
+    offset = random_rand() % 8;
+    len = random_rand() % MAX_SEGMENT_LEN;
+    fill_random(data, sizeof(data));
+    if(i % 10 == 0) {
+      memset(data, 0xff, sizeof(data));
+    }
+    sum = random_rand();
+    UNIT_TEST_ASSERT(same_sum(uip_chksum_add(sum, data + offset, len),
+                              ref_chksum(sum, data + offset, len)));
+
+    /* Summed in two chunks, the first of even length */
+    split = (random_rand() % (len + 1)) & ~1;
+    UNIT_TEST_ASSERT(same_sum(uip_chksum_add(uip_chksum_add(sum, data + offset,
+                                                            split),
+                                             data + offset + split,
+                                             len - split),
+                              ref_chksum(sum, data + offset, len)));
+  }
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_port_rewrite, "Incremental update of port rewrites");
+UNIT_TEST(test_port_rewrite)
+{
+  static struct packet p;
+  uint8_t ports[4];
+  uint16_t i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < ROUNDS; i++) {
+    random_packet(&p, sizeof(p.addrs));
+    fill_random(ports, sizeof(ports));
+    if(i % 10 == 0) {
+      memset(ports, i % 20 == 0 ? 0 : 0xff, sizeof(ports));
+    }
+    rewrite(&p, p.addrs, p.addrlen, ports);
+    UNIT_TEST_ASSERT(same_sum(get_chksum(&p), full_chksum(&p)));
+    UNIT_TEST_ASSERT(same_sum(packet_sum(&p), 0xffff));
+  }
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_addr_rewrite, "Incremental update of address rewrites");
+UNIT_TEST(test_addr_rewrite)
+{
+  static struct packet p;
+  uint8_t addrs[sizeof(p.addrs)];
+  uint8_t ports[4];
+  uint16_t i, addrlen;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < ROUNDS; i++) {
+    /* IPv6 to IPv6, IPv6 to IPv4 and IPv4 to IPv6 */
+    random_packet(&p, i % 3 == 2 ? 2 * sizeof(uip_ip4addr_t) : sizeof(p.addrs));
+    addrlen = i % 3 == 1 ? 2 * sizeof(uip_ip4addr_t) : sizeof(p.addrs);
+    fill_random(addrs, addrlen);
+    memcpy(ports, p.segment, sizeof(ports));
+    rewrite(&p, addrs, addrlen, ports);
+    UNIT_TEST_ASSERT(same_sum(get_chksum(&p), full_chksum(&p)));
+    UNIT_TEST_ASSERT(same_sum(packet_sum(&p), 0xffff));
+
+    /* The same rewrite together with a port rewrite */
+    random_packet(&p, sizeof(p.addrs));
+    fill_random(addrs, 2 * sizeof(uip_ip4addr_t));
+    fill_random(ports, sizeof(ports));
+    rewrite(&p, addrs, 2 * sizeof(uip_ip4addr_t), ports);
+    UNIT_TEST_ASSERT(same_sum(get_chksum(&p), full_chksum(&p)));
+    UNIT_TEST_ASSERT(same_sum(packet_sum(&p), 0xffff));
+  }
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(chksum_test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_chksum_add);
+  UNIT_TEST_RUN(test_port_rewrite);
+  UNIT_TEST_RUN(test_addr_rewrite);
+
+  printf("=check-me= DONE\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -33,5 +33,6 @@
 #define PROJECT_CONF_H_
 
 #define UNIT_TEST_PRINT_FUNCTION print_test_report
+#define MEMB_CONF_STATS 1
 
 #endif /* PROJECT_CONF_H_ */
@@ -36,6 +36,7 @@
 #include "lib/circular-list.h"
 #include "lib/dbl-list.h"
 #include "lib/dbl-circ-list.h"
+#include "lib/memb.h"
 #include "lib/random.h"
 #include "services/unit-test/unit-test.h"
 
@@ -1024,6 +1025,54 @@ UNIT_TEST(test_cdll)
   UNIT_TEST_END();
 }
 /*---------------------------------------------------------------------------*/
+#define MEMB_TEST_COUNT 40
+MEMB(test_memb, demo_struct_t, MEMB_TEST_COUNT);
+UNIT_TEST_REGISTER(test_memb_alloc, "Memory block allocation");
+UNIT_TEST(test_memb_alloc)
+{
+  static demo_struct_t *blocks[MEMB_TEST_COUNT];
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  memb_init(&test_memb);
+  UNIT_TEST_ASSERT(memb_numfree(&test_memb) == MEMB_TEST_COUNT);
+
+  /* Allocate all blocks. They should all be distinct blocks of the pool */
+  for(i = 0; i < MEMB_TEST_COUNT; i++) {
+    blocks[i] = memb_alloc(&test_memb);
+    UNIT_TEST_ASSERT(blocks[i] != NULL);
+    UNIT_TEST_ASSERT(memb_inmemb(&test_memb, blocks[i]));
+    UNIT_TEST_ASSERT(i == 0 || blocks[i] != blocks[i - 1]);
+  }
+  UNIT_TEST_ASSERT(memb_numfree(&test_memb) == 0);
+  UNIT_TEST_ASSERT(memb_alloc(&test_memb) == NULL);
+
+  /* Free blocks in both bitmap words, then allocate them again */
+  UNIT_TEST_ASSERT(memb_free(&test_memb, blocks[35]) == 0);
+  UNIT_TEST_ASSERT(memb_free(&test_memb, blocks[3]) == 0);
+  UNIT_TEST_ASSERT(memb_numfree(&test_memb) == 2);
+  UNIT_TEST_ASSERT(memb_alloc(&test_memb) == blocks[3]);
+  UNIT_TEST_ASSERT(memb_alloc(&test_memb) == blocks[35]);
+  UNIT_TEST_ASSERT(memb_alloc(&test_memb) == NULL);
+
+  /* Pointers that are not a block of the pool are rejected */
+  UNIT_TEST_ASSERT(memb_free(&test_memb, &elements[0]) == -1);
+  UNIT_TEST_ASSERT(memb_free(&test_memb, (char *)blocks[1] + 1) == -1);
+
+  /* Freeing a free block has no effect */
+  UNIT_TEST_ASSERT(memb_free(&test_memb, blocks[7]) == 0);
+  UNIT_TEST_ASSERT(memb_free(&test_memb, blocks[7]) == 0);
+  UNIT_TEST_ASSERT(memb_numfree(&test_memb) == 1);
+
+#if MEMB_STATS
+  UNIT_TEST_ASSERT(test_memb.max_used == MEMB_TEST_COUNT);
+  UNIT_TEST_ASSERT(test_memb.failures == 2);
+#endif /* MEMB_STATS */
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
 PROCESS_THREAD(data_structure_test_process, ev, data)
 {
   PROCESS_BEGIN();
@@ -1039,6 +1088,7 @@ PROCESS_THREAD(data_structure_test_process, ev, data)
   UNIT_TEST_RUN(test_csll);
   UNIT_TEST_RUN(test_dll);
   UNIT_TEST_RUN(test_cdll);
+  UNIT_TEST_RUN(test_memb_alloc);
 
   printf("=check-me= DONE\n");
 
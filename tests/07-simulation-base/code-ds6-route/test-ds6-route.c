@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+#include "contiki.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "net/ipv6/uip-ds6-route.h"
+#include "lib/random.h"
+#include "services/unit-test/unit-test.h"
+
+#include <string.h>
+#include <stdio.h>
+/*---------------------------------------------------------------------------*/
+PROCESS(ds6_route_test_process, "DS6 route test process");
+AUTOSTART_PROCESSES(&ds6_route_test_process);
+/*---------------------------------------------------------------------------*/
+#define NUM_NEXTHOPS 4
+#define NUM_ROUNDS 2000
+
+static uip_ipaddr_t nexthops[NUM_NEXTHOPS];
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Get an address from a small address space, so that prefixes overlap */
+static void
+random_addr(uip_ipaddr_t *addr)
+{
+  int i;
+
+  uip_ip6addr(addr, 0xfd00, 0, 0, 0, 0, 0, 0, 0);
+  for(i = 2; i < 16; i++) {
+    addr->u8[i] = random_rand() % 2;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+random_length(void)
+{
+  static const uint8_t lengths[] = { 16, 24, 32, 48, 64, 128 };
+
+  return lengths[random_rand() % sizeof(lengths)];
+}
+/*---------------------------------------------------------------------------*/
+/* The longest matching prefix length, by a linear scan of the routes,
+   or -1 if no route matches */
+static int
+reference_match_length(const uip_ipaddr_t *addr)
+{
+  uip_ds6_route_t *r;
+  int longest = -1;
+
+  for(r = uip_ds6_route_head(); r != NULL; r = uip_ds6_route_next(r)) {
+    if(uip_ipaddr_prefixcmp(addr, &r->ipaddr, r->length)
+       && r->length > longest) {
+      longest = r->length;
+    }
+  }
+  return longest;
+}
+/*---------------------------------------------------------------------------*/
+/* Does the lookup of an address agree with the reference? */
+static int
+lookup_ok(const uip_ipaddr_t *addr)
+{
+  uip_ds6_route_t *r;
+  int longest;
+
+  r = uip_ds6_route_lookup(addr);
+  longest = reference_match_length(addr);
+  if(r == NULL) {
+    return longest == -1;
+  }
+  return r->length == longest
+    && uip_ipaddr_prefixcmp(addr, &r->ipaddr, r->length);
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_all_routes(void)
+{
+  while(uip_ds6_route_head() != NULL) {
+    uip_ds6_route_rm(uip_ds6_route_head());
+  }
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_lookup, "Longest prefix lookup");
+UNIT_TEST(test_lookup)
+{
+  uip_ipaddr_t addr;
+  uip_ds6_route_t *r48, *r64, *r128;
+
+  UNIT_TEST_BEGIN();
+
+  /* Longest first, as adding a route replaces a covering route with
+     another next hop */
+  uip_ip6addr(&addr, 0xfd00, 1, 2, 3, 0, 0, 0, 4);
+  r128 = uip_ds6_route_add(&addr, 128, &nexthops[2]);
+  uip_ip6addr(&addr, 0xfd00, 1, 2, 3, 0, 0, 0, 0);
+  r64 = uip_ds6_route_add(&addr, 64, &nexthops[1]);
+  uip_ip6addr(&addr, 0xfd00, 1, 2, 0, 0, 0, 0, 0);
+  r48 = uip_ds6_route_add(&addr, 48, &nexthops[0]);
+  UNIT_TEST_ASSERT(r48 != NULL && r64 != NULL && r128 != NULL);
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == 3);
+
+  uip_ip6addr(&addr, 0xfd00, 1, 2, 3, 0, 0, 0, 4);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) == r128);
+  uip_ip6addr(&addr, 0xfd00, 1, 2, 3, 0, 0, 0, 5);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) == r64);
+  uip_ip6addr(&addr, 0xfd00, 1, 2, 4, 0, 0, 0, 5);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) == r48);
+  uip_ip6addr(&addr, 0xfd00, 1, 3, 0, 0, 0, 0, 0);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) == NULL);
+
+  /* Prefixes longer than an address are rejected */
+  uip_ip6addr(&addr, 0xfd00, 1, 2, 3, 0, 0, 0, 6);
+  UNIT_TEST_ASSERT(uip_ds6_route_add(&addr, 129, &nexthops[0]) == NULL);
+  UNIT_TEST_ASSERT(uip_ds6_route_add(&addr, 255, &nexthops[0]) == NULL);
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == 3);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) == r64);
+
+  /* Lookups fall back to the shorter prefix once a route is removed */
+  uip_ds6_route_rm(r64);
+  uip_ip6addr(&addr, 0xfd00, 1, 2, 3, 0, 0, 0, 5);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) == r48);
+  uip_ip6addr(&addr, 0xfd00, 1, 2, 3, 0, 0, 0, 4);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) == r128);
+
+  remove_all_routes();
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) == NULL);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_random, "Random route updates");
+UNIT_TEST(test_random)
+{
+  uip_ipaddr_t addr;
+  uip_ds6_route_t *r;
+  int i, j, n;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < NUM_ROUNDS; i++) {
+    random_addr(&addr);
+    if(random_rand() % 3 != 0) {
+      uip_ds6_route_add(&addr, random_length(),
+                        &nexthops[random_rand() % NUM_NEXTHOPS]);
+    } else if(uip_ds6_route_num_routes() > 0) {
+      /* Remove a random route, shifting back index entries */
+      n = random_rand() % uip_ds6_route_num_routes();
+      for(r = uip_ds6_route_head(), j = 0; j < n; j++) {
+        r = uip_ds6_route_next(r);
+      }
+      uip_ds6_route_rm(r);
+    }
+
+    /* Every route is found by its own prefix */
+    for(r = uip_ds6_route_head(); r != NULL; r = uip_ds6_route_next(r)) {
+      UNIT_TEST_ASSERT(uip_ds6_route_lookup(&r->ipaddr) != NULL);
+      UNIT_TEST_ASSERT(uip_ds6_route_lookup(&r->ipaddr)->length >= r->length);
+    }
+    for(j = 0; j < 8; j++) {
+      random_addr(&addr);
+      UNIT_TEST_ASSERT(lookup_ok(&addr));
+    }
+  }
+
+  remove_all_routes();
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(ds6_route_test_process, ev, data)
+{
+  static uip_lladdr_t lladdr;
+  int i;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  for(i = 0; i < NUM_NEXTHOPS; i++) {
+    uip_ip6addr(&nexthops[i], 0xfe80, 0, 0, 0, 0, 0, 0, i + 1);
+    memset(&lladdr, 0, sizeof(lladdr));
+    lladdr.addr[sizeof(lladdr.addr) - 1] = i + 1;
+    uip_ds6_nbr_add(&nexthops[i], &lladdr, 1, NBR_REACHABLE,
+                    NBR_TABLE_REASON_UNDEFINED, NULL);
+  }
+
+  UNIT_TEST_RUN(test_lookup);
+  UNIT_TEST_RUN(test_random);
+
+  printf("=check-me= DONE\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
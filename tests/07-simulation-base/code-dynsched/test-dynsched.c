@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Checks that a schedule received as a delta to the previous version
+ * ends up with the same TSCH links as the same schedule received in
+ * full, on a node and on the coordinator. The dynamic scheduling
+ * service and the TSCH schedule are built into the test, with stubs
+ * for the rest of TSCH.
+ */
+
+#include "contiki.h"
+#include "net/mac/tsch/tsch.h"
+#include "sys/node-id.h"
+#include "services/unit-test/unit-test.h"
+
+#include <stdio.h>
+/*---------------------------------------------------------------------------*/
+/* Stubs for the rest of TSCH */
+struct tsch_link *current_link;
+const linkaddr_t tsch_broadcast_address;
+int tsch_get_lock(void) { return 1; }
+void tsch_release_lock(void) { }
+int tsch_is_locked(void) { return 0; }
+struct tsch_neighbor *tsch_queue_add_nbr(const linkaddr_t *addr) { return NULL; }
+void tsch_queue_tx_links_updated(struct tsch_neighbor *n) { }
+/*---------------------------------------------------------------------------*/
+#include "net/mac/tsch/tsch-schedule.c"
+#undef LOG_MODULE
+#undef LOG_LEVEL
+#include "services/dynsched/infra/dyn_sched.c"
+/*---------------------------------------------------------------------------*/
+PROCESS(dynsched_test_process, "Dynamic scheduling test process");
+AUTOSTART_PROCESSES(&dynsched_test_process);
+/*---------------------------------------------------------------------------*/
+#define NODE_ID           2
+#define SLOTFRAME_HANDLE  0
+#define SLOTFRAME_SIZE    8
+
+/* The links of a slotframe, by timeslot */
+struct snapshot {
+  uint16_t num_links;
+  struct {
+    uint8_t in_use;
+    uint8_t link_options;
+    uint8_t link_type;
+    uint16_t channel_offset;
+  } links[SLOTFRAME_SIZE];
+};
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+take_snapshot(struct snapshot *s)
+{
+  struct tsch_slotframe *sf;
+  struct tsch_link *l;
+  uint16_t ts;
+
+  memset(s, 0, sizeof(*s));
+  sf = tsch_schedule_get_slotframe_by_handle(SLOTFRAME_HANDLE);
+  if(sf == NULL) {
+    return;
+  }
+  s->num_links = list_length(sf->links_list);
+  for(ts = 0; ts < SLOTFRAME_SIZE && ts < sf->size.val; ts++) {
+    l = tsch_schedule_get_link_by_timeslot(sf, ts);
+    if(l != NULL) {
+      s->links[ts].in_use = 1;
+      s->links[ts].link_options = l->link_options;
+      s->links[ts].link_type = l->link_type;
+      s->links[ts].channel_offset = l->channel_offset;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+set_link(struct tsch_slotframe_and_links_link *link, uint8_t op,
+         uint16_t timeslot, uint16_t channel_offset, uint8_t link_options,
+         uint8_t nodeid)
+{
+  link->timeslot = timeslot;
+  link->channel_offset = channel_offset;
+  link->link_options = link_options;
+  link->nodeid = nodeid;
+  link->op = op;
+}
+/*---------------------------------------------------------------------------*/
+static void
+init_ies(struct ieee802154_ies *ies, uint8_t base_version, uint8_t version)
+{
+  memset(ies, 0, sizeof(*ies));
+  ies->ie_tsch_slotframe_and_link.num_slotframes = 1;
+  ies->ie_tsch_slotframe_and_link.slotframe_handle = SLOTFRAME_HANDLE;
+  ies->ie_tsch_slotframe_and_link.slotframe_size = SLOTFRAME_SIZE;
+  ies->ie_tsch_slotframe_and_link.base_version = base_version;
+  ies->ie_tsch_slotframe_and_link.version = version;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_node, "Delta and full schedule on a node");
+UNIT_TEST(test_node)
+{
+  static struct ieee802154_ies ies;
+  static struct snapshot delta, full;
+  struct tsch_slotframe_and_links_link *links;
+
+  UNIT_TEST_BEGIN();
+
+  links = ies.ie_tsch_slotframe_and_link.links;
+
+  /* Version 1, in full. No timeslot matches the index of its link. */
+  init_ies(&ies, 1, 1);
+  set_link(&links[0], FRAME802154E_IE_LINK_OP_ADD, 1, 2, LINK_OPTION_TX, 1);
+  set_link(&links[1], FRAME802154E_IE_LINK_OP_ADD, 3, 1, LINK_OPTION_RX, NODE_ID);
+  set_link(&links[2], FRAME802154E_IE_LINK_OP_ADD, 5, 0, LINK_OPTION_TX, 3);
+  ies.ie_tsch_slotframe_and_link.num_links = 3;
+  UNIT_TEST_ASSERT(dynsched_create_schedule_from_ies(ies) == 1);
+
+  /* Version 2, as a delta to version 1 */
+  init_ies(&ies, 1, 2);
+  set_link(&links[0], FRAME802154E_IE_LINK_OP_REMOVE, 1, 2, LINK_OPTION_TX, 1);
+  set_link(&links[1], FRAME802154E_IE_LINK_OP_MODIFY, 3, 3, LINK_OPTION_TX, 1);
+  set_link(&links[2], FRAME802154E_IE_LINK_OP_ADD, 6, 2, LINK_OPTION_TX, NODE_ID);
+  set_link(&links[3], FRAME802154E_IE_LINK_OP_ADD, 7, 1, LINK_OPTION_TX, 4);
+  ies.ie_tsch_slotframe_and_link.num_links = 4;
+  UNIT_TEST_ASSERT(dynsched_create_schedule_from_ies(ies) == 1);
+  take_snapshot(&delta);
+  UNIT_TEST_ASSERT(delta.num_links == 4);
+
+  /* Version 3, the same schedule in full */
+  init_ies(&ies, 3, 3);
+  set_link(&links[0], FRAME802154E_IE_LINK_OP_ADD, 3, 3, LINK_OPTION_TX, 1);
+  set_link(&links[1], FRAME802154E_IE_LINK_OP_ADD, 5, 0, LINK_OPTION_TX, 3);
+  set_link(&links[2], FRAME802154E_IE_LINK_OP_ADD, 6, 2, LINK_OPTION_TX, NODE_ID);
+  set_link(&links[3], FRAME802154E_IE_LINK_OP_ADD, 7, 1, LINK_OPTION_TX, 4);
+  ies.ie_tsch_slotframe_and_link.num_links = 4;
+  UNIT_TEST_ASSERT(dynsched_create_schedule_from_ies(ies) == 1);
+  take_snapshot(&full);
+
+  UNIT_TEST_ASSERT(memcmp(&delta, &full, sizeof(full)) == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_coordinator, "Delta and full schedule on the coordinator");
+UNIT_TEST(test_coordinator)
+{
+  /* Rows of {timeslot, channel offset, link options, node id}. The
+     slotframe size is the number of links, and no timeslot matches the
+     row of its link. */
+  static uint16_t old_arr[4][4] = {
+    { 2, 1, LINK_OPTION_TX, NODE_ID },
+    { 0, 2, LINK_OPTION_TX, 1 },
+    { 3, 3, LINK_OPTION_RX, NODE_ID },
+    { 1, 1, LINK_OPTION_TX, 3 },
+  };
+  static uint16_t new_arr[4][4] = {
+    { 2, 1, LINK_OPTION_TX, NODE_ID },
+    { 0, 2, LINK_OPTION_TX, NODE_ID },
+    { 3, 2, LINK_OPTION_TX, 4 },
+    { 1, 3, LINK_OPTION_TX, 3 },
+  };
+  static struct snapshot delta, full;
+  uint8_t version;
+
+  UNIT_TEST_BEGIN();
+
+  dynsched_schedule_create_from_array(4, old_arr);
+  dynsched_update_network_schedules(4, old_arr);
+  version = net_schedules_links.version;
+
+  /* Same slotframe size, so only the changed links are updated */
+  dynsched_schedule_update_from_array(4, new_arr);
+  UNIT_TEST_ASSERT(net_schedules_links.version == (uint8_t)(version + 1));
+  UNIT_TEST_ASSERT(net_schedules_delta.num_links == 3);
+  take_snapshot(&delta);
+  UNIT_TEST_ASSERT(delta.num_links == 4);
+
+  dynsched_schedule_create_from_array(4, new_arr);
+  take_snapshot(&full);
+
+  UNIT_TEST_ASSERT(memcmp(&delta, &full, sizeof(full)) == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(dynsched_test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  node_id = NODE_ID;
+  tsch_schedule_init();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_node);
+  UNIT_TEST_RUN(test_coordinator);
+
+  printf("=check-me= DONE\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+#include "contiki.h"
+#include "services/unit-test/unit-test.h"
+
+#include <stdio.h>
+/*---------------------------------------------------------------------------*/
+PROCESS(etimer_heap_test_process, "Event timer heap test");
+PROCESS(exiting_process, "Exiting process");
+AUTOSTART_PROCESSES(&etimer_heap_test_process);
+/*---------------------------------------------------------------------------*/
+/* Twice the heap size, so that half of the timers are on the list */
+#define TIMER_COUNT (2 * ETIMER_HEAP_SIZE)
+static struct etimer timers[TIMER_COUNT];
+static struct etimer guard;
+static struct etimer exiting_timers[4];
+
+static uint8_t fired[TIMER_COUNT];
+static uint8_t early;
+static uint8_t unexpected;
+static uint8_t next_ok;
+static uint8_t all_fired;
+static uint8_t pending_after;
+static uint8_t exited_pending;
+
+#define STOPPED(i) ((i) % 5 == 2)
+#define RESET(i)   ((i) == 3 || (i) == TIMER_COUNT - 1)
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static clock_time_t
+interval(int i)
+{
+  /* Not in the order the timers are set */
+  return ((i * 7) % TIMER_COUNT + 1) * (CLOCK_SECOND / 100);
+}
+/*---------------------------------------------------------------------------*/
+static clock_time_t
+earliest(void)
+{
+  clock_time_t next = 0;
+  int i, first = 1;
+
+  for(i = 0; i < TIMER_COUNT; i++) {
+    if(!etimer_expired(&timers[i]) &&
+       (first || etimer_expiration_time(&timers[i]) - next > (clock_time_t)-1 / 2)) {
+      next = etimer_expiration_time(&timers[i]);
+      first = 0;
+    }
+  }
+  return next;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_next_expiration, "Next expiration time");
+UNIT_TEST(test_next_expiration)
+{
+  UNIT_TEST_BEGIN();
+  UNIT_TEST_ASSERT(next_ok);
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_expiration, "Expiration of heap and list timers");
+UNIT_TEST(test_expiration)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(all_fired);
+  UNIT_TEST_ASSERT(!early);
+  UNIT_TEST_ASSERT(!unexpected);
+  for(i = 0; i < TIMER_COUNT; i++) {
+    UNIT_TEST_ASSERT(fired[i] == (STOPPED(i) ? 0 : 1));
+  }
+  UNIT_TEST_ASSERT(!pending_after);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_exited, "Timers of an exited process");
+UNIT_TEST(test_exited)
+{
+  UNIT_TEST_BEGIN();
+  UNIT_TEST_ASSERT(!exited_pending);
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(exiting_process, ev, data)
+{
+  int i;
+
+  PROCESS_BEGIN();
+
+  for(i = 0; i < 4; i++) {
+    etimer_set(&exiting_timers[i], 10 * CLOCK_SECOND + i);
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(etimer_heap_test_process, ev, data)
+{
+  static int i, remaining;
+  struct etimer *t;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  for(i = 0; i < TIMER_COUNT; i++) {
+    etimer_set(&timers[i], interval(i));
+  }
+  for(i = 0; i < TIMER_COUNT; i++) {
+    if(STOPPED(i)) {
+      etimer_stop(&timers[i]);
+    } else if(RESET(i)) {
+      /* Moves the timer down the heap, or along the list */
+      etimer_set(&timers[i], interval(i) + CLOCK_SECOND / 10);
+    }
+  }
+  next_ok = etimer_pending() && etimer_next_expiration_time() == earliest();
+
+  remaining = 0;
+  for(i = 0; i < TIMER_COUNT; i++) {
+    remaining += !STOPPED(i);
+  }
+
+  etimer_set(&guard, 2 * CLOCK_SECOND);
+  while(remaining > 0) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER);
+    if(data == &guard) {
+      break;
+    }
+    t = data;
+    i = t - timers;
+    if(i < 0 || i >= TIMER_COUNT || STOPPED(i) || fired[i]) {
+      unexpected = 1;
+      continue;
+    }
+    if(!etimer_expired(t) || !timer_expired(&t->timer)) {
+      early = 1;
+    }
+    fired[i]++;
+    remaining--;
+  }
+  all_fired = remaining == 0;
+  etimer_stop(&guard);
+  pending_after = etimer_pending();
+
+  UNIT_TEST_RUN(test_next_expiration);
+  UNIT_TEST_RUN(test_expiration);
+
+  /* The timers of a process that exits must not stay pending */
+  process_start(&exiting_process, NULL);
+  etimer_set(&guard, CLOCK_SECOND / 10);
+  PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER && data == &guard);
+  exited_pending = etimer_pending();
+
+  UNIT_TEST_RUN(test_exited);
+
+  printf("=check-me= DONE\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
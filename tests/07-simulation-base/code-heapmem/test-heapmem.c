@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+#include "contiki.h"
+#include "lib/heapmem.h"
+#include "lib/random.h"
+#include "services/unit-test/unit-test.h"
+
+#include <string.h>
+#include <stdint.h>
+#include <stdio.h>
+/*---------------------------------------------------------------------------*/
+PROCESS(heapmem_test_process, "Heapmem test process");
+AUTOSTART_PROCESSES(&heapmem_test_process);
+/*---------------------------------------------------------------------------*/
+#define STEP 8
+#define CLASS_MAX (HEAPMEM_CONF_SIZE_CLASSES * STEP)
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static size_t
+cached(void)
+{
+  heapmem_stats_t stats;
+
+  heapmem_stats(&stats);
+  return stats.cached;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_class_reuse, "Size class reuse");
+UNIT_TEST(test_class_reuse)
+{
+  void *p, *q, *guard;
+
+  UNIT_TEST_BEGIN();
+
+  /* The guard keeps p from being the last chunk of the heap, which
+     would be released into the wilderness instead of cached */
+  p = heapmem_alloc(10);
+  guard = heapmem_alloc(CLASS_MAX + 1);
+  UNIT_TEST_ASSERT(p != NULL && guard != NULL);
+
+  heapmem_free(p);
+  UNIT_TEST_ASSERT(cached() == 2 * STEP);
+
+  /* Any size of the same class gets the cached chunk back */
+  q = heapmem_alloc(13);
+  UNIT_TEST_ASSERT(q == p);
+  UNIT_TEST_ASSERT(cached() == 0);
+
+  /* Another class does not */
+  heapmem_free(q);
+  q = heapmem_alloc(3 * STEP + 1);
+  UNIT_TEST_ASSERT(q != NULL && q != p);
+  UNIT_TEST_ASSERT(cached() == 2 * STEP);
+
+  /* Larger allocations are not cached */
+  heapmem_free(guard);
+  UNIT_TEST_ASSERT(cached() == 2 * STEP);
+
+  heapmem_free(q);
+  p = heapmem_alloc(16);
+  heapmem_free(p);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_class_realloc, "Size class realloc");
+UNIT_TEST(test_class_realloc)
+{
+  uint8_t *p, *q;
+  void *guard;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  p = heapmem_alloc(20);
+  guard = heapmem_alloc(CLASS_MAX + 1);
+  UNIT_TEST_ASSERT(p != NULL && guard != NULL);
+  for(i = 0; i < 20; i++) {
+    p[i] = i;
+  }
+
+  /* Within the class, the object stays in place */
+  q = heapmem_realloc(p, 24);
+  UNIT_TEST_ASSERT(q == p);
+  q = heapmem_realloc(p, 17);
+  UNIT_TEST_ASSERT(q == p);
+
+  /* Out of the class, it moves with its contents */
+  q = heapmem_realloc(p, 40);
+  UNIT_TEST_ASSERT(q != NULL && q != p);
+  for(i = 0; i < 17; i++) {
+    UNIT_TEST_ASSERT(q[i] == i);
+  }
+  UNIT_TEST_ASSERT(cached() >= 3 * STEP);
+
+  heapmem_free(q);
+  heapmem_free(guard);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_class_release, "Size class release on exhaustion");
+UNIT_TEST(test_class_release)
+{
+  static void *ptrs[HEAPMEM_CONF_ARENA_SIZE / STEP];
+  void *big;
+  int i, n;
+
+  UNIT_TEST_BEGIN();
+
+  /* Fill the heap with small chunks, then free them all but the last
+     one, so that they are cached */
+  for(n = 0; n < (int)(sizeof(ptrs) / sizeof(ptrs[0])); n++) {
+    ptrs[n] = heapmem_alloc(STEP);
+    if(ptrs[n] == NULL) {
+      break;
+    }
+  }
+  UNIT_TEST_ASSERT(n > 2);
+  for(i = 0; i < n - 1; i++) {
+    heapmem_free(ptrs[i]);
+  }
+  UNIT_TEST_ASSERT(cached() > HEAPMEM_CONF_ARENA_SIZE / 8);
+
+  /* Only fits once the cached chunks are coalesced */
+  big = heapmem_alloc(HEAPMEM_CONF_ARENA_SIZE / 2);
+  UNIT_TEST_ASSERT(big != NULL);
+  UNIT_TEST_ASSERT(cached() == 0);
+
+  heapmem_free(big);
+  heapmem_free(ptrs[n - 1]);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_mixed, "Mixed allocations");
+UNIT_TEST(test_mixed)
+{
+  static uint8_t *ptrs[32];
+  static size_t sizes[32];
+  heapmem_stats_t stats;
+  unsigned i, j, k;
+
+  UNIT_TEST_BEGIN();
+
+  memset(ptrs, 0, sizeof(ptrs));
+  for(i = 0; i < 2000; i++) {
+    j = random_rand() % 32;
+    if(ptrs[j] != NULL) {
+      for(k = 0; k < sizes[j]; k++) {
+        UNIT_TEST_ASSERT(ptrs[j][k] == (uint8_t)(j + k));
+      }
+      heapmem_free(ptrs[j]);
+      ptrs[j] = NULL;
+    } else {
+      sizes[j] = 1 + random_rand() % (2 * CLASS_MAX);
+      ptrs[j] = heapmem_alloc(sizes[j]);
+      if(ptrs[j] != NULL) {
+        for(k = 0; k < sizes[j]; k++) {
+          ptrs[j][k] = j + k;
+        }
+      }
+    }
+  }
+  for(j = 0; j < 32; j++) {
+    heapmem_free(ptrs[j]);
+  }
+
+  heapmem_stats(&stats);
+  UNIT_TEST_ASSERT(stats.allocated == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(heapmem_test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_class_reuse);
+  UNIT_TEST_RUN(test_class_realloc);
+  UNIT_TEST_RUN(test_class_release);
+  UNIT_TEST_RUN(test_mixed);
+
+  printf("=check-me= DONE\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
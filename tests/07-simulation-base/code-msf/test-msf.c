@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Checks that MSF keeps working when TSCH resets the schedule, as it
+ * does when associating again, and that only transmissions in the Tx
+ * cells to the parent count as used cells. MSF and the TSCH schedule
+ * are built into the test, with stubs for the rest of TSCH and 6P.
+ */
+
+#include "contiki.h"
+#include "net/mac/tsch/tsch.h"
+#include "services/unit-test/unit-test.h"
+
+#include <stdio.h>
+/*---------------------------------------------------------------------------*/
+/* Stubs for the rest of TSCH */
+struct tsch_link *current_link;
+const linkaddr_t tsch_broadcast_address;
+struct tsch_asn_t tsch_current_asn;
+struct tsch_asn_divisor_t tsch_hopping_sequence_length = { 4, 0 };
+int tsch_is_associated = 1;
+int tsch_get_lock(void) { return 1; }
+void tsch_release_lock(void) { }
+int tsch_is_locked(void) { return 0; }
+struct tsch_neighbor *tsch_queue_add_nbr(const linkaddr_t *addr) { return NULL; }
+void tsch_queue_tx_links_updated(struct tsch_neighbor *n) { }
+static struct tsch_neighbor time_source;
+struct tsch_neighbor *tsch_queue_get_time_source(void) { return &time_source; }
+/*---------------------------------------------------------------------------*/
+#include "net/mac/tsch/tsch-schedule.c"
+#undef LOG_MODULE
+#undef LOG_LEVEL
+#include "net/mac/tsch/sixtop/sixp-pkt.c"
+#undef LOG_MODULE
+#undef LOG_LEVEL
+#include "services/msf/msf.c"
+/*---------------------------------------------------------------------------*/
+/* Stubs for the rest of 6P: one transaction at a time, with the parent */
+static int trans_pending;
+static sixp_pkt_cmd_t trans_cmd;
+static uint8_t last_body[sizeof(req_storage)];
+static sixp_pkt_cmd_t last_cmd;
+static linkaddr_t last_dest;
+
+sixp_trans_t *
+sixp_trans_find(const linkaddr_t *peer_addr)
+{
+  return trans_pending ? (sixp_trans_t *)&trans_pending : NULL;
+}
+sixp_pkt_cmd_t
+sixp_trans_get_cmd(sixp_trans_t *trans)
+{
+  return trans_cmd;
+}
+sixp_nbr_t *
+sixp_nbr_find(const linkaddr_t *peer_addr)
+{
+  return (sixp_nbr_t *)&trans_pending;
+}
+int
+sixp_output(sixp_pkt_type_t type, sixp_pkt_code_t code, uint8_t sfid,
+            const uint8_t *body, uint16_t body_len,
+            const linkaddr_t *dest_addr,
+            sixp_sent_callback_t func, void *arg, uint16_t arg_len)
+{
+  if(type == SIXP_PKT_TYPE_REQUEST) {
+    trans_pending = 1;
+    trans_cmd = code.cmd;
+    last_cmd = code.cmd;
+    memcpy(last_body, body, MIN(body_len, sizeof(last_body)));
+    linkaddr_copy(&last_dest, dest_addr);
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS(msf_test_process, "MSF test process");
+AUTOSTART_PROCESSES(&msf_test_process);
+/*---------------------------------------------------------------------------*/
+static const linkaddr_t parent = { { 0x01, 0x02, 0x03, 0x04,
+                                     0x05, 0x06, 0x07, 0x08 } };
+static const linkaddr_t child = { { 0x11, 0x12, 0x13, 0x14,
+                                    0x15, 0x16, 0x17, 0x18 } };
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Runs housekeeping and has the parent accept the first candidate of the
+ * ADD request it sends, if any. Returns the cell accepted */
+static int
+add_first_candidate(uint16_t *timeslot, uint16_t *channel_offset)
+{
+  sixp_pkt_code_t code = { .rc = SIXP_PKT_RC_SUCCESS };
+  uint8_t cell[CELL_LEN];
+
+  trans_pending = 0;
+  housekeeping(NULL);
+  if(!trans_pending || last_cmd != SIXP_PKT_CMD_ADD) {
+    return 0;
+  }
+  memcpy(cell, &last_body[REQ_HDR_LEN], CELL_LEN);
+  read_cell(cell, timeslot, channel_offset);
+  input(SIXP_PKT_TYPE_RESPONSE, code, cell, CELL_LEN, &parent);
+  trans_pending = 0;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+is_tx_cell(uint16_t timeslot, uint16_t channel_offset)
+{
+  struct tsch_link *l;
+
+  if(get_slotframe() == NULL) {
+    return 0;
+  }
+  l = tsch_schedule_get_link_by_timeslot(get_slotframe(), timeslot);
+  return l != NULL && l->channel_offset == channel_offset
+    && (l->link_options & LINK_OPTION_TX)
+    && linkaddr_cmp(&l->addr, &parent);
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_schedule_reset, "Cells after a schedule reset");
+UNIT_TEST(test_schedule_reset)
+{
+  struct tsch_slotframe *sf_min;
+  uint16_t timeslot, channel_offset;
+
+  UNIT_TEST_BEGIN();
+
+  tsch_schedule_create_minimal();
+  linkaddr_copy(&time_source.addr, &parent);
+  msf_driver.init();
+
+  UNIT_TEST_ASSERT(add_first_candidate(&timeslot, &channel_offset));
+  UNIT_TEST_ASSERT(msf_get_num_tx_cells() == 1);
+  UNIT_TEST_ASSERT(is_tx_cell(timeslot, channel_offset));
+
+  /* TSCH associates again: the MSF slotframe and its links are freed */
+  tsch_schedule_create_minimal();
+  sf_min = tsch_schedule_get_slotframe_by_handle(0);
+  UNIT_TEST_ASSERT(get_slotframe() == NULL);
+  UNIT_TEST_ASSERT(msf_get_num_rx_cells() == 0);
+
+  /* MSF re-creates its slotframe, asks the parent to clear the cells it
+   * had, and leaves the minimal schedule alone */
+  trans_pending = 0;
+  housekeeping(NULL);
+  UNIT_TEST_ASSERT(get_slotframe() != NULL && get_slotframe() != sf_min);
+  UNIT_TEST_ASSERT(msf_get_num_tx_cells() == 0);
+  UNIT_TEST_ASSERT(trans_pending && last_cmd == SIXP_PKT_CMD_CLEAR);
+  UNIT_TEST_ASSERT(linkaddr_cmp(&last_dest, &parent));
+  UNIT_TEST_ASSERT(sf_min->size.val == TSCH_SCHEDULE_DEFAULT_LENGTH);
+  UNIT_TEST_ASSERT(list_length(sf_min->links_list) == 1);
+
+  /* Then negotiates a cell again */
+  UNIT_TEST_ASSERT(add_first_candidate(&timeslot, &channel_offset));
+  UNIT_TEST_ASSERT(msf_get_num_tx_cells() == 1);
+  UNIT_TEST_ASSERT(is_tx_cell(timeslot, channel_offset));
+  UNIT_TEST_ASSERT(list_length(sf_min->links_list) == 1);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_tx_done, "Tx done accounting");
+UNIT_TEST(test_tx_done)
+{
+  struct tsch_slotframe *sf_other;
+  struct tsch_link *tx, *rx, *other;
+  struct msf_cell *c;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(msf_get_num_tx_cells() == 1);
+  c = &tx_cells[0];
+  UNIT_TEST_ASSERT(c->in_use);
+  tx = tsch_schedule_get_link_by_timeslot(get_slotframe(), c->timeslot);
+  UNIT_TEST_ASSERT(tx != NULL);
+
+  /* An Rx cell for a child, and a link at the same timeslot in another
+   * slotframe */
+  rx = tsch_schedule_add_link(get_slotframe(), LINK_OPTION_RX,
+                              LINK_TYPE_NORMAL, &child,
+                              (c->timeslot + 1) % MSF_SLOTFRAME_LENGTH, 0);
+  sf_other = tsch_schedule_add_slotframe(MSF_SLOTFRAME_HANDLE + 1,
+                                         MSF_SLOTFRAME_LENGTH);
+  other = tsch_schedule_add_link(sf_other, LINK_OPTION_TX,
+                                 LINK_TYPE_NORMAL, &parent,
+                                 c->timeslot, c->channel_offset);
+  UNIT_TEST_ASSERT(rx != NULL && other != NULL);
+
+  reset_usage();
+  msf_callback_link_tx_done(tx, MAC_TX_OK);
+  msf_callback_link_tx_done(tx, MAC_TX_NOACK);
+  msf_callback_link_tx_done(rx, MAC_TX_OK);
+  msf_callback_link_tx_done(other, MAC_TX_OK);
+  msf_callback_link_tx_done(NULL, MAC_TX_OK);
+  UNIT_TEST_ASSERT(num_cells_used == 2);
+  UNIT_TEST_ASSERT(c->num_tx == 2 && c->num_tx_ack == 1);
+
+  tsch_schedule_remove_slotframe(sf_other);
+  tsch_schedule_remove_link(get_slotframe(), rx);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(msf_test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  tsch_schedule_init();
+
+  UNIT_TEST_RUN(test_schedule_reset);
+  UNIT_TEST_RUN(test_tx_done);
+
+  printf("=check-me= DONE\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
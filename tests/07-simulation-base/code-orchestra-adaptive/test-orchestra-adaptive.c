@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Checks that the packets queued for the cells of the adaptive Orchestra
+ * rule are still sent when the parent lowers its level to zero, or when
+ * the time source changes. The rule, the TSCH schedule and the TSCH
+ * queues are built into the test, with stubs for the rest of TSCH, and
+ * the slots of the adaptive slotframe are run by the test.
+ */
+
+#include "contiki.h"
+#include "net/mac/tsch/tsch.h"
+#include "net/packetbuf.h"
+#include "services/unit-test/unit-test.h"
+
+#include <stdio.h>
+/*---------------------------------------------------------------------------*/
+/* Stubs for the rest of TSCH */
+struct tsch_link *current_link;
+const linkaddr_t tsch_broadcast_address = { { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff } };
+const linkaddr_t tsch_eb_address = { { 0 } };
+tsch_timeslot_timing_ticks tsch_timing;
+int tsch_get_lock(void) { return 1; }
+void tsch_release_lock(void) { }
+int tsch_is_locked(void) { return 0; }
+int tsch_is_coordinator;
+void tsch_set_ka_timeout(uint32_t timeout) { }
+/*---------------------------------------------------------------------------*/
+#include "net/mac/tsch/tsch-schedule.c"
+#undef LOG_MODULE
+#undef LOG_LEVEL
+#include "net/mac/tsch/tsch-queue.c"
+#include "services/orchestra/orchestra-rule-unicast-adaptive.c"
+/*---------------------------------------------------------------------------*/
+PROCESS(orchestra_adaptive_test_process, "Orchestra adaptive test process");
+AUTOSTART_PROCESSES(&orchestra_adaptive_test_process);
+/*---------------------------------------------------------------------------*/
+#define SLOTFRAME_HANDLE 1
+#define NUM_PACKETS      6
+/* Slotframes run before giving up on a queue */
+#define MAX_SLOTFRAMES   20
+
+static const linkaddr_t parent = { { 0x01, 0x02, 0x03, 0x04,
+                                     0x05, 0x06, 0x07, 0x08 } };
+static const linkaddr_t new_parent = { { 0x11, 0x12, 0x13, 0x14,
+                                         0x15, 0x16, 0x17, 0x19 } };
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+count_tx_cells(void)
+{
+  struct tsch_link *l;
+  int count = 0;
+
+  for(l = list_head(sf_adaptive->links_list); l != NULL; l = list_item_next(l)) {
+    if(l->link_options & LINK_OPTION_TX) {
+      count++;
+    }
+  }
+  return count;
+}
+/*---------------------------------------------------------------------------*/
+/* Queue a data packet to an address, with the slotframe the rules select */
+static int
+queue_packets(const linkaddr_t *addr, int count)
+{
+  uint16_t slotframe, timeslot;
+  int selected = 0;
+
+  while(count-- > 0) {
+    packetbuf_clear();
+    packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, addr);
+    packetbuf_set_attr(PACKETBUF_ATTR_FRAME_TYPE, FRAME802154_DATAFRAME);
+    /* Sent in the unicast slotframe unless the adaptive rule takes it */
+    slotframe = SLOTFRAME_HANDLE + 1;
+    timeslot = 0xffff;
+    selected += select_packet(&slotframe, &timeslot);
+    packetbuf_set_attr(PACKETBUF_ATTR_TSCH_SLOTFRAME, slotframe);
+    packetbuf_set_attr(PACKETBUF_ATTR_TSCH_TIMESLOT, timeslot);
+    tsch_queue_add_packet(addr, 1, NULL, NULL);
+  }
+  return selected;
+}
+/*---------------------------------------------------------------------------*/
+/* Run the Tx slots of the adaptive slotframe as TSCH would, with every
+ * transmission acknowledged. Returns the number of packets sent. */
+static int
+run_slotframe(void)
+{
+  struct tsch_neighbor *n;
+  struct tsch_packet *p;
+  struct tsch_link *l;
+  uint16_t ts;
+  int sent = 0;
+
+  for(ts = 0; ts < ORCHESTRA_ADAPTIVE_PERIOD; ts++) {
+    l = tsch_schedule_get_link_by_timeslot(sf_adaptive, ts);
+    if(l == NULL || !(l->link_options & LINK_OPTION_TX)) {
+      continue;
+    }
+    n = tsch_queue_get_nbr(&l->addr);
+    p = tsch_queue_get_packet_for_nbr(n, l);
+    if(p == NULL) {
+      p = tsch_queue_get_unicast_packet_for_any(&n, l);
+    }
+    if(p != NULL) {
+      if(!tsch_queue_packet_sent(n, p, l, MAC_TX_OK)) {
+        tsch_queue_free_packet(p);
+      }
+      sent++;
+    }
+  }
+  return sent;
+}
+/*---------------------------------------------------------------------------*/
+/* Run slotframes until the queue to an address is empty */
+static int
+drain(const linkaddr_t *addr)
+{
+  int i;
+
+  for(i = 0; i < MAX_SLOTFRAMES && tsch_queue_packet_count(addr) > 0; i++) {
+    run_slotframe();
+  }
+  return tsch_queue_packet_count(addr) == 0;
+}
+/*---------------------------------------------------------------------------*/
+/* The end of an adaptation window */
+static void
+end_window(void)
+{
+  update_tx_prev();
+  update_cells();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_level_down, "Queue drains when the parent level drops to zero");
+UNIT_TEST(test_level_down)
+{
+  UNIT_TEST_BEGIN();
+
+  new_time_source(NULL, tsch_queue_add_nbr(&parent));
+  UNIT_TEST_ASSERT(count_tx_cells() == 0);
+
+  /* The parent moves up to level 2, and we queue packets for its cells */
+  orchestra_callback_load_level_received(&parent, 2);
+  update_cells();
+  UNIT_TEST_ASSERT(count_tx_cells() == 2);
+  UNIT_TEST_ASSERT(queue_packets(&parent, NUM_PACKETS) == NUM_PACKETS);
+
+  /* Back down to level 0: new packets go to the unicast slotframe, and
+     the cells stay for the packets already queued */
+  orchestra_callback_load_level_received(&parent, 0);
+  update_cells();
+  UNIT_TEST_ASSERT(queue_packets(&parent, 1) == 0);
+  UNIT_TEST_ASSERT(count_tx_cells() == 2);
+
+  /* The packets for our cells are sent, and the one for the unicast
+     slotframe remains */
+  UNIT_TEST_ASSERT(run_slotframe() == 2);
+  end_window();
+  UNIT_TEST_ASSERT(count_tx_cells() == 2);
+  while(run_slotframe() > 0);
+  UNIT_TEST_ASSERT(tsch_queue_packet_count(&parent) == 1);
+
+  /* Once the unicast slotframe sent it, the cells are removed */
+  tsch_queue_free_packet(tsch_queue_remove_packet_from_queue(tsch_queue_get_nbr(&parent)));
+  end_window();
+  UNIT_TEST_ASSERT(count_tx_cells() == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_new_time_source, "Queue drains when the time source changes");
+UNIT_TEST(test_new_time_source)
+{
+  UNIT_TEST_BEGIN();
+
+  orchestra_callback_load_level_received(&parent, 3);
+  update_cells();
+  UNIT_TEST_ASSERT(count_tx_cells() == 3);
+  UNIT_TEST_ASSERT(queue_packets(&parent, NUM_PACKETS) == NUM_PACKETS);
+
+  /* The new time source has not sent its level yet */
+  new_time_source(tsch_queue_get_nbr(&parent), tsch_queue_add_nbr(&new_parent));
+  UNIT_TEST_ASSERT(queue_packets(&new_parent, 1) == 0);
+  UNIT_TEST_ASSERT(count_tx_cells() == 3);
+
+  UNIT_TEST_ASSERT(drain(&parent));
+  end_window();
+  UNIT_TEST_ASSERT(count_tx_cells() == 0);
+
+  /* A level up and down with the new time source */
+  orchestra_callback_load_level_received(&new_parent, 1);
+  update_cells();
+  UNIT_TEST_ASSERT(count_tx_cells() == 1);
+  tsch_queue_free_packet(tsch_queue_remove_packet_from_queue(tsch_queue_get_nbr(&new_parent)));
+  UNIT_TEST_ASSERT(queue_packets(&new_parent, NUM_PACKETS) == NUM_PACKETS);
+  orchestra_callback_load_level_received(&new_parent, 0);
+  update_cells();
+  UNIT_TEST_ASSERT(drain(&new_parent));
+  end_window();
+  UNIT_TEST_ASSERT(count_tx_cells() == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(orchestra_adaptive_test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  tsch_schedule_init();
+  tsch_queue_init();
+  unicast_adaptive.init(SLOTFRAME_HANDLE);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_level_down);
+  UNIT_TEST_RUN(test_new_time_source);
+
+  printf("=check-me= DONE\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
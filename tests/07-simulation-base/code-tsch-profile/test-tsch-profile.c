@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Tests the TSCH slot timing profiler. The profiler and the shell are
+ * built into the test, with stubs for the rest of TSCH, so that the
+ * statistics of known samples can be checked through the API, through
+ * the binary dump and through the tsch-profile shell command.
+ */
+
+#include "contiki.h"
+#include "net/mac/tsch/tsch.h"
+#include "services/unit-test/unit-test.h"
+
+#include <stdio.h>
+#include <string.h>
+/*---------------------------------------------------------------------------*/
+/* Stubs for the rest of TSCH, used by the other TSCH shell commands */
+int tsch_is_coordinator;
+int tsch_is_associated;
+int tsch_is_pan_secured;
+uint8_t tsch_join_priority;
+unsigned long tsch_last_sync_time;
+void tsch_set_coordinator(int enable) { }
+void tsch_set_pan_secured(int enable) { }
+struct tsch_neighbor *tsch_queue_get_time_source(void) { return NULL; }
+long int tsch_adaptive_timesync_get_drift_ppm(void) { return 0; }
+uint64_t tsch_get_network_uptime_ticks(void) { return 0; }
+int tsch_is_locked(void) { return 0; }
+struct tsch_slotframe *tsch_schedule_slotframe_head(void) { return NULL; }
+struct tsch_slotframe *tsch_schedule_slotframe_next(struct tsch_slotframe *sf) { return NULL; }
+/*---------------------------------------------------------------------------*/
+#include "net/mac/tsch/tsch-profile.c"
+/* The TSCH shell commands are only built with the TSCH MAC */
+#define MAC_CONF_WITH_TSCH 1
+#include "services/shell/shell.c"
+#include "services/shell/shell-commands.c"
+/*---------------------------------------------------------------------------*/
+PROCESS(tsch_profile_test_process, "TSCH profile test process");
+AUTOSTART_PROCESSES(&tsch_profile_test_process);
+/*---------------------------------------------------------------------------*/
+/* Durations of the slot samples, in rtimer ticks */
+static const rtimer_clock_t slot_ticks[] = { 3, 1, 0, 2, 40, 2 };
+#define NUM_SLOT_SAMPLES (sizeof(slot_ticks) / sizeof(slot_ticks[0]))
+
+static char shell_out[2048];
+static uint8_t dump[TSCH_PROFILE_DUMP_SIZE];
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* The bucket of a sample: bucket i > 0 holds [2^(i-1), 2^i) us */
+static int
+expected_bucket(uint32_t us)
+{
+  int i;
+  for(i = 0; i < TSCH_PROFILE_NUM_BUCKETS - 1; i++) {
+    if(us < (1UL << i)) {
+      return i;
+    }
+  }
+  return TSCH_PROFILE_NUM_BUCKETS - 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+add_slot_samples(void)
+{
+  int i;
+  for(i = 0; i < NUM_SLOT_SAMPLES; i++) {
+    tsch_profile_add(TSCH_PROFILE_SLOT, slot_ticks[i]);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static uint64_t
+read_le(const uint8_t *p, int len)
+{
+  uint64_t value = 0;
+  while(len-- > 0) {
+    value = (value << 8) | p[len];
+  }
+  return value;
+}
+/*---------------------------------------------------------------------------*/
+static void
+shell_output(const char *str)
+{
+  strncat(shell_out, str, sizeof(shell_out) - strlen(shell_out) - 1);
+}
+/*---------------------------------------------------------------------------*/
+/* Runs a shell command and leaves its output in shell_out */
+static void
+run_shell_command(const char *cmd)
+{
+  static struct pt pt;
+  char line[64];
+
+  strncpy(line, cmd, sizeof(line) - 1);
+  line[sizeof(line) - 1] = '\0';
+  shell_out[0] = '\0';
+  PT_INIT(&pt);
+  while(PT_SCHEDULE(shell_input(&pt, shell_output, line)));
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_stats, "Count, min, max, sum and buckets of samples");
+UNIT_TEST(test_stats)
+{
+  struct tsch_profile_histogram h;
+  uint32_t buckets[TSCH_PROFILE_NUM_BUCKETS];
+  uint32_t min = UINT32_MAX, max = 0;
+  uint64_t sum = 0;
+  uint32_t us;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  tsch_profile_reset();
+  tsch_profile_get(TSCH_PROFILE_SLOT, &h);
+  UNIT_TEST_ASSERT(h.count == 0 && h.min == 0 && h.max == 0 && h.sum == 0);
+
+  memset(buckets, 0, sizeof(buckets));
+  for(i = 0; i < NUM_SLOT_SAMPLES; i++) {
+    us = TICKS_TO_US(slot_ticks[i]);
+    min = MIN(min, us);
+    max = MAX(max, us);
+    sum += us;
+    buckets[expected_bucket(us)]++;
+  }
+  /* The samples cover the first and the last bucket */
+  UNIT_TEST_ASSERT(buckets[0] > 0);
+  UNIT_TEST_ASSERT(buckets[TSCH_PROFILE_NUM_BUCKETS - 1] > 0);
+
+  add_slot_samples();
+  tsch_profile_get(TSCH_PROFILE_SLOT, &h);
+  UNIT_TEST_ASSERT(h.count == NUM_SLOT_SAMPLES);
+  UNIT_TEST_ASSERT(h.min == min);
+  UNIT_TEST_ASSERT(h.max == max);
+  UNIT_TEST_ASSERT(h.sum == sum);
+  UNIT_TEST_ASSERT(h.sum / h.count == sum / NUM_SLOT_SAMPLES);
+  UNIT_TEST_ASSERT(!memcmp(h.buckets, buckets, sizeof(buckets)));
+
+  /* A single sample is both the min and the max */
+  tsch_profile_add(TSCH_PROFILE_DRIFT, 2);
+  tsch_profile_get(TSCH_PROFILE_DRIFT, &h);
+  UNIT_TEST_ASSERT(h.count == 1);
+  UNIT_TEST_ASSERT(h.min == TICKS_TO_US(2) && h.max == TICKS_TO_US(2));
+
+  /* The other metrics are left alone */
+  tsch_profile_get(TSCH_PROFILE_NEXT_LINK, &h);
+  UNIT_TEST_ASSERT(h.count == 0 && h.min == 0 && h.max == 0);
+
+  /* Samples of unknown metrics are ignored */
+  tsch_profile_add(TSCH_PROFILE_NUM_METRICS, 1);
+
+  UNIT_TEST_ASSERT(tsch_profile_get(TSCH_PROFILE_SLOT, NULL) == 0);
+  tsch_profile_timer_miss();
+  tsch_profile_timer_miss();
+  UNIT_TEST_ASSERT(tsch_profile_get(TSCH_PROFILE_SLOT, NULL) == 2);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_slot_hooks, "Slot and radio hooks");
+UNIT_TEST(test_slot_hooks)
+{
+  struct tsch_profile_histogram slot, radio_on, radio_duty;
+
+  UNIT_TEST_BEGIN();
+
+  tsch_profile_reset();
+
+  /* A slot that turns the radio on and off */
+  tsch_profile_slot_start(RTIMER_NOW());
+  tsch_profile_radio_on();
+  tsch_profile_radio_off();
+  tsch_profile_slot_end();
+  /* A slot that leaves the radio off */
+  tsch_profile_slot_start(RTIMER_NOW());
+  tsch_profile_slot_end();
+  /* A slot end without a start is ignored */
+  tsch_profile_slot_end();
+
+  tsch_profile_get(TSCH_PROFILE_SLOT, &slot);
+  tsch_profile_get(TSCH_PROFILE_RADIO_ON, &radio_on);
+  tsch_profile_get(TSCH_PROFILE_RADIO_DUTY, &radio_duty);
+  UNIT_TEST_ASSERT(slot.count == 2);
+  UNIT_TEST_ASSERT(radio_on.count == 1);
+  UNIT_TEST_ASSERT(radio_duty.count == 1);
+  UNIT_TEST_ASSERT(radio_duty.max <= slot.max);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_dump, "Binary dump");
+UNIT_TEST(test_dump)
+{
+  struct tsch_profile_histogram h;
+  const uint8_t *p;
+  int metric;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  tsch_profile_reset();
+  add_slot_samples();
+  tsch_profile_add(TSCH_PROFILE_NEXT_LINK, 1);
+  tsch_profile_timer_miss();
+
+  UNIT_TEST_ASSERT(tsch_profile_dump(dump, TSCH_PROFILE_DUMP_SIZE - 1) == 0);
+  UNIT_TEST_ASSERT(tsch_profile_dump(NULL, TSCH_PROFILE_DUMP_SIZE) == 0);
+  UNIT_TEST_ASSERT(tsch_profile_dump(dump, sizeof(dump)) == TSCH_PROFILE_DUMP_SIZE);
+
+  UNIT_TEST_ASSERT(dump[0] == TSCH_PROFILE_DUMP_VERSION);
+  UNIT_TEST_ASSERT(dump[1] == TSCH_PROFILE_NUM_METRICS);
+  UNIT_TEST_ASSERT(dump[2] == TSCH_PROFILE_NUM_BUCKETS);
+  UNIT_TEST_ASSERT(read_le(&dump[4], 4) == 1);
+
+  p = &dump[8];
+  for(metric = 0; metric < TSCH_PROFILE_NUM_METRICS; metric++) {
+    tsch_profile_get(metric, &h);
+    UNIT_TEST_ASSERT(read_le(p, 4) == h.count);
+    UNIT_TEST_ASSERT(read_le(p + 4, 4) == h.min);
+    UNIT_TEST_ASSERT(read_le(p + 8, 4) == h.max);
+    UNIT_TEST_ASSERT(read_le(p + 12, 8) == h.sum);
+    p += 20;
+    for(i = 0; i < TSCH_PROFILE_NUM_BUCKETS; i++) {
+      UNIT_TEST_ASSERT(read_le(p, 4) == h.buckets[i]);
+      p += 4;
+    }
+  }
+  UNIT_TEST_ASSERT(p == dump + TSCH_PROFILE_DUMP_SIZE);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_shell, "tsch-profile shell command");
+UNIT_TEST(test_shell)
+{
+  struct tsch_profile_histogram h;
+  char line[96];
+  char *hex;
+  int len;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  tsch_profile_reset();
+  add_slot_samples();
+
+  /* The histograms, with the min, avg and max of each metric */
+  run_shell_command("tsch-profile");
+  tsch_profile_get(TSCH_PROFILE_SLOT, &h);
+  snprintf(line, sizeof(line), "-- slot: count %lu, min %lu, avg %lu, max %lu\n",
+           (unsigned long)h.count, (unsigned long)h.min,
+           (unsigned long)(h.sum / h.count), (unsigned long)h.max);
+  UNIT_TEST_ASSERT(strstr(shell_out, line) != NULL);
+  UNIT_TEST_ASSERT(strstr(shell_out, "-- drift: count 0, min 0, avg 0, max 0\n") != NULL);
+  UNIT_TEST_ASSERT(strstr(shell_out, "-- Timer misses: 0\n") != NULL);
+
+  /* The dump, in hex */
+  len = tsch_profile_dump(dump, sizeof(dump));
+  run_shell_command("tsch-profile dump");
+  snprintf(line, sizeof(line), "TSCH profile dump, %d bytes:\n", len);
+  hex = strstr(shell_out, line);
+  UNIT_TEST_ASSERT(hex != NULL);
+  hex += strlen(line);
+  for(i = 0; i < len; i++) {
+    snprintf(line, sizeof(line), "%02x", dump[i]);
+    UNIT_TEST_ASSERT(!strncmp(hex, line, 2));
+    hex += 2;
+    if(i % 32 == 31 || i == len - 1) {
+      UNIT_TEST_ASSERT(*hex == '\n');
+      hex++;
+    }
+  }
+
+  /* Reset clears all histograms */
+  run_shell_command("tsch-profile reset");
+  UNIT_TEST_ASSERT(strstr(shell_out, "TSCH profile reset\n") != NULL);
+  tsch_profile_get(TSCH_PROFILE_SLOT, &h);
+  UNIT_TEST_ASSERT(h.count == 0 && h.min == 0 && h.max == 0 && h.sum == 0);
+  run_shell_command("tsch-profile");
+  UNIT_TEST_ASSERT(strstr(shell_out, "-- slot: count 0, min 0, avg 0, max 0\n") != NULL);
+
+  run_shell_command("tsch-profile foo");
+  UNIT_TEST_ASSERT(strstr(shell_out, "Invalid argument: foo\n") != NULL);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(tsch_profile_test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  shell_init();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_stats);
+  UNIT_TEST_RUN(test_slot_hooks);
+  UNIT_TEST_RUN(test_dump);
+  UNIT_TEST_RUN(test_shell);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
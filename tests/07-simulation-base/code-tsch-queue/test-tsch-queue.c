@@ -0,0 +1,435 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Tests the TSCH neighbor queues. The queue module is built into the
+ * test, with stubs for the rest of TSCH, so that the neighbor index and
+ * the set of neighbors ready for shared links can be checked against
+ * the neighbor list. The test is also built with TSCH_QUEUE_CONF_EDF
+ * set, to check the dequeue order of both policies.
+ */
+
+#include "contiki.h"
+#include "net/mac/tsch/tsch.h"
+#include "net/packetbuf.h"
+#include "lib/random.h"
+#include "services/unit-test/unit-test.h"
+
+#include <stdio.h>
+/*---------------------------------------------------------------------------*/
+/* Stubs for the rest of TSCH */
+const linkaddr_t tsch_broadcast_address = { { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff } };
+const linkaddr_t tsch_eb_address = { { 0 } };
+int tsch_get_lock(void) { return 1; }
+void tsch_release_lock(void) { }
+int tsch_is_locked(void) { return 0; }
+int tsch_is_coordinator;
+void tsch_set_ka_timeout(uint32_t timeout) { }
+/*---------------------------------------------------------------------------*/
+#include "net/mac/tsch/tsch-queue.c"
+/*---------------------------------------------------------------------------*/
+PROCESS(tsch_queue_test_process, "TSCH queue test process");
+AUTOSTART_PROCESSES(&tsch_queue_test_process);
+/*---------------------------------------------------------------------------*/
+#define NUM_ADDRS 96
+#define NUM_ROUNDS 20000
+#define NUM_LOOKUPS 100000
+
+static linkaddr_t addrs[NUM_ADDRS];
+static struct tsch_link shared_link = { .link_options = LINK_OPTION_TX | LINK_OPTION_SHARED };
+static struct tsch_link dedicated_link = { .link_options = LINK_OPTION_TX };
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* The neighbor of an address, found by walking the neighbor list */
+static struct tsch_neighbor *
+scan_nbr(const linkaddr_t *addr)
+{
+  struct tsch_neighbor *n;
+
+  for(n = list_head(neighbor_list); n != NULL; n = list_item_next(n)) {
+    if(linkaddr_cmp(&n->addr, addr)) {
+      return n;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Is there a neighbor that may send over the shared link? */
+static int
+scan_any_ready(void)
+{
+  struct tsch_neighbor *n;
+
+  for(n = list_head(neighbor_list); n != NULL; n = list_item_next(n)) {
+    if(!n->is_broadcast && n->tx_links_count == 0
+       && tsch_queue_get_packet_for_nbr(n, &shared_link) != NULL) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static struct tsch_packet *
+add_packet(const linkaddr_t *addr)
+{
+  packetbuf_clear();
+  return tsch_queue_add_packet(addr, 1, NULL, NULL);
+}
+/*---------------------------------------------------------------------------*/
+static struct tsch_packet *
+add_class_packet(const linkaddr_t *addr, int class, clock_time_t deadline)
+{
+  packetbuf_clear();
+  packetbuf_set_attr(PACKETBUF_ATTR_TSCH_TRAFFIC_CLASS, class);
+  packetbuf_set_attr(PACKETBUF_ATTR_TSCH_DEADLINE, deadline);
+  return tsch_queue_add_packet(addr, 1, NULL, NULL);
+}
+/*---------------------------------------------------------------------------*/
+/* Send the next packet of a neighbor, and return it */
+static struct tsch_packet *
+send_next(struct tsch_neighbor *n)
+{
+  struct tsch_packet *p;
+
+  p = tsch_queue_get_packet_for_nbr(n, &dedicated_link);
+  if(p != NULL) {
+    tsch_queue_packet_sent(n, p, &dedicated_link, MAC_TX_OK);
+    tsch_queue_free_packet(p);
+  }
+  return p;
+}
+/*---------------------------------------------------------------------------*/
+static void
+flush_all(void)
+{
+  struct tsch_neighbor *n;
+
+  for(n = list_head(neighbor_list); n != NULL; n = list_item_next(n)) {
+    n->tx_links_count = 0;
+  }
+  tsch_queue_reset();
+  tsch_queue_free_unused_neighbors();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_lookup, "Neighbor index matches the list");
+UNIT_TEST(test_lookup)
+{
+  struct tsch_neighbor *n;
+  struct tsch_packet *p;
+  int i, a;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < NUM_ROUNDS; i++) {
+    a = random_rand() % NUM_ADDRS;
+    n = tsch_queue_get_nbr(&addrs[a]);
+    if(random_rand() % 2 == 0) {
+      add_packet(&addrs[a]);
+    } else if(n != NULL) {
+      p = tsch_queue_remove_packet_from_queue(n);
+      tsch_queue_free_packet(p);
+      tsch_queue_free_unused_neighbors();
+    }
+
+    a = random_rand() % NUM_ADDRS;
+    UNIT_TEST_ASSERT(tsch_queue_get_nbr(&addrs[a]) == scan_nbr(&addrs[a]));
+  }
+  for(a = 0; a < NUM_ADDRS; a++) {
+    UNIT_TEST_ASSERT(tsch_queue_get_nbr(&addrs[a]) == scan_nbr(&addrs[a]));
+  }
+
+  flush_all();
+  UNIT_TEST_ASSERT(tsch_queue_global_packet_count() == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_tx_links, "Shared links skip neighbors with tx links");
+UNIT_TEST(test_tx_links)
+{
+  struct tsch_neighbor *a, *b, *n;
+  struct tsch_packet *p;
+
+  UNIT_TEST_BEGIN();
+
+  add_packet(&addrs[0]);
+  add_packet(&addrs[1]);
+  a = tsch_queue_get_nbr(&addrs[0]);
+  b = tsch_queue_get_nbr(&addrs[1]);
+  UNIT_TEST_ASSERT(a != NULL && b != NULL);
+
+  /* A neighbor that gets a tx link is served by its own links only */
+  a->tx_links_count++;
+  tsch_queue_tx_links_updated(a);
+  p = tsch_queue_get_unicast_packet_for_any(&n, &shared_link);
+  UNIT_TEST_ASSERT(p != NULL && n == b);
+  p = tsch_queue_get_unicast_packet_for_any(&n, &shared_link);
+  UNIT_TEST_ASSERT(p != NULL && n == b);
+  tsch_queue_free_packet(tsch_queue_remove_packet_from_queue(b));
+  UNIT_TEST_ASSERT(tsch_queue_get_unicast_packet_for_any(&n, &shared_link) == NULL);
+  UNIT_TEST_ASSERT((ready_set[NBR_INDEX(a) / 32] & ((uint32_t)1 << (NBR_INDEX(a) % 32))) == 0);
+
+  /* Once its last tx link is gone, it may use any shared link again */
+  a->tx_links_count--;
+  tsch_queue_tx_links_updated(a);
+  p = tsch_queue_get_unicast_packet_for_any(&n, &shared_link);
+  UNIT_TEST_ASSERT(p != NULL && n == a);
+
+  flush_all();
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_ready, "Ready set matches the list");
+UNIT_TEST(test_ready)
+{
+  struct tsch_neighbor *n;
+  struct tsch_packet *p;
+  int i, a;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < NUM_ROUNDS; i++) {
+    a = random_rand() % (TSCH_QUEUE_MAX_NEIGHBOR_QUEUES / 2);
+    n = tsch_queue_get_nbr(&addrs[a]);
+    switch(random_rand() % 5) {
+    case 0:
+      add_packet(&addrs[a]);
+      break;
+    case 1:
+      if(n != NULL) {
+        tsch_queue_free_packet(tsch_queue_remove_packet_from_queue(n));
+      }
+      break;
+    case 2:
+      if(n != NULL) {
+        if(n->tx_links_count > 0 && random_rand() % 2) {
+          n->tx_links_count--;
+        } else {
+          n->tx_links_count++;
+        }
+        tsch_queue_tx_links_updated(n);
+      }
+      break;
+    case 3:
+      if(n != NULL) {
+        tsch_queue_backoff_inc(n);
+      }
+      break;
+    case 4:
+      tsch_queue_update_all_backoff_windows(&tsch_broadcast_address);
+      if(n != NULL) {
+        tsch_queue_update_all_backoff_windows(&n->addr);
+      }
+      break;
+    }
+
+    p = tsch_queue_get_unicast_packet_for_any(&n, &shared_link);
+    UNIT_TEST_ASSERT((p != NULL) == scan_any_ready());
+    UNIT_TEST_ASSERT(p == NULL
+                     || (n->tx_links_count == 0 && tsch_queue_backoff_expired(n)
+                         && tsch_queue_get_packet_for_nbr(n, &shared_link) == p));
+  }
+
+  flush_all();
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_order, "Dequeue order");
+UNIT_TEST(test_order)
+{
+  struct tsch_neighbor *n;
+  struct tsch_packet *low, *mid1, *mid2, *high, *over;
+
+  UNIT_TEST_BEGIN();
+
+  low = add_class_packet(&addrs[0], 0, 50);
+  high = add_class_packet(&addrs[0], 2, 0);
+  mid1 = add_class_packet(&addrs[0], 1, 20);
+  mid2 = add_class_packet(&addrs[0], 1, 10);
+  /* Classes above the highest one are clamped to it */
+  over = add_class_packet(&addrs[0], 7, 0);
+  UNIT_TEST_ASSERT(low != NULL && high != NULL && mid1 != NULL
+                   && mid2 != NULL && over != NULL);
+  UNIT_TEST_ASSERT(over->tx_class == TSCH_QUEUE_NUM_CLASSES - 1);
+  n = tsch_queue_get_nbr(&addrs[0]);
+  UNIT_TEST_ASSERT(tsch_queue_packet_count(&addrs[0]) == 5);
+
+#if TSCH_QUEUE_EDF
+  /* The class head with the earliest deadline goes first, and the class
+   * heads without a deadline last, highest class first. Each class stays
+   * in FIFO order. */
+  UNIT_TEST_ASSERT(send_next(n) == mid1);
+  UNIT_TEST_ASSERT(send_next(n) == mid2);
+  UNIT_TEST_ASSERT(send_next(n) == low);
+  UNIT_TEST_ASSERT(send_next(n) == high);
+  UNIT_TEST_ASSERT(send_next(n) == over);
+#else /* TSCH_QUEUE_EDF */
+  /* The highest non-empty class goes first, in FIFO order */
+  UNIT_TEST_ASSERT(send_next(n) == high);
+  UNIT_TEST_ASSERT(send_next(n) == over);
+  UNIT_TEST_ASSERT(send_next(n) == mid1);
+  UNIT_TEST_ASSERT(send_next(n) == mid2);
+  UNIT_TEST_ASSERT(send_next(n) == low);
+#endif /* TSCH_QUEUE_EDF */
+  UNIT_TEST_ASSERT(send_next(n) == NULL);
+  UNIT_TEST_ASSERT(tsch_queue_global_packet_count() == 0);
+
+  flush_all();
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_expiry, "Deadline expiry");
+UNIT_TEST(test_expiry)
+{
+  struct tsch_neighbor *n;
+  struct tsch_packet *p, *late, *timely, *none;
+  clock_time_t start;
+  uint32_t expired;
+
+  UNIT_TEST_BEGIN();
+
+  expired = tsch_queue_expired_packet_count();
+  late = add_class_packet(&addrs[0], 1, 1);
+  timely = add_class_packet(&addrs[0], 1, 60 * CLOCK_SECOND);
+  none = add_class_packet(&addrs[0], 0, 0);
+  UNIT_TEST_ASSERT(late != NULL && timely != NULL && none != NULL);
+  n = tsch_queue_get_nbr(&addrs[0]);
+
+  start = clock_time();
+  while(clock_time() - start < 2) {
+  }
+  UNIT_TEST_ASSERT(tsch_queue_packet_expired(late));
+  UNIT_TEST_ASSERT(!tsch_queue_packet_expired(timely));
+  UNIT_TEST_ASSERT(!tsch_queue_packet_expired(none));
+
+  /* Only the head of a queue can be removed */
+  UNIT_TEST_ASSERT(tsch_queue_remove_expired_packet(n, timely) == NULL);
+  p = tsch_queue_get_packet_for_nbr(n, &dedicated_link);
+  UNIT_TEST_ASSERT(p == late);
+  UNIT_TEST_ASSERT(tsch_queue_remove_expired_packet(n, p) == late);
+  UNIT_TEST_ASSERT(late->ret == MAC_TX_ERR);
+  tsch_queue_free_packet(late);
+  UNIT_TEST_ASSERT(tsch_queue_expired_packet_count() == expired + 1);
+
+  UNIT_TEST_ASSERT(send_next(n) == timely);
+  UNIT_TEST_ASSERT(send_next(n) == none);
+  UNIT_TEST_ASSERT(tsch_queue_expired_packet_count() == expired + 1);
+
+  flush_all();
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_bench, "Shared link lookup time");
+UNIT_TEST(test_bench)
+{
+  struct tsch_neighbor *n;
+  clock_time_t start, ready_time, list_time;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  /* Many neighbors with tx links, and one without, last in the list */
+  for(i = 0; i < TSCH_QUEUE_MAX_NEIGHBOR_QUEUES - 2; i++) {
+    add_packet(&addrs[i]);
+    n = tsch_queue_get_nbr(&addrs[i]);
+    UNIT_TEST_ASSERT(n != NULL);
+    if(i < TSCH_QUEUE_MAX_NEIGHBOR_QUEUES - 3) {
+      n->tx_links_count++;
+      tsch_queue_tx_links_updated(n);
+    }
+  }
+
+  start = clock_time();
+  for(i = 0; i < NUM_LOOKUPS; i++) {
+    tsch_queue_get_unicast_packet_for_any(&n, &shared_link);
+  }
+  ready_time = clock_time() - start;
+  UNIT_TEST_ASSERT(n == tsch_queue_get_nbr(&addrs[TSCH_QUEUE_MAX_NEIGHBOR_QUEUES - 3]));
+
+  /* Dedicated links walk the neighbor list */
+  start = clock_time();
+  for(i = 0; i < NUM_LOOKUPS; i++) {
+    tsch_queue_get_unicast_packet_for_any(&n, &dedicated_link);
+  }
+  list_time = clock_time() - start;
+  UNIT_TEST_ASSERT(n == tsch_queue_get_nbr(&addrs[TSCH_QUEUE_MAX_NEIGHBOR_QUEUES - 3]));
+
+  printf("%u neighbors: %lu ns per lookup with the ready set, %lu ns with the list\n",
+         (unsigned)list_length(neighbor_list),
+         (unsigned long)((uint64_t)ready_time * 1000000000 / CLOCK_SECOND / NUM_LOOKUPS),
+         (unsigned long)((uint64_t)list_time * 1000000000 / CLOCK_SECOND / NUM_LOOKUPS));
+
+  flush_all();
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(tsch_queue_test_process, ev, data)
+{
+  int i;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  for(i = 0; i < NUM_ADDRS; i++) {
+    addrs[i].u8[0] = 1;
+    addrs[i].u8[LINKADDR_SIZE - 2] = random_rand();
+    addrs[i].u8[LINKADDR_SIZE - 1] = i;
+  }
+  tsch_queue_init();
+
+  UNIT_TEST_RUN(test_lookup);
+  UNIT_TEST_RUN(test_tx_links);
+  UNIT_TEST_RUN(test_ready);
+  UNIT_TEST_RUN(test_order);
+  UNIT_TEST_RUN(test_expiry);
+  UNIT_TEST_RUN(test_bench);
+
+  printf("=check-me= DONE\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
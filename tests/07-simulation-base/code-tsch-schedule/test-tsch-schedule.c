@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Checks the link index of the TSCH schedule against a scan of the
+ * links of every slotframe, and compares the time both take to find
+ * the next active link. The schedule module is built into the test,
+ * with stubs for the rest of TSCH, so that the scan can use the same
+ * link selection as the schedule. The test is also built with
+ * TSCH_CONF_WITH_LOCK_FREE set, to check that links removed during a
+ * slot operation are freed only once it has ended.
+ */
+
+#include "contiki.h"
+#include "net/mac/tsch/tsch.h"
+#include "lib/random.h"
+#include "services/unit-test/unit-test.h"
+
+#include <stdio.h>
+/*---------------------------------------------------------------------------*/
+/* Stubs for the rest of TSCH */
+struct tsch_link *current_link;
+const linkaddr_t tsch_broadcast_address;
+int tsch_get_lock(void) { return 1; }
+void tsch_release_lock(void) { }
+int tsch_is_locked(void) { return 0; }
+struct tsch_neighbor *tsch_queue_add_nbr(const linkaddr_t *addr) { return NULL; }
+void tsch_queue_tx_links_updated(struct tsch_neighbor *n) { }
+#if TSCH_WITH_LOCK_FREE
+/* A simulated slot operation */
+static int in_slot;
+static uint16_t epoch;
+static unsigned deferred;
+int
+tsch_slot_operation_release(const struct tsch_link *l, uint16_t *e)
+{
+  if(in_slot) {
+    *e = epoch;
+    deferred++;
+    return 0;
+  }
+  if(l == current_link) {
+    current_link = NULL;
+  }
+  return 1;
+}
+int
+tsch_slot_operation_ended(uint16_t e)
+{
+  return e != epoch;
+}
+#endif /* TSCH_WITH_LOCK_FREE */
+/*---------------------------------------------------------------------------*/
+#include "net/mac/tsch/tsch-schedule.c"
+/*---------------------------------------------------------------------------*/
+PROCESS(tsch_schedule_test_process, "TSCH schedule test process");
+AUTOSTART_PROCESSES(&tsch_schedule_test_process);
+/*---------------------------------------------------------------------------*/
+#define NUM_SLOTFRAMES 4
+#define NUM_ROUNDS 20000
+#define NUM_LOOKUPS 100000
+
+static const uint16_t sizes[NUM_SLOTFRAMES] = { 101, 397, 7, 31 };
+static struct tsch_slotframe *slotframes[NUM_SLOTFRAMES];
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* The next active link, found by scanning the links of every slotframe */
+static struct tsch_link *
+scan_next_active_link(struct tsch_asn_t *asn, uint16_t *time_offset,
+                      struct tsch_link **backup_link)
+{
+  uint16_t time_to_curr_best = 0;
+  struct tsch_link *curr_best = NULL;
+  struct tsch_link *curr_backup = NULL;
+  struct tsch_slotframe *sf;
+  struct tsch_link *l;
+
+  for(sf = list_head(slotframe_list); sf != NULL; sf = list_item_next(sf)) {
+    uint16_t timeslot = TSCH_ASN_MOD(*asn, sf->size);
+    for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+      uint16_t time_to_timeslot =
+        l->timeslot > timeslot ?
+        l->timeslot - timeslot :
+        sf->size.val + l->timeslot - timeslot;
+      select_link(l, time_to_timeslot, &curr_best, &time_to_curr_best, &curr_backup);
+    }
+  }
+  *time_offset = time_to_curr_best;
+  *backup_link = curr_backup;
+  return curr_best;
+}
+/*---------------------------------------------------------------------------*/
+static struct tsch_link *
+scan_link_by_timeslot(struct tsch_slotframe *sf, uint16_t timeslot)
+{
+  struct tsch_link *l;
+
+  for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+    if(l->timeslot == timeslot) {
+      return l;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+random_asn(struct tsch_asn_t *asn)
+{
+  asn->ms1b = 0;
+  asn->ls4b = ((uint32_t)random_rand() << 16) | random_rand();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_index, "Link index matches the scan");
+UNIT_TEST(test_index)
+{
+  struct tsch_asn_t asn;
+  struct tsch_link *l, *scan, *backup, *scan_backup;
+  uint16_t offset, scan_offset, ts;
+  int i, s;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < NUM_ROUNDS; i++) {
+    s = random_rand() % NUM_SLOTFRAMES;
+    ts = random_rand() % sizes[s];
+    if(random_rand() % 3 != 0) {
+      tsch_schedule_add_link(slotframes[s], random_rand() % 8,
+                             LINK_TYPE_NORMAL, NULL, ts, 0);
+    } else {
+      tsch_schedule_remove_link_by_timeslot(slotframes[s], ts);
+    }
+
+    ts = random_rand() % sizes[s];
+    UNIT_TEST_ASSERT(tsch_schedule_get_link_by_timeslot(slotframes[s], ts)
+                     == scan_link_by_timeslot(slotframes[s], ts));
+
+    random_asn(&asn);
+    l = tsch_schedule_get_next_active_link(&asn, &offset, &backup);
+    scan = scan_next_active_link(&asn, &scan_offset, &scan_backup);
+    UNIT_TEST_ASSERT(l == scan);
+    UNIT_TEST_ASSERT(l == NULL || offset == scan_offset);
+    UNIT_TEST_ASSERT(backup == scan_backup);
+  }
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+#if TSCH_WITH_LOCK_FREE
+static int
+count_links(void)
+{
+  struct tsch_slotframe *sf;
+  int count = 0;
+
+  for(sf = list_head(slotframe_list); sf != NULL; sf = list_item_next(sf)) {
+    count += list_length(sf->links_list);
+  }
+  return count;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_lock_free, "Lock-free edits during a slot");
+UNIT_TEST(test_lock_free)
+{
+  struct tsch_asn_t asn;
+  struct tsch_link *held, *backup, copy;
+  uint16_t offset, ts;
+  int i, s, round;
+
+  UNIT_TEST_BEGIN();
+
+  deferred = 0;
+  for(round = 0; round < 100; round++) {
+    /* A slot operation starts with the next active link */
+    random_asn(&asn);
+    held = tsch_schedule_get_next_active_link(&asn, &offset, &backup);
+    if(held != NULL) {
+      copy = *held;
+    }
+    in_slot = 1;
+
+    /* Edits during the slot never free a link it may still use, even
+     * when the pool runs out, and never wait for the slot to end */
+    for(i = 0; i < 200; i++) {
+      s = random_rand() % NUM_SLOTFRAMES;
+      ts = random_rand() % sizes[s];
+      if(random_rand() % 3 != 0) {
+        tsch_schedule_add_link(slotframes[s], LINK_OPTION_RX,
+                               LINK_TYPE_NORMAL, NULL, ts, 0);
+      } else {
+        tsch_schedule_remove_link_by_timeslot(slotframes[s], ts);
+      }
+      UNIT_TEST_ASSERT(held == NULL
+                       || (held->handle == copy.handle
+                           && held->timeslot == copy.timeslot
+                           && held->slotframe_handle == copy.slotframe_handle));
+    }
+    tsch_schedule_free_removed();
+    UNIT_TEST_ASSERT(held == NULL || held->handle == copy.handle);
+
+    /* Once the slot has ended, all removed links are freed */
+    in_slot = 0;
+    epoch++;
+    tsch_schedule_free_removed();
+    UNIT_TEST_ASSERT(list_head(removed_link_list) == NULL);
+    UNIT_TEST_ASSERT(memb_numfree(&link_memb) == TSCH_SCHEDULE_MAX_LINKS - count_links());
+  }
+  UNIT_TEST_ASSERT(deferred > 0);
+
+  UNIT_TEST_END();
+}
+#endif /* TSCH_WITH_LOCK_FREE */
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_bench, "Next active link lookup time");
+UNIT_TEST(test_bench)
+{
+  static struct tsch_asn_t asns[64];
+  struct tsch_link *backup;
+  uint16_t offset;
+  clock_time_t start, index_time, scan_time;
+  int i, s, ts;
+
+  UNIT_TEST_BEGIN();
+
+  /* Fill the schedule */
+  for(i = 0; i < TSCH_SCHEDULE_MAX_LINKS; i++) {
+    s = random_rand() % NUM_SLOTFRAMES;
+    ts = random_rand() % sizes[s];
+    if(tsch_schedule_get_link_by_timeslot(slotframes[s], ts) == NULL) {
+      tsch_schedule_add_link(slotframes[s], LINK_OPTION_RX,
+                             LINK_TYPE_NORMAL, NULL, ts, 0);
+    }
+  }
+  for(i = 0; i < 64; i++) {
+    random_asn(&asns[i]);
+  }
+
+  start = clock_time();
+  for(i = 0; i < NUM_LOOKUPS; i++) {
+    tsch_schedule_get_next_active_link(&asns[i % 64], &offset, &backup);
+  }
+  index_time = clock_time() - start;
+
+  start = clock_time();
+  for(i = 0; i < NUM_LOOKUPS; i++) {
+    scan_next_active_link(&asns[i % 64], &offset, &backup);
+  }
+  scan_time = clock_time() - start;
+
+  printf("%u links: %lu ns per lookup with the index, %lu ns with the scan\n",
+         (unsigned)link_index_count,
+         (unsigned long)((uint64_t)index_time * 1000000000 / CLOCK_SECOND / NUM_LOOKUPS),
+         (unsigned long)((uint64_t)scan_time * 1000000000 / CLOCK_SECOND / NUM_LOOKUPS));
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(tsch_schedule_test_process, ev, data)
+{
+  int i;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  tsch_schedule_init();
+  for(i = 0; i < NUM_SLOTFRAMES; i++) {
+    slotframes[i] = tsch_schedule_add_slotframe(i * 3, sizes[i]);
+  }
+
+  UNIT_TEST_RUN(test_index);
+#if TSCH_WITH_LOCK_FREE
+  UNIT_TEST_RUN(test_lock_free);
+#endif /* TSCH_WITH_LOCK_FREE */
+  UNIT_TEST_RUN(test_bench);
+
+  printf("=check-me= DONE\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/